@@ -0,0 +1,250 @@
+#include "AoEPlacement.h"
+
+#include <algorithm>		//std::min, std::max, std::sort, std::partial_sort
+#include <cstdlib>			//std::abs
+#include <type_traits>		//std::is_same
+
+#include "LineOfSight.h"	//Centres in sight of the caster
+
+void AoEPlacementSearch::Run(const NavGrid& grid, const AoEPlacementQuery& query)
+{
+	m_Placements.clear();
+	if (!query.targets || query.count <= 0 || query.range < 0 || query.radius < 0)
+		return;
+	if (query.casterCell < 0 || query.casterCell >= grid.GetCellCount() || grid.IsBorder(query.casterCell))
+		return;
+
+	//Any area centred in range lies within range + radius of the caster on both axes
+	m_WindowRange = query.range + query.radius;
+	m_WindowSide = m_WindowRange * 2 + 1;
+	FillWindow(grid, query);
+
+	switch (GetSumTable(query.areaShape))
+	{
+	case SUM_TABLE::ROTATED:
+		//Centres lie within the diamond holding the range shape, so turned areas lie within that plus the radius
+		BuildRotatedTable(NavGrid::Shapes::GetBoundingRange(query.rangeShape, SHAPE_FACING::ALL, query.range) + query.radius);
+		break;
+	case SUM_TABLE::SQUARE:
+		BuildSquareTable();
+		break;
+	case SUM_TABLE::ROWS:
+		BuildRowSums();
+		break;
+	}
+
+	//Score every centre in range
+	int casterX = grid.GetCellX(query.casterCell);
+	int casterY = grid.GetCellY(query.casterCell);
+	auto scoreCentre = [&](int cell)
+	{
+		int dx = grid.GetCellX(cell) - casterX;
+		int dy = grid.GetCellY(cell) - casterY;
+		if (query.centreOnTarget && m_Weights[(dy + m_WindowRange) * m_WindowSide + dx + m_WindowRange] <= 0.0)
+			return;
+		m_Placements.push_back({ cell, SumArea(query, dx, dy) });
+	};
+	if (query.visibility)
+		query.visibility->ForEachVisibleInShape(query.casterCell, query.rangeShape, query.range, scoreCentre);
+	else
+	{
+		grid.ForEachSpanInShape(casterX, casterY, query.rangeShape, SHAPE_FACING::ALL, query.range, [&](int firstCell, int lastCell)
+		{
+			for (int cell(firstCell); cell <= lastCell; ++cell)
+				scoreCentre(cell);
+		});
+	}
+
+	//Keep the best, in a fixed order so ties always come out the same way
+	auto isBetter = [](const AoEPlacement& a, const AoEPlacement& b)
+	{
+		return a.score > b.score || (a.score == b.score && a.cell < b.cell);
+	};
+	if (query.count < static_cast<int>(m_Placements.size()))
+	{
+		std::partial_sort(m_Placements.begin(), m_Placements.begin() + query.count, m_Placements.end(), isBetter);
+		m_Placements.resize(query.count);
+	}
+	else
+		std::sort(m_Placements.begin(), m_Placements.end(), isBetter);
+}
+
+AoEPlacementSearch::SUM_TABLE AoEPlacementSearch::GetSumTable(RANGE_SHAPE shape)
+{
+	//Only the 4 way diamond turns into a square
+	constexpr bool diamondsTurn = std::is_same<NavGrid::Topology, SquareGrid4>::value;
+
+	switch (shape)
+	{
+	case RANGE_SHAPE::DIAMOND:
+	case RANGE_SHAPE::RING:
+		return diamondsTurn ? SUM_TABLE::ROTATED : SUM_TABLE::ROWS;
+	case RANGE_SHAPE::SQUARE:
+		return SUM_TABLE::SQUARE;
+	default:
+		return SUM_TABLE::ROWS;
+	}
+}
+
+void AoEPlacementSearch::FillWindow(const NavGrid& grid, const AoEPlacementQuery& query)
+{
+	m_Weights.assign(static_cast<size_t>(m_WindowSide) * m_WindowSide, 0.0);
+
+	int stride = grid.GetStride();
+	int casterRow = query.casterCell / stride;
+	int casterColumn = query.casterCell % stride;
+	for (auto& t : *query.targets)
+	{
+		if (t.cell < 0 || t.cell >= grid.GetCellCount() || grid.IsBorder(t.cell))
+			continue;
+
+		//Targets out past the window can't be reached by any area (the cell delta is split into rows and columns
+		//with one division, the border making it the same as the difference in coordinates)
+		int dy = t.cell / stride - casterRow;
+		int dx = t.cell - (casterRow + dy) * stride - casterColumn;
+		if (std::abs(dx) > m_WindowRange || std::abs(dy) > m_WindowRange)
+			continue;
+
+		//Targets sharing a tile add up
+		m_Weights[(dy + m_WindowRange) * m_WindowSide + dx + m_WindowRange] += t.weight;
+	}
+}
+
+void AoEPlacementSearch::BuildRotatedTable(int rotatedRange)
+{
+	//u = dx + dy and v = dx - dy, both offset by the range to start at 0
+	m_RotatedRange = rotatedRange;
+	m_RotatedSide = rotatedRange * 2 + 1;
+	int tableSide = m_RotatedSide + 1;
+	m_RotatedTable.assign(static_cast<size_t>(tableSide) * tableSide, 0.0);
+
+	for (int row(0); row < m_WindowSide; ++row)
+	{
+		for (int column(0); column < m_WindowSide; ++column)
+		{
+			double weight = m_Weights[row * m_WindowSide + column];
+			if (weight == 0.0)
+				continue;
+
+			//Weights out past the turned range can't be covered
+			int u = column + row - m_WindowRange * 2 + rotatedRange;
+			int v = column - row + rotatedRange;
+			if (u < 0 || v < 0 || u >= m_RotatedSide || v >= m_RotatedSide)
+				continue;
+			m_RotatedTable[(u + 1) * tableSide + v + 1] += weight;
+		}
+	}
+
+	//Half the turned cells fall between tiles and stay zero, so sum them all alike (a running sum along the row
+	//plus the row above, keeping the chain of dependent adds to one per entry)
+	for (int u(1); u < tableSide; ++u)
+	{
+		double* row = m_RotatedTable.data() + static_cast<size_t>(u) * tableSide;
+		const double* above = row - tableSide;
+		double run = 0.0;
+		for (int v(1); v < tableSide; ++v)
+		{
+			run += row[v];
+			row[v] = above[v] + run;
+		}
+	}
+}
+
+void AoEPlacementSearch::BuildSquareTable()
+{
+	int tableSide = m_WindowSide + 1;
+	m_SquareTable.assign(static_cast<size_t>(tableSide) * tableSide, 0.0);
+
+	for (int r(1); r < tableSide; ++r)
+	{
+		double* row = m_SquareTable.data() + static_cast<size_t>(r) * tableSide;
+		const double* above = row - tableSide;
+		const double* weights = m_Weights.data() + static_cast<size_t>(r - 1) * m_WindowSide;
+		double run = 0.0;
+		for (int column(1); column < tableSide; ++column)
+		{
+			run += weights[column - 1];
+			row[column] = above[column] + run;
+		}
+	}
+}
+
+void AoEPlacementSearch::BuildRowSums()
+{
+	int rowLength = m_WindowSide + 1;
+	m_RowSums.assign(static_cast<size_t>(m_WindowSide) * rowLength, 0.0);
+
+	for (int row(0); row < m_WindowSide; ++row)
+	{
+		double* sums = m_RowSums.data() + static_cast<size_t>(row) * rowLength;
+		for (int column(0); column < m_WindowSide; ++column)
+			sums[column + 1] = sums[column] + m_Weights[row * m_WindowSide + column];
+	}
+}
+
+double AoEPlacementSearch::SumArea(const AoEPlacementQuery& query, int dx, int dy) const
+{
+	int radius = query.radius;
+
+	switch (GetSumTable(query.areaShape))
+	{
+	case SUM_TABLE::ROTATED:
+		if (query.areaShape == RANGE_SHAPE::RING && radius > 0)
+			return SumDiamond(dx, dy, radius) - SumDiamond(dx, dy, radius - 1);
+		return SumDiamond(dx, dy, radius);
+
+	case SUM_TABLE::SQUARE:
+	{
+		int tableSide = m_WindowSide + 1;
+		int row0 = std::max(dy - radius + m_WindowRange, 0);
+		int row1 = std::min(dy + radius + m_WindowRange, m_WindowSide - 1);
+		int column0 = std::max(dx - radius + m_WindowRange, 0);
+		int column1 = std::min(dx + radius + m_WindowRange, m_WindowSide - 1);
+		return m_SquareTable[(row1 + 1) * tableSide + column1 + 1] - m_SquareTable[row0 * tableSide + column1 + 1]
+			- m_SquareTable[(row1 + 1) * tableSide + column0] + m_SquareTable[row0 * tableSide + column0];
+	}
+
+	default:
+	{
+		//One prefix sum lookup per span
+		SHAPE_FACING facing = query.areaShape == RANGE_SHAPE::LINE || query.areaShape == RANGE_SHAPE::CONE ?
+			FacingTowards(dx, dy) : SHAPE_FACING::ALL;
+		int rowLength = m_WindowSide + 1;
+		double sum = 0.0;
+		NavGrid::Shapes::ForEachSpan(query.areaShape, facing, radius, [&](int spanY, int minX, int maxX)
+		{
+			int row = dy + spanY + m_WindowRange;
+			int column0 = std::max(dx + minX + m_WindowRange, 0);
+			int column1 = std::min(dx + maxX + m_WindowRange, m_WindowSide - 1);
+			if (row < 0 || row >= m_WindowSide || column0 > column1)
+				return;
+
+			const double* sums = m_RowSums.data() + static_cast<size_t>(row) * rowLength;
+			sum += sums[column1 + 1] - sums[column0];
+		});
+		return sum;
+	}
+	}
+}
+
+double AoEPlacementSearch::SumRotated(int u0, int u1, int v0, int v1) const
+{
+	u0 = std::max(u0, 0);
+	v0 = std::max(v0, 0);
+	u1 = std::min(u1, m_RotatedSide - 1);
+	v1 = std::min(v1, m_RotatedSide - 1);
+	if (u0 > u1 || v0 > v1)
+		return 0.0;
+
+	int tableSide = m_RotatedSide + 1;
+	return m_RotatedTable[(u1 + 1) * tableSide + v1 + 1] - m_RotatedTable[u0 * tableSide + v1 + 1]
+		- m_RotatedTable[(u1 + 1) * tableSide + v0] + m_RotatedTable[u0 * tableSide + v0];
+}
+
+double AoEPlacementSearch::SumDiamond(int dx, int dy, int radius) const
+{
+	//|x| + |y| <= r is |u| <= r and |v| <= r
+	int u = dx + dy + m_RotatedRange;
+	int v = dx - dy + m_RotatedRange;
+	return SumRotated(u - radius, u + radius, v - radius, v + radius);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "NavGrid.h"			//Grid the area is placed on
+#include "RangeShapes.h"		//Range and area shapes
+
+class VisibilityCache;
+
+//A unit an area may cover, with what covering it is worth (1 to count enemies, expected damage, negative for allies)
+struct AoETarget
+{
+	int cell = -1;
+	float weight = 0.f;
+};
+
+//Where to centre an area, and the summed weight of the targets it covers there
+struct AoEPlacement
+{
+	int cell = -1;
+	double score = 0.0;
+};
+
+struct AoEPlacementQuery
+{
+	//Cell the skill is cast from, and the shape and range the centre must fall within
+	int casterCell = -1;
+	RANGE_SHAPE rangeShape = RANGE_SHAPE::DIAMOND;
+	int range = 0;
+	//Shape and radius of the area (lines and cones point away from the caster, see FacingTowards)
+	RANGE_SHAPE areaShape = RANGE_SHAPE::DIAMOND;
+	int radius = 0;
+
+	const std::vector<AoETarget>* targets = nullptr;
+	//Number of placements wanted
+	int count = 1;
+	//If set, centres must be in sight of the caster
+	const VisibilityCache* visibility = nullptr;
+	//Only centre on tiles holding a target worth hitting (positive weight), as when the skill must be aimed at a unit
+	bool centreOnTarget = false;
+};
+
+/*
+	AoE placement optimiser. Finds the centres within a skills range whose area covers the most target weight,
+	without laying out the area at each centre.
+
+	Targets are rasterised into a window of weights around the caster, just big enough to hold any area centred in
+	range. Every area is then summed in constant time from a table built once over the window:
+
+	- DIAMOND: a summed area table over the window turned 45 degrees (u = x + y, v = x - y), where a diamond is an
+	  axis aligned square
+	- RING: the diamond less the diamond one smaller, from the same table
+	- SQUARE: a summed area table over the window as is
+	- LINE and CONE: prefix sums along each row, summing the shapes row spans (so one lookup per row)
+
+	Off 4 way grids the diamond and ring are not square when turned, so they use the row sums too. A search is
+	O(window + centres) for the table shapes, against O(centres * radius^2 * targets) for stamping the area at each
+	centre and checking each target. Containers are reused between searches.
+*/
+class AoEPlacementSearch
+{
+public:
+
+	AoEPlacementSearch() {}
+	~AoEPlacementSearch() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Best placements of the last search, highest score first (ties to the lower cell), up to the count asked for
+	const std::vector<AoEPlacement>& GetPlacements() const { return m_Placements; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	void Run(const NavGrid& grid, const AoEPlacementQuery& query);
+
+private:
+
+	//Which of the tables an area shape is summed with
+	enum class SUM_TABLE
+	{
+		ROTATED,
+		SQUARE,
+		ROWS
+	};
+
+	static SUM_TABLE GetSumTable(RANGE_SHAPE shape);
+
+	//Rasterises the targets into the window around the caster
+	void FillWindow(const NavGrid& grid, const AoEPlacementQuery& query);
+	//Turned table covering offsets of up to rotatedRange in u and v
+	void BuildRotatedTable(int rotatedRange);
+	void BuildSquareTable();
+	void BuildRowSums();
+
+	//Summed weight of the area centred at window offset dx, dy from the caster
+	double SumArea(const AoEPlacementQuery& query, int dx, int dy) const;
+	//Sum of the rotated table over u0 to u1 and v0 to v1 inclusive (clipped to the table)
+	double SumRotated(int u0, int u1, int v0, int v1) const;
+	//Diamond of the given radius around window offset dx, dy
+	double SumDiamond(int dx, int dy, int radius) const;
+
+	////////////
+	/// Data ///
+	////////////
+
+	//Window covers offsets -m_WindowRange to m_WindowRange from the caster on each axis
+	int m_WindowRange = 0;
+	int m_WindowSide = 0;
+	//Window weights, row after row
+	std::vector<double> m_Weights;
+
+	//Turned window covers u and v of -m_RotatedRange to m_RotatedRange, with its table ((side + 1)^2, row and column 0
+	//being zero)
+	int m_RotatedRange = 0;
+	int m_RotatedSide = 0;
+	std::vector<double> m_RotatedTable;
+	//Table over the window ((side + 1)^2)
+	std::vector<double> m_SquareTable;
+	//Per window row, prefix sums along it (side + 1 each)
+	std::vector<double> m_RowSums;
+
+	std::vector<AoEPlacement> m_Placements;
+};
@@ -502,6 +502,14 @@ std::shared_ptr<SkillInterface> AssetManager::GetSkillData(int UniqueSkillID)
 		return nullptr;
 }
 
+int AssetManager::GetMaxSkillRange()
+{
+	int maxRange = 0;
+	for (auto& s : m_SkillMap)
+		maxRange = std::max(maxRange, s.second->GetSkillRange());
+	return maxRange;
+}
+
 void AssetManager::LoadSkillType1(const rapidjson::Value& doc, int index)
 {
 	std::shared_ptr<PhysicalAttack> newSkill = std::make_shared<PhysicalAttack>();
@@ -515,6 +523,8 @@ void AssetManager::LoadSkillType1(const rapidjson::Value& doc, int index)
 	newSkill->GetData().ManaCost = doc[index]["Mana Cost"].GetInt();
 	newSkill->GetData().Range = doc[index]["Range"].GetInt();
 	newSkill->GetData().Radius = doc[index]["Radius"].GetInt();
+	LoadSkillShape(doc[index], "Range Shape", newSkill->GetData().RangeShape);
+	LoadSkillShape(doc[index], "Radius Shape", newSkill->GetData().RadiusShape);
 	newSkill->GetData().PhysDamageScaling = doc[index]["Physical Damage Scaling"].GetFloat();
 	newSkill->GetData().MagDamageScaling = doc[index]["Magic Damage Scaling"].GetFloat();
 	newSkill->GetData().InnateCrit = doc[index]["Innate Crit %"].GetFloat();
@@ -536,6 +546,8 @@ void AssetManager::LoadSkillType2(const rapidjson::Value& doc, int index)
 	newSkill->GetData().ManaCost = doc[index]["Mana Cost"].GetInt();
 	newSkill->GetData().Range = doc[index]["Range"].GetInt();
 	newSkill->GetData().Radius = doc[index]["Radius"].GetInt();
+	LoadSkillShape(doc[index], "Range Shape", newSkill->GetData().RangeShape);
+	LoadSkillShape(doc[index], "Radius Shape", newSkill->GetData().RadiusShape);
 	newSkill->GetData().PhysDamageScaling = doc[index]["Physical Damage Scaling"].GetFloat();
 	newSkill->GetData().MagDamageScaling = doc[index]["Magic Damage Scaling"].GetFloat();
 	newSkill->GetData().InnateCrit = doc[index]["Innate Crit %"].GetFloat();
@@ -556,6 +568,8 @@ void AssetManager::LoadSkillType3(const rapidjson::Value& doc, int index)
 	newSkill->GetData().ManaCost = doc[index]["Mana Cost"].GetInt();
 	newSkill->GetData().Range = doc[index]["Range"].GetInt();
 	newSkill->GetData().Radius = doc[index]["Radius"].GetInt();
+	LoadSkillShape(doc[index], "Range Shape", newSkill->GetData().RangeShape);
+	LoadSkillShape(doc[index], "Radius Shape", newSkill->GetData().RadiusShape);
 	newSkill->GetData().HealPercent = doc[index]["Heal %"].GetFloat();
 	newSkill->GetData().ToolTip = doc[index]["Tool Tip"].GetString();
 
@@ -575,6 +589,8 @@ void AssetManager::LoadSkillType4(const rapidjson::Value& doc, int index)
 	newSkill->GetData().TurnCount = doc[index]["Turn Count"].GetInt();
 	newSkill->GetData().Range = doc[index]["Range"].GetInt();
 	newSkill->GetData().Radius = doc[index]["Radius"].GetInt();
+	LoadSkillShape(doc[index], "Range Shape", newSkill->GetData().RangeShape);
+	LoadSkillShape(doc[index], "Radius Shape", newSkill->GetData().RadiusShape);
 	newSkill->GetData().PhysDamageBuff = doc[index]["Physical Damage Buff %"].GetFloat();
 	newSkill->GetData().MagDamageBuff = doc[index]["Magical Damage Buff %"].GetFloat();
 	newSkill->GetData().PhysHitBuff = doc[index]["Physical Hit Buff %"].GetFloat();
@@ -591,6 +607,12 @@ void AssetManager::LoadSkillType4(const rapidjson::Value& doc, int index)
 	m_SkillMap[newSkill->GetData().UniqueID] = std::move(newSkill);
 }
 
+void AssetManager::LoadSkillShape(const rapidjson::Value& skill, const char* key, RANGE_SHAPE& shape)
+{
+	if (!skill.HasMember(key))
+		return;
 
-
-
+	bool found = ParseRangeShape(skill[key].GetString(), shape);
+	assert(found && "Unknown skill shape");
+	(void)found;
+}
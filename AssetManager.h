@@ -47,6 +47,8 @@ public:
 	std::shared_ptr<Equipment> GetEquipmentData(int UniqueEquipmentID);
 	//Get the Skill data by id and returns the pointer to the data
 	std::shared_ptr<SkillInterface>GetSkillData(int UniqueSkillID);
+	//Longest range of any loaded skill (for sizing range based caches)
+	int GetMaxSkillRange();
 	//SkillMap& GetSkillData() { return m_SkillMap; }
 	 //////////////////////
 	// SpriteFont Stuff //
@@ -69,4 +71,6 @@ private:
 	void LoadSkillType3(const rapidjson::Value& doc, int index);
 	//Buff
 	void LoadSkillType4(const rapidjson::Value& doc, int index);
+	//Reads an optional shape name (see RANGE_SHAPE_NAMES), leaving the shape as is if the skill doesn't give one
+	void LoadSkillShape(const rapidjson::Value& skill, const char* key, RANGE_SHAPE& shape);
 };
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "AttackRange.h"
+
+#include <algorithm>	//std::sort, std::min, std::max
+#include <cstdlib>		//std::abs
+
+namespace
+{
+	/*
+		ORs the source words, shifted by the given number of bits (positive towards higher cells), into the
+		destination words first to last. Source words outside first to last are taken as zero.
+	*/
+	void OrShiftedWords(const uint64_t* src, uint64_t* dst, int firstWord, int lastWord, int shift)
+	{
+		int wordShift = std::abs(shift) >> 6;
+		int bitShift = std::abs(shift) & 63;
+
+		for (int i(firstWord); i <= lastWord; ++i)
+		{
+			uint64_t word = 0ull;
+			if (shift >= 0)
+			{
+				//Low bits come up from the word below
+				int j = i - wordShift;
+				if (j >= firstWord)
+					word = src[j] << bitShift;
+				if (bitShift && j - 1 >= firstWord)
+					word |= src[j - 1] >> (64 - bitShift);
+			}
+			else
+			{
+				//High bits come down from the word above
+				int j = i + wordShift;
+				if (j <= lastWord)
+					word = src[j] >> bitShift;
+				if (bitShift && j + 1 <= lastWord)
+					word |= src[j + 1] << (64 - bitShift);
+			}
+			dst[i] |= word;
+		}
+	}
+}
+
+void AttackRangeSearch::Run(const NavGrid& grid, const std::vector<int>& standingCells, const std::vector<int>& targetCells,
+	const std::vector<int>& skillRanges)
+{
+	RunSearch<NavGrid::Topology>(grid, standingCells, targetCells, skillRanges);
+}
+
+template<typename Topology>
+void AttackRangeSearch::RunSearch(const NavGrid& grid, const std::vector<int>& standingCells, const std::vector<int>& targetCells,
+	const std::vector<int>& skillRanges)
+{
+	int skillCount = static_cast<int>(skillRanges.size());
+	ResizeBuffers(grid, skillCount);
+	ClearDirtyWords();
+	m_Options.clear();
+
+	//Gather the standing set, tracking the words it covers
+	int cellCount = grid.GetCellCount();
+	int firstWord = INT32_MAX;
+	int lastWord = -1;
+	for (int cell : standingCells)
+	{
+		if (cell < 0 || cell >= cellCount || grid.IsBorder(cell))
+			continue;
+
+		m_StandingSet.Set(cell);
+		firstWord = std::min(firstWord, cell >> 6);
+		lastWord = std::max(lastWord, cell >> 6);
+	}
+	if (lastWord < 0)
+		return;
+
+	//Dilate in order of range, so each skill carries on from the last
+	m_SkillOrder.clear();
+	for (int k(0); k < skillCount; ++k)
+		if (skillRanges[k] >= 0)
+			m_SkillOrder.push_back(k);
+	std::sort(m_SkillOrder.begin(), m_SkillOrder.end(), [&](int a, int b)
+	{
+		return skillRanges[a] < skillRanges[b] || (skillRanges[a] == skillRanges[b] && a < b);
+	});
+
+	//Each step spreads the set by at most the largest neighbour offset, which sets how far the word range grows
+	int stride = grid.GetStride();
+	int maxOffset = 0;
+	ForEachDirection<Topology>([&](auto direction)
+	{
+		maxOffset = std::max(maxOffset, std::abs(Topology::Offset(direction, stride)));
+	});
+	int wordGrowth = (maxOffset >> 6) + 1;
+	int wordCount = m_Current.GetWordCount();
+	const uint64_t* mask = m_MapMask.GetWords();
+
+	for (int i(firstWord); i <= lastWord; ++i)
+		m_Current.GetWords()[i] = m_StandingSet.GetWords()[i];
+
+	int range = 0;
+	for (int skill : m_SkillOrder)
+	{
+		for (; range < skillRanges[skill]; ++range)
+		{
+			firstWord = std::max(firstWord - wordGrowth, 0);
+			lastWord = std::min(lastWord + wordGrowth, wordCount - 1);
+
+			//One step of the range shape: the set, plus the set moved one step in each direction
+			const uint64_t* current = m_Current.GetWords();
+			uint64_t* next = m_Next.GetWords();
+			for (int i(firstWord); i <= lastWord; ++i)
+				next[i] = current[i];
+			ForEachDirection<Topology>([&](auto direction)
+			{
+				OrShiftedWords(current, next, firstWord, lastWord, Topology::Offset(direction, stride));
+			});
+
+			//Clip to the map, so the set never spreads through the border onto the next row
+			for (int i(firstWord); i <= lastWord; ++i)
+				next[i] &= mask[i];
+
+			m_Current.Swap(m_Next);
+		}
+
+		uint64_t* threat = m_ThreatSets[skill].GetWords();
+		for (int i(firstWord); i <= lastWord; ++i)
+			threat[i] = m_Current.GetWords()[i];
+	}
+
+	m_DirtyFirstWord = firstWord;
+	m_DirtyLastWord = lastWord;
+
+	//Targets inside a skills dilated set are hit from every standing cell within range of them
+	for (int k(0); k < skillCount; ++k)
+	{
+		int skillRange = skillRanges[k];
+		if (skillRange < 0)
+			continue;
+
+		const TileBitset& threatSet = m_ThreatSets[k];
+		for (int t(0); t < static_cast<int>(targetCells.size()); ++t)
+		{
+			int target = targetCells[t];
+			if (target < 0 || target >= cellCount || grid.IsBorder(target) || !threatSet.Test(target))
+				continue;
+
+			//Range shapes are symmetric, so the cells in range of the target are the cells it can be hit from
+			grid.ForEachCoordInRange(grid.GetCellX(target), grid.GetCellY(target), skillRange, [&](int x, int y)
+			{
+				int cell = grid.CoordsToCell(x, y);
+				if (m_StandingSet.Test(cell))
+					m_Options.push_back({ cell, t, k });
+			});
+		}
+	}
+}
+
+void AttackRangeSearch::ResizeBuffers(const NavGrid& grid, int skillCount)
+{
+	int cellCount = grid.GetCellCount();
+
+	//New grid, so rebuild the mask and start every set afresh
+	if (m_MapMask.GetBitCount() != cellCount || m_MaskWidth != grid.GetWidth() || m_MaskHeight != grid.GetHeight())
+	{
+		m_MaskWidth = grid.GetWidth();
+		m_MaskHeight = grid.GetHeight();
+		m_MapMask.Resize(cellCount);
+		for (int y(0); y < m_MaskHeight; ++y)
+			for (int x(0); x < m_MaskWidth; ++x)
+				m_MapMask.Set(grid.CoordsToCell(x, y));
+
+		m_StandingSet.Resize(cellCount);
+		m_Current.Resize(cellCount);
+		m_Next.Resize(cellCount);
+		for (auto& t : m_ThreatSets)
+			t.Resize(cellCount);
+
+		m_DirtyFirstWord = 0;
+		m_DirtyLastWord = -1;
+	}
+
+	while (static_cast<int>(m_ThreatSets.size()) < skillCount)
+	{
+		m_ThreatSets.emplace_back();
+		m_ThreatSets.back().Resize(cellCount);
+	}
+}
+
+void AttackRangeSearch::ClearDirtyWords()
+{
+	for (int i(m_DirtyFirstWord); i <= m_DirtyLastWord; ++i)
+	{
+		m_StandingSet.GetWords()[i] = 0ull;
+		m_Current.GetWords()[i] = 0ull;
+		m_Next.GetWords()[i] = 0ull;
+		for (auto& t : m_ThreatSets)
+			t.GetWords()[i] = 0ull;
+	}
+
+	m_DirtyFirstWord = 0;
+	m_DirtyLastWord = -1;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "NavGrid.h"					//Searched grid
+#include "PathfindingContainers.h"		//Cell bitsets
+
+/*
+	One way a unit can attack this turn: stand on a cell it can reach, and use a skill on a target in range.
+*/
+struct AttackOption
+{
+	//Reachable cell the unit attacks from
+	int standingCell = -1;
+	//Index into the target cells searched
+	int targetIndex = -1;
+	//Index into the skill ranges searched (the units skill slot)
+	int skillIndex = -1;
+};
+
+/*
+	Attack range engine. Answers "which targets can this unit hit this turn, with which skill, and from where" in one
+	pass, rather than laying out a targeting grid around every reachable cell.
+
+	The reachable cells (see MovementRangeSearch) are held as a bitset and dilated by each skills range shape
+	(a Minkowski sum), giving every cell each skill can hit from somewhere reachable. The dilation grows the set one
+	topology step at a time, ORing in the whole bitset shifted by each neighbour offset, so it works on 64 cells per
+	operation and over the rows the set covers only. Skills are dilated in order of range, each carrying on from the
+	last. A target in a skills dilated set is then hit from exactly the reachable cells within range of it.
+
+	Works on cell indexes only and never touches tiles or sprites, so it is safe for AI and previews. All containers
+	are reused between searches, so a search does not allocate once warm.
+*/
+class AttackRangeSearch
+{
+public:
+
+	AttackRangeSearch() {}
+	~AttackRangeSearch() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Every (standing cell, target, skill) found by the last search, grouped by skill then target
+	const std::vector<AttackOption>& GetOptions() const { return m_Options; }
+	//Cells the skill can hit from any reachable cell (the dilated set)
+	const TileBitset& GetThreatSet(int skillIndex) const { return m_ThreatSets[skillIndex]; }
+	//Cells the unit can attack from
+	const TileBitset& GetStandingSet() const { return m_StandingSet; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	/*
+		Finds every way of attacking the target cells from the standing cells (normally the reached cells of a
+		movement range search). skillRanges holds the range of each skill slot, slots with a negative range are
+		skipped. Targets off the map are ignored.
+	*/
+	void Run(const NavGrid& grid, const std::vector<int>& standingCells, const std::vector<int>& targetCells,
+		const std::vector<int>& skillRanges);
+
+private:
+
+	//Search body, with the dilation unrolled for the topology
+	template<typename Topology>
+	void RunSearch(const NavGrid& grid, const std::vector<int>& standingCells, const std::vector<int>& targetCells,
+		const std::vector<int>& skillRanges);
+
+	//Sizes the sets to the grid, rebuilding the map mask if the grid has changed
+	void ResizeBuffers(const NavGrid& grid, int skillCount);
+	//Zeroes the words the last search wrote to
+	void ClearDirtyWords();
+
+	////////////
+	/// Data ///
+	////////////
+
+	//Set bit for every map cell (the border clear), clipping the dilation to the map
+	TileBitset m_MapMask;
+	int m_MaskWidth = 0;
+	int m_MaskHeight = 0;
+
+	TileBitset m_StandingSet;
+	//Dilated set, and the buffer the next step is written to
+	TileBitset m_Current;
+	TileBitset m_Next;
+	//Dilated set per skill slot
+	std::vector<TileBitset> m_ThreatSets;
+
+	//Skill slots in order of range
+	std::vector<int> m_SkillOrder;
+	std::vector<AttackOption> m_Options;
+
+	//Word range written by the last search (inclusive, empty if first > last)
+	int m_DirtyFirstWord = 0;
+	int m_DirtyLastWord = -1;
+};
@@ -0,0 +1,257 @@
+#include "BenchmarkMaps.h"
+
+#include <random>		//Map generation
+#include <algorithm>	//std::min, std::max
+#include <fstream>		//File check
+#include <unordered_map>
+
+#if __has_include("document.h")
+#define BENCHMARK_HAS_RAPIDJSON 1
+#include "../RapidJSONLoaderUtils.h"
+#else
+#define BENCHMARK_HAS_RAPIDJSON 0
+#endif
+
+namespace
+{
+	//Terrain types, matching UnitEntity::UNIT_TYPE
+	const int LAND_TERRAIN = 0;
+	const int SEA_TERRAIN = 1;
+
+	//Tiled rotation flags (see TiledLoaders)
+	const unsigned TILED_FLAG_MASK = 0x80000000 | 0x40000000 | 0x20000000;
+
+	TileProperties MakeTile(const char* name, float moveCost, int terrainType, bool impassable)
+	{
+		TileProperties props;
+		props.tileName = name;
+		props.moveCost = moveCost;
+		props.terrainTypeID = terrainType;
+		props.impassable = impassable;
+		props.occupied = false;
+		return props;
+	}
+
+	//Tile types drawn from Tilemap_00
+	const TileProperties GRASS = MakeTile("Grass", 1.f, LAND_TERRAIN, false);
+	const TileProperties GRASS_PATH = MakeTile("Grass Paths", 0.5f, LAND_TERRAIN, false);
+	const TileProperties SAND = MakeTile("Sand", 1.5f, LAND_TERRAIN, false);
+	const TileProperties BRIDGE = MakeTile("Bridge", 1.f, LAND_TERRAIN, false);
+	const TileProperties STONE = MakeTile("Stone", 1.f, LAND_TERRAIN, true);
+	const TileProperties WATER = MakeTile("Water", 1.f, SEA_TERRAIN, false);
+
+	void GenerateMaze(BenchmarkMap& map, std::mt19937& rng)
+	{
+		int size = map.width;
+		map.tiles.assign(size * size, STONE);
+
+		//Recursive backtracker over the odd coordinates, carving the wall between each step
+		std::vector<int> stack;
+		stack.reserve(size * size / 4);
+		map.tiles[1 + 1 * size] = GRASS;
+		stack.push_back(1 + 1 * size);
+
+		const int dx[4] = { 0, 2, 0, -2 };
+		const int dy[4] = { -2, 0, 2, 0 };
+		while (!stack.empty())
+		{
+			int tile = stack.back();
+			int x = tile % size;
+			int y = tile / size;
+
+			//Gather the unvisited cells two steps away
+			int options[4];
+			int optionCount = 0;
+			for (int i(0); i < 4; ++i)
+			{
+				int nx = x + dx[i];
+				int ny = y + dy[i];
+				if (nx > 0 && ny > 0 && nx < size - 1 && ny < size - 1 && map.tiles[nx + ny * size].impassable)
+					options[optionCount++] = i;
+			}
+
+			if (optionCount == 0)
+			{
+				stack.pop_back();
+				continue;
+			}
+
+			int dir = options[rng() % optionCount];
+			map.tiles[(x + dx[dir] / 2) + (y + dy[dir] / 2) * size] = GRASS;
+			map.tiles[(x + dx[dir]) + (y + dy[dir]) * size] = GRASS;
+			stack.push_back((x + dx[dir]) + (y + dy[dir]) * size);
+		}
+
+		//Knock through some walls so there is more than one route between most cells
+		std::uniform_int_distribution<int> coord(1, size - 2);
+		int openings = size * size / 64;
+		for (int i(0); i < openings; ++i)
+		{
+			int x = coord(rng);
+			int y = coord(rng);
+			if ((x + y) % 2 == 1)
+				map.tiles[x + y * size] = GRASS;
+		}
+	}
+
+	void GenerateRivers(BenchmarkMap& map, std::mt19937& rng)
+	{
+		int size = map.width;
+		map.tiles.assign(size * size, GRASS);
+
+		//One river per 32 rows, each wandering across the map left to right
+		int riverCount = std::max(1, size / 32);
+		std::uniform_int_distribution<int> wander(-1, 1);
+		std::uniform_int_distribution<int> bridgeChance(0, 47);
+		for (int r(0); r < riverCount; ++r)
+		{
+			int y = (r * size) / riverCount + size / (riverCount * 2);
+			for (int x(0); x < size; ++x)
+			{
+				y = std::min(std::max(y + wander(rng), 1), size - 3);
+				bool bridge = bridgeChance(rng) == 0;
+
+				//Two tiles deep so the river can't be cut across at a diagonal step
+				for (int depth(0); depth < 2; ++depth)
+					map.tiles[x + (y + depth) * size] = bridge ? BRIDGE : STONE;
+			}
+		}
+
+		//Sandy banks are slower to cross
+		for (int i(0); i < size * size; ++i)
+		{
+			if (map.tiles[i].impassable)
+				continue;
+			int y = i / size;
+			if ((y > 0 && map.tiles[i - size].impassable) || (y < size - 1 && map.tiles[i + size].impassable))
+				map.tiles[i] = SAND;
+		}
+	}
+
+	void GenerateMixedTerrain(BenchmarkMap& map, std::mt19937& rng)
+	{
+		int size = map.width;
+		map.tiles.resize(size * size);
+
+		std::uniform_int_distribution<int> terrain(0, 9);
+		for (auto& t : map.tiles)
+		{
+			int roll = terrain(rng);
+			t = roll < 5 ? GRASS : (roll < 8 ? SAND : GRASS_PATH);
+		}
+
+		//Scatter round lakes of sea terrain, blocking land units in patches
+		std::uniform_int_distribution<int> coord(0, size - 1);
+		std::uniform_int_distribution<int> radius(1, 6);
+		int lakeCount = size * size / 200;
+		for (int i(0); i < lakeCount; ++i)
+		{
+			int cx = coord(rng);
+			int cy = coord(rng);
+			int r = radius(rng);
+			for (int y(std::max(cy - r, 0)); y <= std::min(cy + r, size - 1); ++y)
+				for (int x(std::max(cx - r, 0)); x <= std::min(cx + r, size - 1); ++x)
+					if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r)
+						map.tiles[x + y * size] = WATER;
+		}
+	}
+}
+
+const char* BenchmarkMaps::GetTypeName(BENCHMARK_MAP_TYPE type)
+{
+	switch (type)
+	{
+	case BENCHMARK_MAP_TYPE::OPEN_FIELD:
+		return "open";
+	case BENCHMARK_MAP_TYPE::MAZE:
+		return "maze";
+	case BENCHMARK_MAP_TYPE::RIVERS:
+		return "rivers";
+	case BENCHMARK_MAP_TYPE::MIXED_TERRAIN:
+		return "mixed";
+	case BENCHMARK_MAP_TYPE::TILEMAP:
+		return "tilemap";
+	}
+	return "unknown";
+}
+
+void BenchmarkMaps::GenerateMap(BenchmarkMap& map, BENCHMARK_MAP_TYPE type, int size, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+
+	map.type = type;
+	map.width = size;
+	map.height = size;
+	map.name = std::string(GetTypeName(type)) + "_" + std::to_string(size);
+
+	switch (type)
+	{
+	case BENCHMARK_MAP_TYPE::OPEN_FIELD:
+		map.tiles.assign(size * size, GRASS);
+		break;
+	case BENCHMARK_MAP_TYPE::MAZE:
+		GenerateMaze(map, rng);
+		break;
+	case BENCHMARK_MAP_TYPE::RIVERS:
+		GenerateRivers(map, rng);
+		break;
+	case BENCHMARK_MAP_TYPE::MIXED_TERRAIN:
+		GenerateMixedTerrain(map, rng);
+		break;
+	case BENCHMARK_MAP_TYPE::TILEMAP:
+		map.tiles.clear();
+		break;
+	}
+}
+
+bool BenchmarkMaps::LoadTilemap(BenchmarkMap& map, const std::string& filePath)
+{
+	map.tiles.clear();
+	map.width = 0;
+	map.height = 0;
+
+	//ParseNewJSONDocument asserts on a bad file, so check it can be opened first
+	if (!std::ifstream(filePath).good())
+		return false;
+
+#if BENCHMARK_HAS_RAPIDJSON
+	rapidjson::Document doc;
+	std::string path = filePath;
+	ParseNewJSONDocument(doc, path);
+	if (!doc.IsObject() || !doc.HasMember("layers") || !doc.HasMember("tilesets"))
+		return false;
+
+	//Same property layout as TiledLoaders::LoadTilePropertiesData
+	std::unordered_map<int, TileProperties> properties;
+	for (auto& a : doc["tilesets"][0]["tiles"].GetArray())
+	{
+		TileProperties props;
+		props.tileID = a["id"].GetInt();
+		props.impassable = a["properties"][1]["value"].GetBool();
+		props.moveCost = a["properties"][2]["value"].GetFloat();
+		props.occupied = a["properties"][3]["value"].GetBool();
+		props.tileName = a["properties"][4]["value"].GetString();
+		props.terrainTypeID = a["properties"][5]["value"].GetInt();
+		properties.insert({ props.tileID, props });
+	}
+
+	map.type = BENCHMARK_MAP_TYPE::TILEMAP;
+	map.width = doc["width"].GetInt();
+	map.height = doc["height"].GetInt();
+	map.name = "tilemap_" + std::to_string(map.width);
+	map.tiles.resize(map.width * map.height);
+
+	const rapidjson::Value& data = doc["layers"][0]["data"];
+	for (int i(0); i < map.width * map.height; ++i)
+	{
+		//Strip the rotation flags and the Tiled offset to find the tiles properties
+		unsigned tileID = data[i].GetUint() & ~TILED_FLAG_MASK;
+		auto it = properties.find(static_cast<int>(tileID) - 1);
+		if (it != properties.end())
+			map.tiles[i] = it->second;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
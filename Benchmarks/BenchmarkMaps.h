@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "../GameTypes.h"		//Tile properties
+
+/*
+	Map corpus for the pathfinding benchmarks. Maps are held as the tile properties the game would load
+	(left->right, top->bot), so they are built into a NavGrid exactly as MainGameMode builds the real map.
+
+	Generated maps are deterministic for a given size and seed, so results can be compared between builds.
+*/
+
+enum class BENCHMARK_MAP_TYPE
+{
+	//Grass everywhere
+	OPEN_FIELD,
+	//Corridors one tile wide between impassable walls, with a few walls knocked through to add loops
+	MAZE,
+	//Open land crossed by meandering rivers of impassable tiles, with occasional bridges
+	RIVERS,
+	//Land of mixed move costs, with lakes of sea terrain that land units can't enter
+	MIXED_TERRAIN,
+	//Loaded from a Tiled export (e.g. Tilemap_00.json)
+	TILEMAP
+};
+
+struct BenchmarkMap
+{
+	std::string name;
+	BENCHMARK_MAP_TYPE type = BENCHMARK_MAP_TYPE::OPEN_FIELD;
+	int width = 0;
+	int height = 0;
+	std::vector<TileProperties> tiles;
+};
+
+namespace BenchmarkMaps
+{
+	//Display name of a map type
+	const char* GetTypeName(BENCHMARK_MAP_TYPE type);
+
+	//Generates a size * size map of the given type (not TILEMAP)
+	void GenerateMap(BenchmarkMap& map, BENCHMARK_MAP_TYPE type, int size, uint32_t seed);
+
+	/*
+		Loads the first layer and tileset properties of a Tiled JSON export, as TiledLoaders does for the game.
+		Returns false (leaving the map empty) if the file can't be read, or the benchmark was built without RapidJSON.
+	*/
+	bool LoadTilemap(BenchmarkMap& map, const std::string& filePath);
+}
@@ -0,0 +1,1981 @@
+/*
+	Headless pathfinding benchmark. Builds the same NavGrid the game searches from Tilemap_00 and a generated
+	map corpus, then times the search engines behind the game systems:
+
+	- range:  MovementRangeSearch, as run by MapTilePathfinder::GenerateTileGrid
+	- rangeN: the same for a unit with a TotalMovespeed of N, from the slowest class to crossing a large map (checked
+	          against a fresh search, as each search only resets the cells the one before reached)
+	- astar:  RunPathQuery with A*, as run by MapTilePathfinder::RunAStarAlgorithm
+	- linear: A* over the open and closed lists MapTilePathfinder::RunAStarAlgorithm first kept (vectors, scanned
+	          linearly), to goals within LINEAR_MOVE_RANGE of the start as a cursor moves within a long move range
+	- astarmove: RunPathQuery with A* over the same queries (checked against linear, with the speedup reported)
+	- jps:    RunPathQuery with jump point search, checked against astar
+	- jpsbuild: JumpPointTable::Build for land units
+	- alt:    RunPathQuery with A* over landmark distances (ALT), checked against astar
+	- altbuild: LandmarkHeuristic::Build for land units (altload: the same loaded from --landmark-cache)
+	- hpabuild: HierarchicalPathfinder::Build (clusters of DEFAULT_CLUSTER_SIZE) for land units
+	- hpaquery: HierarchicalPathfinder::FindAbstractPath over the astar queries (expanded counts abstract nodes)
+	- hpanear: the same, refining only the first HPA_LOOKAHEAD cells as a unit about to move would
+	- hpa:    the same, refining the whole path (checked against astar for reachability and a valid route, with
+	          the mean and worst cost over astars reported)
+	- replan: IncrementalPathPlanner repairing a units route to the nearest of REPLAN_GOAL_COUNT goals after a
+	          unit steps onto the route (and the one that stepped on REPLAN_BLOCKERS steps before steps off), as
+	          MapTile::SetOccupationStatus flips tiles
+	- replanfull: the same routes found by a fresh goal set A* after each step (checked against replan)
+	- layerN: RunPathQuery with A* over N cost layers (enemy threat, hazards, preference), summed per cell
+	- layerNp: the same with the layers precomputed into one array
+	- layerNb: the same with each querys budget cut to its cheapest move cost, as MapTilePathfinder::FindPath limits
+	          paths to the units move budget (every goal A* reaches in budget must still be reached, expanded counts
+	          the routes taken, several a cell where a dearer route spends less of the budget)
+	- goalsN: RunPathQuery with a set of N goals, as run by MapTilePathfinder::FindPathToNearest
+	- astarN: the same N goals found with N separate A* queries, keeping the cheapest
+	- target: the range shape stamp behind DiamondRadiusTargeting::GenerateTargetGrid/GenerateAoEGrid, laid into
+	          a tile overlay a row span at a time and cleared again
+	- shapes: each range shape (diamond, square, line, cone, ring) at a radius of SHAPE_RADIUS, stamped the same way
+	- shapecell: the same shapes stamped a tile at a time, testing each tile of the bounding square
+	- losbuild: VisibilityCache::Build out to the longest skill range, on every hardware thread (losbuild1: one)
+	- los:    the tiles a ranged skill can target, as the target grid lays them out (range shape AND window)
+	- loswalk: the same tiles found by walking a line to every tile in range
+	- overlay: union and intersection of a movement range and an attack range overlay, then clearing both
+	- attackN: AttackRangeSearch against N targets, as run by MapTilePathfinder::FindAttackOptions
+	- naiveN: the same options found by laying out each skills range around every reachable cell
+	- aoeN:   AoEPlacementSearch for the best AOE_PLACEMENTS centres against N targets, cycling the area shapes
+	- aoenaiveN: the same placements found by stamping the area at every centre in range and testing every target
+	- occupyN: UnitOccupancyMap with N units a team, finding the unit under the cursor and the living enemies under
+	          an AoE, as the cursor and MainGameMode::AOE do
+	- scanN:  the same found by scanning every unit for the cursor and testing every enemy against the AoE grid
+	- combat: CombatResolver::Resolve for a batch of COMBAT_BATCH skill uses between random units
+	- combatreplay: the same batches again from the same seeds, which must give the same outcomes
+	- rngroll: RANDOM_FILL_WORDS words of a RandomStream, drawn one at a time
+	- rngfill: the same words from RandomStream::Fill (4 blocks at a time with SSE2)
+	- rngfillmt: the same from RandomStream::FillParallel on every hardware thread (checked word for word against
+	          rngroll, including fills starting part way through a block)
+	- forecast: CombatForecast::Forecast for every user, target and skill of the combat units
+	- turnN:  a DamageSequence of N damage skill uses against each combat unit (checked against resolving the same
+	          uses FORECAST_TRIALS times)
+	- coopN:  CooperativePathPlanner moving a batch of N units (friendly units pass through each other)
+	- strictN: the same batches with no two units on a tile at once
+
+	Reported per map and search: ns per query, nodes expanded per query, heap allocations per query (once warm)
+	and the peak scratch memory the search allocated. See Benchmarks/Makefile for building and options.
+
+	Before the rows, a small hand built map checks a budgeted search with cost layers takes the threat free route
+	in budget rather than the cheaper threatened one it can't afford (any failure is reported on stderr).
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <new>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkMaps.h"
+#include "../NavGrid.h"
+#include "../PathQuery.h"
+#include "../MovementRange.h"
+#include "../ConnectivityMap.h"
+#include "../AttackRange.h"
+#include "../CooperativePathPlanner.h"
+#include "../PathCostLayers.h"
+#include "../LandmarkHeuristic.h"
+#include "../JumpPointSearch.h"
+#include "../HierarchicalPathfinder.h"
+#include "../IncrementalPathPlanner.h"
+#include "../PathfindingContainers.h"
+#include "../TileOverlay.h"
+#include "../LineOfSight.h"
+#include "../AoEPlacement.h"
+#include "../UnitOccupancy.h"
+#include "../CombatResolver.h"
+#include "../CounterRandom.h"
+#include "../CombatForecast.h"
+
+//
+// Allocation tracking
+//
+
+namespace
+{
+	//Running totals of the global heap, updated by the operator new/delete replacements below
+	struct AllocationStats
+	{
+		size_t count = 0;
+		size_t currentBytes = 0;
+		size_t peakBytes = 0;
+	};
+	AllocationStats g_Allocations;
+
+	//Header in front of each block, holding its size (keeps the returned block max aligned)
+	constexpr size_t ALLOCATION_HEADER = alignof(std::max_align_t);
+
+	void* TrackedAlloc(size_t size)
+	{
+		unsigned char* block = static_cast<unsigned char*>(std::malloc(size + ALLOCATION_HEADER));
+		if (!block)
+			throw std::bad_alloc();
+
+		*reinterpret_cast<size_t*>(block) = size;
+		++g_Allocations.count;
+		g_Allocations.currentBytes += size;
+		if (g_Allocations.currentBytes > g_Allocations.peakBytes)
+			g_Allocations.peakBytes = g_Allocations.currentBytes;
+		return block + ALLOCATION_HEADER;
+	}
+
+	void TrackedFree(void* ptr)
+	{
+		if (!ptr)
+			return;
+
+		unsigned char* block = static_cast<unsigned char*>(ptr) - ALLOCATION_HEADER;
+		g_Allocations.currentBytes -= *reinterpret_cast<size_t*>(block);
+		std::free(block);
+	}
+}
+
+void* operator new(size_t size) { return TrackedAlloc(size); }
+void* operator new[](size_t size) { return TrackedAlloc(size); }
+void operator delete(void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { TrackedFree(ptr); }
+
+//
+// Benchmark
+//
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	//Terrain type of the units searched for (UnitEntity::UNIT_TYPE::LAND)
+	const int LAND_UNIT = 0;
+	//Number of unit types labelled by the connectivity map (LAND, SEA, AIR)
+	const int UNIT_TYPE_COUNT = 3;
+	//Typical unit movement and skill ranges
+	const float MOVE_RANGE = 6.f;
+	const int TARGET_RANGE = 3;
+	//Radius of the stamped shapes, large AoE skill sized
+	const int SHAPE_RADIUS = 10;
+	//Goal set sizes for the nearest goal searches, up to TEAM_SIZE enemies * 4 skills
+	const int GOAL_COUNTS[] = { 4, 5 * 4 };
+	//Skill slot ranges for the attack searches (basic attack, then 3 skills)
+	const std::vector<int> SKILL_RANGES = { 1, 2, 3, 4 };
+	//Target counts for the attack searches, from TEAM_SIZE up to large skirmishes
+	const int TARGET_COUNTS[] = { 5, 100, 400 };
+	//Targets are placed within this many tiles (each axis) of the attacker
+	const int TARGET_SPREAD = 12;
+	//Unit TotalMovespeeds swept by the movement range searches
+	const float MOVE_SPEEDS[] = { 3.f, 6.f, 12.f, 25.f, 50.f };
+	//Range and radius of the AoE placement searches ("Arcane explosion"), and the placements kept
+	const int AOE_RANGE = 4;
+	const int AOE_RADIUS = 3;
+	const int AOE_PLACEMENTS = 4;
+	//Units a team for the occupancy lookups, from TEAM_SIZE up to large armies (every DEAD_UNIT_STEP th unit is dead)
+	const int TEAM_UNIT_COUNTS[] = { 5, 1000, 4000 };
+	const int DEAD_UNIT_STEP = 5;
+	//Skill uses resolved per combat query, and the units and skills they are drawn from
+	const int COMBAT_BATCH = 1024;
+	const int COMBAT_UNIT_COUNT = 64;
+	//Words per random fill, and the fills made for every 64 queries
+	const int RANDOM_FILL_WORDS = 1 << 20;
+	const int RANDOM_FILLS_PER_64_QUERIES = 1;
+	//Damage skill uses a forecast turn, and the units whose turns are checked by resolving them FORECAST_TRIALS times
+	const int TURN_USES = 5;
+	const int FORECAST_CHECKS = 8;
+	const int FORECAST_TRIALS = 20000;
+	//Batch sizes for the cooperative planner, from TEAM_SIZE up to large armies
+	const int SQUAD_SIZES[] = { 5, 50, 500 };
+	//Tiles a squad is ordered to move by
+	const int SQUAD_MOVE_DISTANCE = 8;
+	//Cells refined ahead by the hpanear queries
+	const int HPA_LOOKAHEAD = 16;
+	//Goals of the replanning unit, and the units standing on its route at once
+	const int REPLAN_GOAL_COUNT = 4;
+	const int REPLAN_BLOCKERS = 8;
+	//Move range the linear and astarmove goals are picked within, and the most queries they run
+	const float LINEAR_MOVE_RANGE = 48.f;
+	const int LINEAR_QUERY_LIMIT = 100;
+	//Landmark tables are only built up to this many cells (building is two Dijkstra searches per landmark)
+	const long long LANDMARK_CELL_LIMIT = 1024ll * 1024;
+	//Longest skill range in AbilityData.json ("Ranged Basic Attack"), and the largest map given a visibility cache
+	const int LOS_RANGE = 6;
+	const long long VISIBILITY_CELL_LIMIT = 1024ll * 1024;
+	//One threat source per this many cells, threatening cells within move plus skill range
+	const int THREAT_CELLS_PER_SOURCE = 256;
+	const int THREAT_RADIUS = 9;
+	//Share of cells (out of 100) given a hazard or a preference cost
+	const int HAZARD_PERCENT = 10;
+	const int PREFERENCE_PERCENT = 25;
+	//Path queries are cut back on big maps to keep each run to roughly this many cells searched
+	const long long PATH_QUERY_CELL_BUDGET = 64ll * 1024 * 1024;
+
+	struct BenchmarkOptions
+	{
+		std::vector<int> sizes = { 64, 256, 1024, 4096 };
+		int queries = 1000;
+		uint32_t seed = 1;
+		std::string tilemapPath = "../bin/data/sprites/tilemaps/Tilemap_00.json";
+		bool csv = false;
+		//Directory to write path query traces to (empty for no tracing)
+		std::string traceDir;
+		//Directory to cache landmark tables in (empty to always build them)
+		std::string landmarkCacheDir;
+	};
+
+	struct BenchmarkResult
+	{
+		const char* search = "";
+		int queries = 0;
+		double nsPerQuery = 0.0;
+		double expandedPerQuery = 0.0;
+		double allocationsPerQuery = 0.0;
+		size_t peakScratchBytes = 0;
+	};
+
+	/*
+		Times a search. setup is run once before timing (constructing the search objects), then query(i) is run once
+		to warm the scratch buffers, then for each timed query. query returns the number of nodes it expanded.
+	*/
+	template<typename Setup, typename Query>
+	BenchmarkResult RunBenchmark(const char* search, int queryCount, Setup&& setup, Query&& query)
+	{
+		BenchmarkResult result;
+		result.search = search;
+		result.queries = queryCount;
+
+		//Peak scratch is measured from here, so it includes the search objects and their warm up growth
+		size_t baseline = g_Allocations.currentBytes;
+		g_Allocations.peakBytes = baseline;
+		auto state = setup();
+		query(state, 0);
+
+		size_t allocationsBefore = g_Allocations.count;
+		long long expanded = 0;
+		Clock::time_point start = Clock::now();
+		for (int i(0); i < queryCount; ++i)
+			expanded += query(state, i);
+		Clock::time_point end = Clock::now();
+
+		double queries = static_cast<double>(queryCount);
+		result.nsPerQuery = std::chrono::duration<double, std::nano>(end - start).count() / queries;
+		result.expandedPerQuery = static_cast<double>(expanded) / queries;
+		result.allocationsPerQuery = static_cast<double>(g_Allocations.count - allocationsBefore) / queries;
+		result.peakScratchBytes = g_Allocations.peakBytes - baseline;
+		return result;
+	}
+
+	void PrintHeader(const BenchmarkOptions& options)
+	{
+		if (options.csv)
+			std::printf("map,search,queries,ns_per_query,expanded_per_query,allocs_per_query,peak_scratch_bytes\n");
+		else
+			std::printf("%-16s %-9s %8s %14s %14s %12s %14s\n",
+				"map", "search", "queries", "ns/query", "expanded/q", "allocs/q", "scratch KiB");
+	}
+
+	void PrintResult(const BenchmarkOptions& options, const BenchmarkMap& map, const BenchmarkResult& r)
+	{
+		if (options.csv)
+			std::printf("%s,%s,%d,%.1f,%.1f,%.3f,%zu\n", map.name.c_str(), r.search, r.queries,
+				r.nsPerQuery, r.expandedPerQuery, r.allocationsPerQuery, r.peakScratchBytes);
+		else
+			std::printf("%-16s %-9s %8d %14.1f %14.1f %12.3f %14.1f\n", map.name.c_str(), r.search, r.queries,
+				r.nsPerQuery, r.expandedPerQuery, r.allocationsPerQuery, r.peakScratchBytes / 1024.0);
+	}
+
+	/*
+		A* as MapTilePathfinder::RunAStarAlgorithm was first written: the open and closed lists are vectors, scanned
+		in full for the cheapest open node and for membership, so each expansion is O(n) and a search O(n^2). Costs
+		are tracked as RunPathQuery tracks them, so it finds paths exactly as cheap, kept as the reference the
+		indexed heap and closed bitset are measured against.
+	*/
+	class LinearAStar
+	{
+	public:
+
+		//Returns the path cost (-1 if there is none), adding the nodes expanded to expanded
+		float Run(const NavGrid& grid, int startCell, int goalCell, int unitType, long long& expanded)
+		{
+			m_GCosts.resize(grid.GetCellCount());
+			m_FCosts.resize(grid.GetCellCount());
+			m_Open.clear();
+			m_Closed.clear();
+
+			int goalX = grid.GetCellX(goalCell);
+			int goalY = grid.GetCellY(goalCell);
+			float minMoveCost = grid.GetMinMoveCost();
+			auto heuristic = [&](int cell)
+			{
+				return (std::abs(goalX - grid.GetCellX(cell)) + std::abs(goalY - grid.GetCellY(cell))) * minMoveCost;
+			};
+
+			m_GCosts[startCell] = 0.f;
+			m_FCosts[startCell] = heuristic(startCell);
+			m_Open.push_back(startCell);
+			while (!m_Open.empty())
+			{
+				//Find the lowest F cost node, and move it from the open list to the closed list
+				size_t lowest = 0;
+				for (size_t i(1); i < m_Open.size(); ++i)
+					if (m_FCosts[m_Open[i]] < m_FCosts[m_Open[lowest]])
+						lowest = i;
+				int currentCell = m_Open[lowest];
+				m_Open.erase(m_Open.begin() + lowest);
+				m_Closed.push_back(currentCell);
+				++expanded;
+
+				if (currentCell == goalCell)
+					return m_GCosts[currentCell] / NavGrid::MOVE_COST_SCALE;
+
+				for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+				{
+					int neighbour = currentCell + grid.GetNeighbourOffset(i);
+					if (!grid.CanEnter(neighbour, unitType) || std::find(m_Closed.begin(), m_Closed.end(), neighbour) != m_Closed.end())
+						continue;
+
+					float newG = m_GCosts[currentCell] + NavGrid::Topology::StepCost(i, grid.GetMoveCost(neighbour));
+					bool isOpen = std::find(m_Open.begin(), m_Open.end(), neighbour) != m_Open.end();
+					if (isOpen && newG >= m_GCosts[neighbour])
+						continue;
+
+					m_GCosts[neighbour] = newG;
+					m_FCosts[neighbour] = newG + heuristic(neighbour);
+					if (!isOpen)
+						m_Open.push_back(neighbour);
+				}
+			}
+			return -1.f;
+		}
+
+	private:
+
+		std::vector<int> m_Open;
+		std::vector<int> m_Closed;
+		std::vector<float> m_GCosts;
+		std::vector<float> m_FCosts;
+	};
+
+	/*
+		Checks a cooperative plan without relying on the planner: every route starts on its start and steps between
+		neighbouring cells the unit can enter (or waits, STRICT only) within its budget, no two units end on the same
+		cell, and under STRICT no two units share a cell at a step or swap cells. Returns an empty string if valid.
+	*/
+	std::string CheckCooperativePlan(const NavGrid& grid, const std::vector<CooperativeMoveRequest>& requests,
+		const CooperativePathPlanner& planner)
+	{
+		bool strict = planner.GetConflictMode() == COOPERATIVE_CONFLICTS::STRICT;
+		int unitCount = static_cast<int>(requests.size());
+		std::vector<uint8_t> isStart(grid.GetCellCount(), 0);
+		for (auto& r : requests)
+			isStart[r.startCell] = 1;
+		auto canEnter = [&](int cell, int unitType)
+		{
+			return grid.CanEnter(cell, unitType) || (isStart[cell] &&
+				!(grid.GetFlags(cell) & (NavGrid::IMPASSABLE | NavGrid::BORDER)) && grid.GetTerrainType(cell) == unitType);
+		};
+
+		int longest = 0;
+		for (int u(0); u < unitCount; ++u)
+		{
+			PathResult plan = planner.GetPlan(u);
+			const CooperativeMoveRequest& r = requests[u];
+			std::string unit = "unit " + std::to_string(u);
+			if (!plan.IsValid() || plan.cells[0] != r.startCell)
+				return unit + " does not start on its start";
+			if (planner.IsGoalReached(u) != (plan.cells[plan.length - 1] == r.goalCell))
+				return unit + " goal reached flag is wrong";
+
+			int moveCost = 0;
+			for (int t(1); t < plan.length; ++t)
+			{
+				int from = plan.cells[t - 1];
+				int to = plan.cells[t];
+				if (from == to)
+				{
+					if (!strict)
+						return unit + " waits without needing to";
+					continue;
+				}
+
+				int direction = -1;
+				for (int d(0); d < NavGrid::NEIGHBOUR_COUNT; ++d)
+					if (from + grid.GetNeighbourOffset(d) == to)
+						direction = d;
+				if (direction == -1 || !canEnter(to, r.unitType))
+					return unit + " makes an illegal step at " + std::to_string(t);
+				moveCost += NavGrid::Topology::StepCost(direction, grid.GetMoveCost(to));
+			}
+			if (moveCost > r.maxCost)
+				return unit + " is over budget";
+			longest = std::max(longest, plan.length);
+		}
+
+		//Units stay on their last cell once arrived
+		auto cellAt = [&](int u, int t)
+		{
+			PathResult plan = planner.GetPlan(u);
+			return plan.cells[std::min(t, plan.length - 1)];
+		};
+
+		if (!strict)
+		{
+			std::vector<int> owners(grid.GetCellCount(), -1);
+			for (int u(0); u < unitCount; ++u)
+			{
+				int& owner = owners[cellAt(u, longest)];
+				if (owner != -1)
+					return "units " + std::to_string(owner) + " and " + std::to_string(u) + " end on the same cell";
+				owner = u;
+			}
+			return "";
+		}
+
+		//Owner of each cell at the previous and current step
+		std::vector<int> previous(grid.GetCellCount(), -1);
+		std::vector<int> current(grid.GetCellCount(), -1);
+		for (int t(0); t <= longest; ++t)
+		{
+			for (int u(0); u < unitCount; ++u)
+			{
+				int& owner = current[cellAt(u, t)];
+				if (owner != -1)
+					return "units " + std::to_string(owner) + " and " + std::to_string(u) + " share a cell at step " + std::to_string(t);
+				owner = u;
+			}
+
+			if (t > 0)
+			{
+				//A swap is two units each stepping onto the others cell
+				for (int u(0); u < unitCount; ++u)
+				{
+					int from = cellAt(u, t - 1);
+					int to = cellAt(u, t);
+					int other = previous[to];
+					if (from != to && other != -1 && other != u && cellAt(other, t) == from)
+						return "units " + std::to_string(u) + " and " + std::to_string(other) + " swap at step " + std::to_string(t);
+				}
+				for (int u(0); u < unitCount; ++u)
+					previous[cellAt(u, t - 1)] = -1;
+			}
+			previous.swap(current);
+		}
+		return "";
+	}
+
+	/*
+		Checks a budgeted query with cost layers on a small map built so the cheapest layered route to the cell at
+		(2, 2), the detour under the mild threat (t), spends too much of the budget to reach the goal from there. The
+		route through the mild threat is in budget, and must be found rather than the one through heavy threat (H).
+		Returns an empty string if the query finds it.
+	*/
+	std::string CheckBudgetedLayers()
+	{
+		const char* rows[] =
+		{
+			"SHHHHG",
+			".####.",
+			".t....",
+			"...###"
+		};
+		const int width = 6;
+		const int height = 4;
+		const float HEAVY_THREAT = 40.f;
+		const float MILD_THREAT = 3.f;
+
+		std::vector<TileProperties> tiles(width * height);
+		for (int y(0); y < height; ++y)
+		{
+			for (int x(0); x < width; ++x)
+			{
+				TileProperties& tile = tiles[y * width + x];
+				tile.terrainTypeID = LAND_UNIT;
+				tile.moveCost = 1.f;
+				tile.impassable = rows[y][x] == '#';
+			}
+		}
+		NavGrid grid;
+		grid.Build(tiles, width, height);
+
+		std::vector<float> threat(grid.GetCellCount(), 0.f);
+		for (int y(0); y < height; ++y)
+			for (int x(0); x < width; ++x)
+				threat[grid.CoordsToCell(x, y)] = rows[y][x] == 'H' ? HEAVY_THREAT : (rows[y][x] == 't' ? MILD_THREAT : 0.f);
+		PathCostLayers layers;
+		layers.AddLayer(threat.data());
+
+		PathQuery query;
+		query.startCell = grid.CoordsToCell(0, 0);
+		query.goalCell = grid.CoordsToCell(5, 0);
+		query.unitType = LAND_UNIT;
+		query.maxCost = NavGrid::QuantiseBudget(10.f);
+		query.costLayers = &layers;
+		PathSearchArena arena;
+		PathResult result = RunPathQuery(query, grid, arena);
+		if (!result.IsValid())
+			return "no path found within the budget";
+
+		float threatTaken = 0.f;
+		for (int cell : result)
+			threatTaken += threat[cell];
+		if (result.cost != 9.f || threatTaken != MILD_THREAT)
+			return "path costs " + std::to_string(result.cost) + " moves through " + std::to_string(threatTaken) +
+				" threat, not 9 moves through " + std::to_string(MILD_THREAT);
+		return "";
+	}
+
+	void RunMapBenchmarks(const BenchmarkOptions& options, const BenchmarkMap& map)
+	{
+		NavGrid grid;
+		grid.Build(map.tiles, map.width, map.height);
+		ConnectivityMap connectivity;
+		connectivity.Build(grid, UNIT_TYPE_COUNT);
+
+		//Gather the cells a land unit can stand on, to pick query endpoints from
+		std::vector<int> landCells;
+		for (int y(0); y < map.height; ++y)
+			for (int x(0); x < map.width; ++x)
+				if (grid.CanEnter(grid.CoordsToCell(x, y), LAND_UNIT))
+					landCells.push_back(grid.CoordsToCell(x, y));
+		if (landCells.empty())
+		{
+			std::fprintf(stderr, "%s: no enterable land cells, skipped\n", map.name.c_str());
+			return;
+		}
+
+		//Same endpoints for every search, so their results can be compared directly
+		std::mt19937 rng(options.seed);
+		std::uniform_int_distribution<size_t> pick(0, landCells.size() - 1);
+		std::vector<int> starts(options.queries);
+		std::vector<int> goals(options.queries);
+		for (int i(0); i < options.queries; ++i)
+		{
+			starts[i] = landCells[pick(rng)];
+			goals[i] = landCells[pick(rng)];
+		}
+
+		long long cellCount = static_cast<long long>(map.width) * map.height;
+		int pathQueries = static_cast<int>(std::max(8ll, std::min<long long>(options.queries, PATH_QUERY_CELL_BUDGET / cellCount)));
+		pathQueries = std::min(pathQueries, options.queries);
+
+		//
+		// Movement range
+		//
+
+		int budget = NavGrid::QuantiseBudget(MOVE_RANGE);
+		PrintResult(options, map, RunBenchmark("range", options.queries,
+			[]() { return std::unique_ptr<MovementRangeSearch>(new MovementRangeSearch()); },
+			[&](std::unique_ptr<MovementRangeSearch>& search, int i)
+			{
+				search->Run(grid, starts[i], LAND_UNIT, budget);
+				return static_cast<long long>(search->GetReachedCells().size());
+			}));
+
+		for (float moveSpeed : MOVE_SPEEDS)
+		{
+			int speedBudget = NavGrid::QuantiseBudget(moveSpeed);
+			std::string name = "range" + std::to_string(static_cast<int>(moveSpeed));
+			PrintResult(options, map, RunBenchmark(name.c_str(), options.queries,
+				[]() { return std::unique_ptr<MovementRangeSearch>(new MovementRangeSearch()); },
+				[&](std::unique_ptr<MovementRangeSearch>& search, int i)
+				{
+					search->Run(grid, starts[i], LAND_UNIT, speedBudget);
+					return static_cast<long long>(search->GetReachedCells().size());
+				}));
+		}
+
+		//A search reused after longer and shorter moves must reach the same cells as a fresh one
+		{
+			MovementRangeSearch reused;
+			int checks = std::min(options.queries, 16);
+			for (int i(0); i < checks; ++i)
+			{
+				int speedBudget = NavGrid::QuantiseBudget(MOVE_SPEEDS[i % (sizeof(MOVE_SPEEDS) / sizeof(MOVE_SPEEDS[0]))]);
+				MovementRangeSearch fresh;
+				reused.Run(grid, starts[i], LAND_UNIT, speedBudget);
+				fresh.Run(grid, starts[i], LAND_UNIT, speedBudget);
+				if (reused.GetRemainingMoves() != fresh.GetRemainingMoves() || reused.GetParents() != fresh.GetParents())
+				{
+					std::fprintf(stderr, "%s: a reused range search differs from a fresh one (query %d)\n", map.name.c_str(), i);
+					break;
+				}
+			}
+		}
+
+		//
+		// Path queries
+		//
+
+		//Landmarks for the ALT queries, timing the build (and the cache load, if caching)
+		LandmarkHeuristic landmarks;
+		bool useLandmarks = cellCount <= LANDMARK_CELL_LIMIT;
+		if (useLandmarks)
+		{
+			auto noState = []() { return 0; };
+			PrintResult(options, map, RunBenchmark("altbuild", 1, noState, [&](int&, int)
+			{
+				landmarks.Build(grid, LAND_UNIT + 1);
+				return 0ll;
+			}));
+
+			//The warm up run writes the cache, the timed run reads it
+			if (!options.landmarkCacheDir.empty())
+			{
+				PrintResult(options, map, RunBenchmark("altload", 1, noState, [&](int&, int)
+				{
+					if (!landmarks.Build(grid, LAND_UNIT + 1, LandmarkHeuristic::DEFAULT_LANDMARK_COUNT, options.landmarkCacheDir))
+						std::fprintf(stderr, "%s: could not write the landmark cache\n", map.name.c_str());
+					return 0ll;
+				}));
+				if (!landmarks.WasLoadedFromCache())
+					std::fprintf(stderr, "%s: landmarks were not loaded from the cache\n", map.name.c_str());
+			}
+		}
+		else
+			std::fprintf(stderr, "%s: over %lld cells, alt skipped\n", map.name.c_str(), LANDMARK_CELL_LIMIT);
+
+		//Run tables for the jump point queries
+		JumpPointTable jumpPoints;
+		{
+			auto noState = []() { return 0; };
+			PrintResult(options, map, RunBenchmark("jpsbuild", 1, noState, [&](int&, int)
+			{
+				if (!jumpPoints.Build(grid, LAND_UNIT + 1))
+					std::fprintf(stderr, "%s: too wide for jump point tables, jps runs A*\n", map.name.c_str());
+				return 0ll;
+			}));
+		}
+
+		PathTraceRecorder traces[3];
+		auto pathQuery = [&](PATH_SEARCH_METHOD method, PathTraceRecorder& trace)
+		{
+			return [&, method](std::unique_ptr<PathSearchArena>& arena, int i)
+			{
+				PathQuery query;
+				query.startCell = starts[i];
+				query.goalCell = goals[i];
+				query.unitType = LAND_UNIT;
+				query.searchMethod = method;
+				query.connectivity = &connectivity;
+				query.landmarks = &landmarks;
+				query.jumpPoints = &jumpPoints;
+				query.trace = options.traceDir.empty() ? nullptr : &trace;
+				RunPathQuery(query, grid, *arena);
+				return static_cast<long long>(arena->GetExpansionCount());
+			};
+		};
+		auto makeArena = []() { return std::unique_ptr<PathSearchArena>(new PathSearchArena()); };
+
+		PrintResult(options, map, RunBenchmark("astar", pathQueries, makeArena, pathQuery(PATH_SEARCH_METHOD::A_STAR, traces[0])));
+		PrintResult(options, map, RunBenchmark("jps", pathQueries, makeArena, pathQuery(PATH_SEARCH_METHOD::JUMP_POINT, traces[1])));
+		if (useLandmarks)
+			PrintResult(options, map, RunBenchmark("alt", pathQueries, makeArena, pathQuery(PATH_SEARCH_METHOD::ALT, traces[2])));
+
+		//JPS and ALT must find paths exactly as cheap as A*
+		{
+			const PATH_SEARCH_METHOD checkedMethods[2] = { PATH_SEARCH_METHOD::JUMP_POINT, PATH_SEARCH_METHOD::ALT };
+			const char* checkedNames[2] = { "jps", "alt" };
+			PathSearchArena arena;
+			for (int m(0); m < (useLandmarks ? 2 : 1); ++m)
+			{
+				for (int i(0); i < pathQueries; ++i)
+				{
+					PathQuery query;
+					query.startCell = starts[i];
+					query.goalCell = goals[i];
+					query.unitType = LAND_UNIT;
+					query.landmarks = &landmarks;
+					query.jumpPoints = &jumpPoints;
+					PathResult result = RunPathQuery(query, grid, arena);
+					float astarCost = result.IsValid() ? result.cost : -1.f;
+					query.searchMethod = checkedMethods[m];
+					result = RunPathQuery(query, grid, arena);
+					float checkedCost = result.IsValid() ? result.cost : -1.f;
+					if (checkedCost != astarCost)
+					{
+						std::fprintf(stderr, "%s: %s found cost %.1f where astar found %.1f (query %d)\n", map.name.c_str(),
+							checkedNames[m], checkedCost, astarCost, i);
+						break;
+					}
+				}
+			}
+		}
+
+		//
+		// Baseline A*
+		//
+
+		{
+			//Goals a long move from each start, found by a movement range search as the cursor is limited to it
+			int linearQueries = std::min(options.queries, LINEAR_QUERY_LIMIT);
+			std::vector<int> moveGoals(linearQueries);
+			{
+				std::mt19937 moveRng(options.seed);
+				MovementRangeSearch range;
+				for (int i(0); i < linearQueries; ++i)
+				{
+					range.Run(grid, starts[i], LAND_UNIT, NavGrid::QuantiseBudget(LINEAR_MOVE_RANGE));
+					const std::vector<int>& reached = range.GetReachedCells();
+					moveGoals[i] = reached.empty() ? starts[i] : reached[moveRng() % reached.size()];
+				}
+			}
+
+			std::vector<float> moveCosts[2];
+			moveCosts[0].assign(linearQueries, -1.f);
+			moveCosts[1].assign(linearQueries, -1.f);
+			BenchmarkResult linear = RunBenchmark("linear", linearQueries,
+				[]() { return std::unique_ptr<LinearAStar>(new LinearAStar()); },
+				[&](std::unique_ptr<LinearAStar>& search, int i)
+				{
+					long long expanded = 0;
+					moveCosts[0][i] = search->Run(grid, starts[i], moveGoals[i], LAND_UNIT, expanded);
+					return expanded;
+				});
+			BenchmarkResult astarMove = RunBenchmark("astarmove", linearQueries, makeArena, [&](std::unique_ptr<PathSearchArena>& arena, int i)
+			{
+				PathQuery query;
+				query.startCell = starts[i];
+				query.goalCell = moveGoals[i];
+				query.unitType = LAND_UNIT;
+				PathResult result = RunPathQuery(query, grid, *arena);
+				moveCosts[1][i] = result.IsValid() ? result.cost : -1.f;
+				return static_cast<long long>(arena->GetExpansionCount());
+			});
+			PrintResult(options, map, linear);
+			PrintResult(options, map, astarMove);
+			if (!options.csv)
+				std::printf("%-16s astarmove is %.1fx as fast as linear\n", map.name.c_str(), linear.nsPerQuery / astarMove.nsPerQuery);
+
+			for (int i(0); i < linearQueries; ++i)
+			{
+				if (moveCosts[0][i] != moveCosts[1][i])
+				{
+					std::fprintf(stderr, "%s: linear found cost %.1f where astar found %.1f (query %d)\n", map.name.c_str(),
+						moveCosts[0][i], moveCosts[1][i], i);
+					break;
+				}
+			}
+		}
+
+		//
+		// Hierarchical (HPA*)
+		//
+
+		{
+			HierarchicalPathfinder hpa;
+			auto noState = []() { return 0; };
+			PrintResult(options, map, RunBenchmark("hpabuild", 1, noState, [&](int&, int)
+			{
+				hpa.Build(grid, LAND_UNIT + 1);
+				return static_cast<long long>(hpa.GetNodeCount(LAND_UNIT));
+			}));
+
+			auto hpaQuery = [&](int refineCells)
+			{
+				return [&, refineCells](std::unique_ptr<PathSearchArena>& arena, int i)
+				{
+					PathQuery query;
+					query.startCell = starts[i];
+					query.goalCell = goals[i];
+					query.unitType = LAND_UNIT;
+					query.connectivity = &connectivity;
+					PathResult result = hpa.FindAbstractPath(query, *arena);
+					if (result.IsValid() && refineCells != 0)
+						hpa.RefinePath(refineCells);
+					return static_cast<long long>(arena->GetExpansionCount());
+				};
+			};
+			PrintResult(options, map, RunBenchmark("hpaquery", pathQueries, makeArena, hpaQuery(0)));
+			PrintResult(options, map, RunBenchmark("hpanear", pathQueries, makeArena, hpaQuery(HPA_LOOKAHEAD)));
+			PrintResult(options, map, RunBenchmark("hpa", pathQueries, makeArena, hpaQuery(-1)));
+
+			//Refined paths must join start to goal a step at a time, costing what the abstract path did and never less than A*
+			PathSearchArena arena;
+			double ratioSum = 0.0, worstRatio = 1.0;
+			int ratioCount = 0;
+			for (int i(0); i < pathQueries; ++i)
+			{
+				PathQuery query;
+				query.startCell = starts[i];
+				query.goalCell = goals[i];
+				query.unitType = LAND_UNIT;
+				query.connectivity = &connectivity;
+				PathResult result = RunPathQuery(query, grid, arena);
+				float astarCost = result.IsValid() ? result.cost : -1.f;
+
+				PathResult abstract = hpa.FindAbstractPath(query, arena);
+				if (abstract.IsValid() != (astarCost >= 0.f))
+				{
+					std::fprintf(stderr, "%s: hpa %s a path where astar %s (query %d)\n", map.name.c_str(),
+						abstract.IsValid() ? "found" : "found no", astarCost >= 0.f ? "found one" : "found none", i);
+					break;
+				}
+				if (!abstract.IsValid())
+					continue;
+
+				float abstractCost = abstract.cost;
+				PathResult refined = hpa.RefinePath();
+				bool joined = refined.IsValid() && refined.cells[0] == starts[i] && refined.cells[refined.length - 1] == goals[i];
+				int refinedCost = 0;
+				for (int c(1); joined && c < refined.length; ++c)
+				{
+					int from = refined.cells[c - 1], to = refined.cells[c];
+					int steps = std::abs(grid.GetCellX(to) - grid.GetCellX(from)) + std::abs(grid.GetCellY(to) - grid.GetCellY(from));
+					joined = steps == 1 && grid.CanEnter(to, LAND_UNIT);
+					refinedCost += grid.GetMoveCost(to);
+				}
+				float cost = static_cast<float>(refinedCost) / NavGrid::MOVE_COST_SCALE;
+				if (!joined || std::fabs(cost - abstractCost) > 0.01f || cost < astarCost - 0.01f)
+				{
+					std::fprintf(stderr, "%s: hpa refined a path costing %.1f (abstract %.1f, astar %.1f)%s (query %d)\n", map.name.c_str(),
+						cost, abstractCost, astarCost, joined ? "" : " that doesn't join start to goal", i);
+					break;
+				}
+				if (astarCost > 0.f)
+				{
+					double ratio = cost / astarCost;
+					ratioSum += ratio;
+					worstRatio = std::max(worstRatio, ratio);
+					++ratioCount;
+				}
+			}
+			if (!options.csv && ratioCount > 0)
+				std::printf("%-16s hpa paths cost %.3fx astar on average (worst %.3fx) over %d paths\n", map.name.c_str(),
+					ratioSum / ratioCount, worstRatio, ratioCount);
+		}
+
+		//
+		// Incremental replanning
+		//
+
+		{
+			std::vector<int> replanGoals(goals.begin(), goals.begin() + std::min(REPLAN_GOAL_COUNT, options.queries));
+			PathGoalSet goalSet;
+			goalSet.Resize(grid.GetCellCount());
+			for (int goal : replanGoals)
+				goalSet.Add(goal);
+			int replanStart = starts[0];
+
+			//Each step frees the cell occupied REPLAN_BLOCKERS steps before, then occupies a cell of the current route
+			std::vector<int> freedCells(pathQueries, -1);
+			std::vector<int> occupiedCells(pathQueries, -1);
+			std::mt19937 replanRng(options.seed);
+			{
+				PathSearchArena arena;
+				for (int i(0); i < pathQueries; ++i)
+				{
+					if (i >= REPLAN_BLOCKERS && occupiedCells[i - REPLAN_BLOCKERS] >= 0)
+					{
+						freedCells[i] = occupiedCells[i - REPLAN_BLOCKERS];
+						grid.SetOccupied(freedCells[i], false);
+					}
+
+					PathQuery query;
+					query.startCell = replanStart;
+					query.goals = &goalSet;
+					query.unitType = LAND_UNIT;
+					PathResult result = RunPathQuery(query, grid, arena);
+					if (result.IsValid() && result.length > 2)
+					{
+						std::uniform_int_distribution<int> onRoute(1, result.length - 2);
+						occupiedCells[i] = result.cells[onRoute(replanRng)];
+						grid.SetOccupied(occupiedCells[i], true);
+					}
+				}
+			}
+			auto clearSteps = [&]()
+			{
+				for (int cell : occupiedCells)
+					if (cell >= 0)
+						grid.SetOccupied(cell, false);
+			};
+			//Setting a cell as it already is changes nothing, so the warm up step can be replayed
+			auto applyStep = [&](int i)
+			{
+				if (freedCells[i] >= 0)
+					grid.SetOccupied(freedCells[i], false);
+				if (occupiedCells[i] >= 0)
+					grid.SetOccupied(occupiedCells[i], true);
+			};
+			clearSteps();
+
+			std::vector<float> replanCosts[2];
+			replanCosts[0].assign(pathQueries, -1.f);
+			replanCosts[1].assign(pathQueries, -1.f);
+			PrintResult(options, map, RunBenchmark("replan", pathQueries, [&]()
+			{
+				//The first full search is made before timing, only repairs are timed
+				std::unique_ptr<IncrementalPathPlanner> planner(new IncrementalPathPlanner());
+				planner->Initialise(grid, LAND_UNIT, replanGoals);
+				planner->SetStart(replanStart);
+				planner->Replan();
+				return planner;
+			},
+			[&](std::unique_ptr<IncrementalPathPlanner>& planner, int i)
+			{
+				applyStep(i);
+				planner->Replan();
+				replanCosts[0][i] = planner->GetDistanceToGoal(replanStart);
+				return static_cast<long long>(planner->GetLastExpansionCount());
+			}));
+			clearSteps();
+
+			PrintResult(options, map, RunBenchmark("replanfull", pathQueries, makeArena, [&](std::unique_ptr<PathSearchArena>& arena, int i)
+			{
+				applyStep(i);
+				PathQuery query;
+				query.startCell = replanStart;
+				query.goals = &goalSet;
+				query.unitType = LAND_UNIT;
+				PathResult result = RunPathQuery(query, grid, *arena);
+				replanCosts[1][i] = result.IsValid() ? result.cost : -1.f;
+				return static_cast<long long>(arena->GetExpansionCount());
+			}));
+			clearSteps();
+
+			for (int i(0); i < pathQueries; ++i)
+			{
+				if (std::fabs(replanCosts[0][i] - replanCosts[1][i]) > 0.01f)
+				{
+					std::fprintf(stderr, "%s: replan repaired a route costing %.1f where a fresh search found %.1f (step %d)\n",
+						map.name.c_str(), replanCosts[0][i], replanCosts[1][i], i);
+					break;
+				}
+			}
+		}
+
+		if (!options.traceDir.empty())
+		{
+			const char* searchNames[3] = { "astar", "jps", "alt" };
+			for (int i(0); i < (useLandmarks ? 3 : 2); ++i)
+			{
+				std::string path = options.traceDir + "/" + map.name + "_" + searchNames[i];
+				if (!traces[i].WriteLog(path + ".ptrc") || !traces[i].WriteHeatmapPGM(path + ".pgm"))
+					std::fprintf(stderr, "Could not write trace %s\n", path.c_str());
+			}
+		}
+
+		//
+		// Cost layers
+		//
+
+		//Threat counts the sources in range of each cell, hazards and preferences are scattered
+		std::vector<uint8_t> threatLayer(grid.GetCellCount(), 0);
+		std::vector<float> hazardLayer(grid.GetCellCount(), 0.f);
+		std::vector<uint8_t> preferenceLayer(grid.GetCellCount(), 0);
+		int threatSources = std::max(1, static_cast<int>(cellCount / THREAT_CELLS_PER_SOURCE));
+		for (int i(0); i < threatSources; ++i)
+		{
+			int source = landCells[pick(rng)];
+			grid.ForEachCoordInRange(grid.GetCellX(source), grid.GetCellY(source), THREAT_RADIUS, [&](int x, int y)
+			{
+				uint8_t& t = threatLayer[grid.CoordsToCell(x, y)];
+				t = t < 255 ? t + 1 : t;
+			});
+		}
+		std::uniform_int_distribution<int> percent(0, 99);
+		std::uniform_real_distribution<float> hazard(0.5f, 3.f);
+		for (int cell : landCells)
+		{
+			if (percent(rng) < HAZARD_PERCENT)
+				hazardLayer[cell] = hazard(rng);
+			if (percent(rng) < PREFERENCE_PERCENT)
+				preferenceLayer[cell] = 1;
+		}
+
+		PathCostLayers threatOnly;
+		threatOnly.AddLayer(threatLayer.data(), 2.f);
+		PathCostLayers allLayers;
+		allLayers.AddLayer(threatLayer.data(), 2.f);
+		allLayers.AddLayer(hazardLayer.data());
+		allLayers.AddLayer(preferenceLayer.data(), 0.5f);
+		PathCostLayers precomputedLayers = allLayers;
+		precomputedLayers.Precompute(grid.GetCellCount());
+
+		//Summed and precomputed layers must find the same routes
+		std::vector<float> layerCosts[2];
+		std::vector<int> layerLengths[2];
+		auto layerQuery = [&](const PathCostLayers& layers, int check)
+		{
+			if (check >= 0)
+			{
+				layerCosts[check].assign(pathQueries, -1.f);
+				layerLengths[check].assign(pathQueries, 0);
+			}
+			return [&, check](std::unique_ptr<PathSearchArena>& arena, int i)
+			{
+				PathQuery query;
+				query.startCell = starts[i];
+				query.goalCell = goals[i];
+				query.unitType = LAND_UNIT;
+				query.connectivity = &connectivity;
+				query.costLayers = &layers;
+				PathResult result = RunPathQuery(query, grid, *arena);
+				if (check >= 0 && i < pathQueries)
+				{
+					layerCosts[check][i] = result.IsValid() ? result.cost : -1.f;
+					layerLengths[check][i] = result.length;
+				}
+				return static_cast<long long>(arena->GetExpansionCount());
+			};
+		};
+
+		PrintResult(options, map, RunBenchmark("layer1", pathQueries, makeArena, layerQuery(threatOnly, -1)));
+		PrintResult(options, map, RunBenchmark("layer3", pathQueries, makeArena, layerQuery(allLayers, 0)));
+		PrintResult(options, map, RunBenchmark("layer3p", pathQueries, makeArena, layerQuery(precomputedLayers, 1)));
+
+		for (int i(0); i < pathQueries; ++i)
+		{
+			if (layerCosts[0][i] != layerCosts[1][i] || layerLengths[0][i] != layerLengths[1][i])
+			{
+				std::fprintf(stderr, "%s: layer3 found cost %.1f (%d cells) where layer3p found %.1f (%d cells) (query %d)\n",
+					map.name.c_str(), layerCosts[0][i], layerLengths[0][i], layerCosts[1][i], layerLengths[1][i], i);
+				break;
+			}
+		}
+
+		//The tightest budget each goal can be reached in, from A* without layers (0 for unreachable goals)
+		std::vector<int> moveBudgets(pathQueries, 0);
+		{
+			PathSearchArena arena;
+			for (int i(0); i < pathQueries; ++i)
+			{
+				PathQuery query;
+				query.startCell = starts[i];
+				query.goalCell = goals[i];
+				query.unitType = LAND_UNIT;
+				query.connectivity = &connectivity;
+				PathResult result = RunPathQuery(query, grid, arena);
+				moveBudgets[i] = result.IsValid() ? static_cast<int>(std::lround(result.cost * NavGrid::MOVE_COST_SCALE)) : 0;
+			}
+		}
+
+		//Layers must never make a goal in budget unreachable, or a path overspend
+		std::vector<int> budgetedMisses(pathQueries, 0);
+		PrintResult(options, map, RunBenchmark("layer3b", pathQueries, makeArena, [&](std::unique_ptr<PathSearchArena>& arena, int i)
+		{
+			PathQuery query;
+			query.startCell = starts[i];
+			query.goalCell = goals[i];
+			query.unitType = LAND_UNIT;
+			query.connectivity = &connectivity;
+			query.costLayers = &precomputedLayers;
+			query.maxCost = moveBudgets[i];
+			PathResult result = RunPathQuery(query, grid, *arena);
+			bool reached = result.IsValid() && std::lround(result.cost * NavGrid::MOVE_COST_SCALE) <= moveBudgets[i];
+			budgetedMisses[i] = moveBudgets[i] > 0 && !reached ? 1 : 0;
+			return static_cast<long long>(arena->GetExpansionCount());
+		}));
+
+		int missCount = 0;
+		for (int miss : budgetedMisses)
+			missCount += miss;
+		if (missCount > 0)
+			std::fprintf(stderr, "%s: layer3b missed %d of %d goals astar reaches within the same budget\n",
+				map.name.c_str(), missCount, pathQueries);
+
+		//
+		// Nearest goal
+		//
+
+		for (int goalCount : GOAL_COUNTS)
+		{
+			//Goals for query i are goalCells[i * goalCount] onwards
+			std::vector<int> goalCells(static_cast<size_t>(pathQueries + 1) * goalCount);
+			for (auto& g : goalCells)
+				g = landCells[pick(rng)];
+			std::vector<float> setCosts(pathQueries + 1, -1.f);
+			std::vector<float> separateCosts(pathQueries + 1, -1.f);
+
+			std::string setName = "goals" + std::to_string(goalCount);
+			PrintResult(options, map, RunBenchmark(setName.c_str(), pathQueries,
+				[&]()
+				{
+					std::unique_ptr<std::pair<PathSearchArena, PathGoalSet>> state(new std::pair<PathSearchArena, PathGoalSet>());
+					state->second.Resize(grid.GetCellCount());
+					return state;
+				},
+				[&](std::unique_ptr<std::pair<PathSearchArena, PathGoalSet>>& state, int i)
+				{
+					PathGoalSet& goals = state->second;
+					goals.Clear();
+					for (int k(0); k < goalCount; ++k)
+						goals.Add(goalCells[i * goalCount + k]);
+
+					PathQuery query;
+					query.startCell = starts[i];
+					query.goals = &goals;
+					query.unitType = LAND_UNIT;
+					query.connectivity = &connectivity;
+					PathResult result = RunPathQuery(query, grid, state->first);
+					setCosts[i] = result.IsValid() ? result.cost : -1.f;
+					return static_cast<long long>(state->first.GetExpansionCount());
+				}));
+
+			std::string separateName = "astar" + std::to_string(goalCount);
+			PrintResult(options, map, RunBenchmark(separateName.c_str(), pathQueries, makeArena,
+				[&](std::unique_ptr<PathSearchArena>& arena, int i)
+				{
+					long long expanded = 0;
+					float best = -1.f;
+					for (int k(0); k < goalCount; ++k)
+					{
+						PathQuery query;
+						query.startCell = starts[i];
+						query.goalCell = goalCells[i * goalCount + k];
+						query.unitType = LAND_UNIT;
+						query.connectivity = &connectivity;
+						PathResult result = RunPathQuery(query, grid, *arena);
+						if (result.IsValid() && (best < 0.f || result.cost < best))
+							best = result.cost;
+						expanded += arena->GetExpansionCount();
+					}
+					separateCosts[i] = best;
+					return expanded;
+				}));
+
+			//Both must agree on the cheapest goal cost
+			for (int i(0); i < pathQueries; ++i)
+			{
+				if (setCosts[i] != separateCosts[i])
+				{
+					std::fprintf(stderr, "%s: %s found cost %.1f where %s found %.1f (query %d)\n", map.name.c_str(),
+						setName.c_str(), setCosts[i], separateName.c_str(), separateCosts[i], i);
+					break;
+				}
+			}
+		}
+
+		//
+		// Targeting
+		//
+
+		auto makeOverlays = [&]()
+		{
+			std::unique_ptr<TileOverlayLayers> overlays(new TileOverlayLayers());
+			overlays->Resize(grid.GetCellCount());
+			return overlays;
+		};
+
+		PrintResult(options, map, RunBenchmark("target", options.queries, makeOverlays,
+			[&](std::unique_ptr<TileOverlayLayers>& overlays, int i)
+			{
+				//Stamp the shape then clear it again, as the targeting system does between uses
+				long long stamped = 0;
+				grid.ForEachSpanInShape(grid.GetCellX(starts[i]), grid.GetCellY(starts[i]), RANGE_SHAPE::DIAMOND, SHAPE_FACING::ALL,
+					TARGET_RANGE, [&](int firstCell, int lastCell)
+				{
+					overlays->SetSpan(TILE_OVERLAY::ATTACK, firstCell, lastCell);
+					stamped += lastCell - firstCell + 1;
+				});
+				overlays->Clear(TILE_OVERLAY::ATTACK);
+				return stamped;
+			}));
+
+		//Every shape in turn, facing each way in turn
+		auto queryShape = [](int i) { return static_cast<RANGE_SHAPE>(i % static_cast<int>(RANGE_SHAPE::COUNT)); };
+		auto queryFacing = [](int i) { return static_cast<SHAPE_FACING>((i / static_cast<int>(RANGE_SHAPE::COUNT)) % static_cast<int>(SHAPE_FACING::COUNT)); };
+
+		std::vector<int> spanCounts(options.queries, 0);
+		std::vector<int> cellCounts(options.queries, 0);
+		PrintResult(options, map, RunBenchmark("shapes", options.queries, makeOverlays,
+			[&](std::unique_ptr<TileOverlayLayers>& overlays, int i)
+			{
+				long long spans = 0;
+				grid.ForEachSpanInShape(grid.GetCellX(starts[i]), grid.GetCellY(starts[i]), queryShape(i), queryFacing(i),
+					SHAPE_RADIUS, [&](int firstCell, int lastCell)
+				{
+					overlays->SetSpan(TILE_OVERLAY::AOE, firstCell, lastCell);
+					++spans;
+				});
+				spanCounts[i] = overlays->GetCount(TILE_OVERLAY::AOE);
+				overlays->Clear(TILE_OVERLAY::AOE);
+				return spans;
+			}));
+		PrintResult(options, map, RunBenchmark("shapecell", options.queries, makeOverlays,
+			[&](std::unique_ptr<TileOverlayLayers>& overlays, int i)
+			{
+				long long tested = 0;
+				int x = grid.GetCellX(starts[i]);
+				int y = grid.GetCellY(starts[i]);
+				for (int dy(-SHAPE_RADIUS); dy <= SHAPE_RADIUS; ++dy)
+				{
+					for (int dx(-SHAPE_RADIUS); dx <= SHAPE_RADIUS; ++dx)
+					{
+						++tested;
+						if (grid.IsInBounds(x + dx, y + dy) && NavGrid::Shapes::Contains(queryShape(i), queryFacing(i), SHAPE_RADIUS, dx, dy))
+							overlays->Set(TILE_OVERLAY::AOE, grid.CoordsToCell(x + dx, y + dy));
+					}
+				}
+				cellCounts[i] = overlays->GetCount(TILE_OVERLAY::AOE);
+				overlays->Clear(TILE_OVERLAY::AOE);
+				return tested;
+			}));
+
+		//Both must stamp the same tiles
+		for (int i(0); i < options.queries; ++i)
+		{
+			if (spanCounts[i] != cellCounts[i])
+			{
+				std::fprintf(stderr, "%s: shapes stamped %d tiles where shapecell stamped %d (shape %d, facing %d)\n",
+					map.name.c_str(), spanCounts[i], cellCounts[i], static_cast<int>(queryShape(i)), static_cast<int>(queryFacing(i)));
+				break;
+			}
+		}
+
+		//
+		// Line of sight
+		//
+
+		if (cellCount <= VISIBILITY_CELL_LIMIT)
+		{
+			VisibilityCache visibility;
+			auto noState = []() { return 0; };
+			PrintResult(options, map, RunBenchmark("losbuild1", 1, noState, [&](int&, int)
+			{
+				visibility.Build(grid, LOS_RANGE, 1);
+				return 0ll;
+			}));
+			PrintResult(options, map, RunBenchmark("losbuild", 1, noState, [&](int&, int)
+			{
+				visibility.Build(grid, LOS_RANGE);
+				return 0ll;
+			}));
+
+			std::vector<long long> cachedCounts(options.queries, 0);
+			std::vector<long long> walkedCounts(options.queries, 0);
+			PrintResult(options, map, RunBenchmark("los", options.queries, noState, [&](int&, int i)
+			{
+				long long visible = 0;
+				visibility.ForEachVisibleInRange(starts[i], LOS_RANGE, [&](int) { ++visible; });
+				cachedCounts[i] = visible;
+				return visible;
+			}));
+			PrintResult(options, map, RunBenchmark("loswalk", options.queries, noState, [&](int&, int i)
+			{
+				long long visible = 0;
+				grid.ForEachCoordInRange(grid.GetCellX(starts[i]), grid.GetCellY(starts[i]), LOS_RANGE, [&](int x, int y)
+				{
+					visible += visibility.HasLineOfSight(starts[i], grid.CoordsToCell(x, y)) ? 1 : 0;
+				});
+				walkedCounts[i] = visible;
+				return visible;
+			}));
+
+			//Both must see the same tiles
+			for (int i(0); i < options.queries; ++i)
+			{
+				if (cachedCounts[i] != walkedCounts[i])
+				{
+					std::fprintf(stderr, "%s: los saw %lld tiles where loswalk saw %lld (query %d)\n", map.name.c_str(),
+						cachedCounts[i], walkedCounts[i], i);
+					break;
+				}
+			}
+
+			//Walls raised after the build must be picked up by the windows around them
+			for (int i(0); i < std::min(options.queries, 16); ++i)
+			{
+				int x = grid.GetCellX(starts[i]) + 2;
+				int y = grid.GetCellY(starts[i]) + 1;
+				if (!grid.IsInBounds(x, y) || (grid.GetFlags(grid.CoordsToCell(x, y)) & NavGrid::IMPASSABLE))
+					continue;
+
+				int wall = grid.CoordsToCell(x, y);
+				grid.SetImpassable(wall, true);
+				long long cached = 0;
+				long long walked = 0;
+				visibility.ForEachVisibleInRange(starts[i], LOS_RANGE, [&](int) { ++cached; });
+				grid.ForEachCoordInRange(grid.GetCellX(starts[i]), grid.GetCellY(starts[i]), LOS_RANGE, [&](int cx, int cy)
+				{
+					walked += visibility.HasLineOfSight(starts[i], grid.CoordsToCell(cx, cy)) ? 1 : 0;
+				});
+				grid.SetImpassable(wall, false);
+
+				if (cached != walked)
+				{
+					std::fprintf(stderr, "%s: los saw %lld tiles past a new wall where loswalk saw %lld (query %d)\n",
+						map.name.c_str(), cached, walked, i);
+					break;
+				}
+			}
+		}
+		else
+			std::fprintf(stderr, "%s: over %lld cells, los skipped\n", map.name.c_str(), VISIBILITY_CELL_LIMIT);
+
+		//
+		// Attack options
+		//
+
+		//Standing cells per query, so only the attack search itself is timed
+		std::vector<std::vector<int>> standingCells(options.queries);
+		{
+			MovementRangeSearch rangeSearch;
+			for (int i(0); i < options.queries; ++i)
+			{
+				rangeSearch.Run(grid, starts[i], LAND_UNIT, budget);
+				standingCells[i] = rangeSearch.GetReachedCells();
+			}
+		}
+
+		//Movement range against the attack range around the start, as a preview of where the unit can stand and hit
+		std::vector<int> overlapCounts(options.queries, 0);
+		PrintResult(options, map, RunBenchmark("overlay", options.queries, makeOverlays,
+			[&](std::unique_ptr<TileOverlayLayers>& overlays, int i)
+			{
+				for (int cell : standingCells[i])
+					overlays->Set(TILE_OVERLAY::MOVEMENT, cell);
+				grid.ForEachCoordInRange(grid.GetCellX(starts[i]), grid.GetCellY(starts[i]), TARGET_RANGE,
+					[&](int cx, int cy) { overlays->Set(TILE_OVERLAY::ATTACK, grid.CoordsToCell(cx, cy)); });
+
+				overlays->Intersect(TILE_OVERLAY::AOE, TILE_OVERLAY::MOVEMENT, TILE_OVERLAY::ATTACK);
+				overlapCounts[i] = overlays->GetCount(TILE_OVERLAY::AOE);
+				overlays->Union(TILE_OVERLAY::AOE, TILE_OVERLAY::MOVEMENT, TILE_OVERLAY::ATTACK);
+				long long combined = overlays->GetCount(TILE_OVERLAY::AOE);
+				overlays->ClearAll();
+				return combined;
+			}));
+
+		//The intersection must hold exactly the standing cells within range of the start
+		for (int i(0); i < options.queries; ++i)
+		{
+			int expected = 0;
+			for (int cell : standingCells[i])
+				expected += NavGrid::Topology::Distance(grid.GetCellX(cell) - grid.GetCellX(starts[i]),
+					grid.GetCellY(cell) - grid.GetCellY(starts[i]), 1) <= TARGET_RANGE ? 1 : 0;
+			if (overlapCounts[i] != expected)
+			{
+				std::fprintf(stderr, "%s: overlay intersection held %d cells where %d were expected (query %d)\n",
+					map.name.c_str(), overlapCounts[i], expected, i);
+				break;
+			}
+		}
+
+		for (int targetCount : TARGET_COUNTS)
+		{
+			//Targets for query i are targetCells[i] (anywhere on the map near the attacker)
+			std::vector<std::vector<int>> targetCells(options.queries);
+			std::uniform_int_distribution<int> spread(-TARGET_SPREAD, TARGET_SPREAD);
+			for (int i(0); i < options.queries; ++i)
+			{
+				int x = grid.GetCellX(starts[i]);
+				int y = grid.GetCellY(starts[i]);
+				for (int k(0); k < targetCount; ++k)
+				{
+					int tx = std::min(std::max(x + spread(rng), 0), map.width - 1);
+					int ty = std::min(std::max(y + spread(rng), 0), map.height - 1);
+					targetCells[i].push_back(grid.CoordsToCell(tx, ty));
+				}
+			}
+			std::vector<size_t> attackCounts(options.queries, 0);
+			std::vector<size_t> naiveCounts(options.queries, 0);
+
+			std::string attackName = "attack" + std::to_string(targetCount);
+			PrintResult(options, map, RunBenchmark(attackName.c_str(), options.queries,
+				[]() { return std::unique_ptr<AttackRangeSearch>(new AttackRangeSearch()); },
+				[&](std::unique_ptr<AttackRangeSearch>& search, int i)
+				{
+					search->Run(grid, standingCells[i], targetCells[i], SKILL_RANGES);
+					attackCounts[i] = search->GetOptions().size();
+					return static_cast<long long>(attackCounts[i]);
+				}));
+
+			std::string naiveName = "naive" + std::to_string(targetCount);
+			PrintResult(options, map, RunBenchmark(naiveName.c_str(), options.queries,
+				[&]()
+				{
+					std::unique_ptr<TileBitset> cellSet(new TileBitset());
+					cellSet->Resize(grid.GetCellCount());
+					return cellSet;
+				},
+				[&](std::unique_ptr<TileBitset>& cellSet, int i)
+				{
+					//Lay out each skills targeting grid around every standing cell and test every target against it
+					size_t found = 0;
+					for (int standing : standingCells[i])
+					{
+						int x = grid.GetCellX(standing);
+						int y = grid.GetCellY(standing);
+						for (int range : SKILL_RANGES)
+						{
+							grid.ForEachCoordInRange(x, y, range, [&](int cx, int cy) { cellSet->Set(grid.CoordsToCell(cx, cy)); });
+							for (int target : targetCells[i])
+								found += cellSet->Test(target) ? 1 : 0;
+							grid.ForEachCoordInRange(x, y, range, [&](int cx, int cy) { cellSet->Reset(grid.CoordsToCell(cx, cy)); });
+						}
+					}
+					naiveCounts[i] = found;
+					return static_cast<long long>(found);
+				}));
+
+			//Both must find the same options
+			for (int i(0); i < options.queries; ++i)
+			{
+				if (attackCounts[i] != naiveCounts[i])
+				{
+					std::fprintf(stderr, "%s: %s found %zu options where %s found %zu (query %d)\n", map.name.c_str(),
+						attackName.c_str(), attackCounts[i], naiveName.c_str(), naiveCounts[i], i);
+					break;
+				}
+			}
+
+			//AoE placement, every target counting once
+			std::vector<std::vector<AoETarget>> aoeTargets(options.queries);
+			for (int i(0); i < options.queries; ++i)
+				for (int target : targetCells[i])
+					aoeTargets[i].push_back({ target, 1.f });
+			std::vector<std::vector<AoEPlacement>> foundPlacements(options.queries);
+			std::vector<std::vector<AoEPlacement>> stampedPlacements(options.queries);
+			for (int i(0); i < options.queries; ++i)
+			{
+				foundPlacements[i].reserve(AOE_PLACEMENTS);
+				stampedPlacements[i].reserve((AOE_RANGE * 2 + 1) * (AOE_RANGE * 2 + 1));
+			}
+
+			std::string aoeName = "aoe" + std::to_string(targetCount);
+			PrintResult(options, map, RunBenchmark(aoeName.c_str(), options.queries,
+				[]() { return std::unique_ptr<AoEPlacementSearch>(new AoEPlacementSearch()); },
+				[&](std::unique_ptr<AoEPlacementSearch>& search, int i)
+				{
+					AoEPlacementQuery query;
+					query.casterCell = starts[i];
+					query.range = AOE_RANGE;
+					query.areaShape = queryShape(i);
+					query.radius = AOE_RADIUS;
+					query.targets = &aoeTargets[i];
+					query.count = AOE_PLACEMENTS;
+					search->Run(grid, query);
+					foundPlacements[i].assign(search->GetPlacements().begin(), search->GetPlacements().end());
+					return static_cast<long long>(foundPlacements[i].size());
+				}));
+
+			std::string aoeNaiveName = "aoenaive" + std::to_string(targetCount);
+			PrintResult(options, map, RunBenchmark(aoeNaiveName.c_str(), options.queries, makeOverlays,
+				[&](std::unique_ptr<TileOverlayLayers>& overlays, int i)
+				{
+					//GenerateAoEGrid then IsUnitInAoEGrid per target, at every centre in range
+					std::vector<AoEPlacement>& placements = stampedPlacements[i];
+					placements.clear();
+					int x = grid.GetCellX(starts[i]);
+					int y = grid.GetCellY(starts[i]);
+					grid.ForEachSpanInShape(x, y, RANGE_SHAPE::DIAMOND, SHAPE_FACING::ALL, AOE_RANGE, [&](int firstCell, int lastCell)
+					{
+						for (int centre(firstCell); centre <= lastCell; ++centre)
+						{
+							int cx = grid.GetCellX(centre);
+							int cy = grid.GetCellY(centre);
+							grid.ForEachSpanInShape(cx, cy, queryShape(i), FacingTowards(cx - x, cy - y), AOE_RADIUS,
+								[&](int first, int last) { overlays->SetSpan(TILE_OVERLAY::AOE, first, last); });
+							double score = 0.0;
+							for (int target : targetCells[i])
+								score += overlays->Test(TILE_OVERLAY::AOE, target) ? 1.0 : 0.0;
+							overlays->Clear(TILE_OVERLAY::AOE);
+							placements.push_back({ centre, score });
+						}
+					});
+					std::sort(placements.begin(), placements.end(), [](const AoEPlacement& a, const AoEPlacement& b)
+					{
+						return a.score > b.score || (a.score == b.score && a.cell < b.cell);
+					});
+					placements.resize(std::min(static_cast<int>(placements.size()), AOE_PLACEMENTS));
+					return static_cast<long long>(placements.size());
+				}));
+
+			//Both must pick the same centres
+			for (int i(0); i < options.queries; ++i)
+			{
+				bool same = foundPlacements[i].size() == stampedPlacements[i].size();
+				for (size_t k(0); same && k < foundPlacements[i].size(); ++k)
+					same = foundPlacements[i][k].cell == stampedPlacements[i][k].cell && foundPlacements[i][k].score == stampedPlacements[i][k].score;
+				if (!same)
+				{
+					std::fprintf(stderr, "%s: %s placements differ from %s (query %d, shape %d)\n", map.name.c_str(),
+						aoeName.c_str(), aoeNaiveName.c_str(), i, static_cast<int>(queryShape(i)));
+					break;
+				}
+			}
+		}
+
+		//
+		// Unit occupancy
+		//
+
+		for (int teamUnitCount : TEAM_UNIT_COUNTS)
+		{
+			//Two teams on distinct land cells, as many as fit (own generator, so the later sections see the same cells)
+			struct BenchmarkUnit
+			{
+				int x, y, team;
+				bool alive;
+			};
+			std::vector<int> unitCells(landCells);
+			std::mt19937 unitRng(options.seed);
+			std::shuffle(unitCells.begin(), unitCells.end(), unitRng);
+			int unitCount = std::min(teamUnitCount * 2, static_cast<int>(unitCells.size()));
+			std::vector<BenchmarkUnit> units(unitCount);
+			UnitOccupancyMap occupancy;
+			occupancy.Resize(grid);
+			for (int u(0); u < unitCount; ++u)
+			{
+				units[u] = { grid.GetCellX(unitCells[u]), grid.GetCellY(unitCells[u]), 1 + u % 2, u % DEAD_UNIT_STEP != 0 };
+				occupancy.Place(u, unitCells[u], units[u].team);
+				occupancy.SetAlive(u, units[u].alive);
+			}
+			const int ENEMY_TEAM = 2;
+
+			std::vector<long long> occupyFound(options.queries, 0);
+			std::vector<long long> scanFound(options.queries, 0);
+
+			std::string occupyName = "occupy" + std::to_string(teamUnitCount);
+			PrintResult(options, map, RunBenchmark(occupyName.c_str(), options.queries,
+				[]() { return 0; },
+				[&](int&, int i)
+				{
+					//Unit under the cursor, then the enemies under an AoE around the start
+					long long found = occupancy.GetUnitAt(grid.GetCellX(goals[i]), grid.GetCellY(goals[i])) != UnitOccupancyMap::NO_UNIT ? 1 : 0;
+					occupancy.ForEachUnitInShape(grid.GetCellX(starts[i]), grid.GetCellY(starts[i]), RANGE_SHAPE::DIAMOND,
+						SHAPE_FACING::ALL, AOE_RADIUS, ENEMY_TEAM, [&](int) { found += 2; });
+					occupyFound[i] = found;
+					return found;
+				}));
+
+			std::string scanName = "scan" + std::to_string(teamUnitCount);
+			PrintResult(options, map, RunBenchmark(scanName.c_str(), options.queries, makeOverlays,
+				[&](std::unique_ptr<TileOverlayLayers>& overlays, int i)
+				{
+					//The cursor stops at the first unit on its tile
+					long long found = 0;
+					int cursorX = grid.GetCellX(goals[i]);
+					int cursorY = grid.GetCellY(goals[i]);
+					for (auto& u : units)
+					{
+						if (u.x == cursorX && u.y == cursorY)
+						{
+							found = 1;
+							break;
+						}
+					}
+
+					//GenerateAoEGrid then IsUnitInAoEGrid per living enemy
+					grid.ForEachSpanInShape(grid.GetCellX(starts[i]), grid.GetCellY(starts[i]), RANGE_SHAPE::DIAMOND, SHAPE_FACING::ALL,
+						AOE_RADIUS, [&](int first, int last) { overlays->SetSpan(TILE_OVERLAY::AOE, first, last); });
+					for (auto& u : units)
+					{
+						if (u.team == ENEMY_TEAM && u.alive && overlays->Test(TILE_OVERLAY::AOE, grid.CoordsToCell(u.x, u.y)))
+							found += 2;
+					}
+					overlays->Clear(TILE_OVERLAY::AOE);
+					scanFound[i] = found;
+					return found;
+				}));
+
+			//Both must find the same units
+			for (int i(0); i < options.queries; ++i)
+			{
+				if (occupyFound[i] != scanFound[i])
+				{
+					std::fprintf(stderr, "%s: %s found %lld where %s found %lld (query %d)\n", map.name.c_str(),
+						occupyName.c_str(), occupyFound[i], scanName.c_str(), scanFound[i], i);
+					break;
+				}
+			}
+		}
+
+		//
+		// Combat
+		//
+
+		{
+			//Stats in the ranges the class and equipment data give, skills of every type
+			std::mt19937 combatRng(options.seed);
+			std::uniform_real_distribution<float> stat(0.f, 1.f);
+			std::vector<ClassTotals> combatUnits(COMBAT_UNIT_COUNT);
+			for (auto& u : combatUnits)
+			{
+				u.MaxHP = 80.f + stat(combatRng) * 80.f;
+				u.CurrentHP = u.MaxHP * (0.25f + stat(combatRng) * 0.75f);
+				u.TotalPhysAttack = 10.f + stat(combatRng) * 20.f;
+				u.TotalMagAttack = 10.f + stat(combatRng) * 20.f;
+				u.TotalPhysHit = 70.f + stat(combatRng) * 30.f;
+				u.TotalMagHit = 70.f + stat(combatRng) * 30.f;
+				u.TotalCritHit = stat(combatRng) * 20.f;
+				u.TotalCritMultiplier = 1.5f;
+				u.TotalPhysArmour = stat(combatRng) * 10.f;
+				u.TotalMagArmour = stat(combatRng) * 10.f;
+				u.TotalEvasion = stat(combatRng) * 20.f;
+				u.TotalMagResist = stat(combatRng) * 20.f;
+			}
+			std::vector<CombatSkill> combatSkills(4);
+			combatSkills[0].damageType = CombatResolver::PHYSICAL;
+			combatSkills[0].damageScaling = 1.2f;
+			combatSkills[0].innateCrit = 5.f;
+			combatSkills[1].damageType = CombatResolver::MAGICAL;
+			combatSkills[1].damageScaling = 1.5f;
+			combatSkills[2].skillType = CombatResolver::HEAL;
+			combatSkills[2].healPercent = 0.25f;
+			combatSkills[3].skillType = CombatResolver::BUFF;
+
+			std::uniform_int_distribution<int> pickUnit(0, COMBAT_UNIT_COUNT - 1);
+			std::vector<int> uses(static_cast<size_t>(COMBAT_BATCH) * 3);
+			for (size_t k(0); k < uses.size(); k += 3)
+			{
+				uses[k] = pickUnit(combatRng);
+				uses[k + 1] = pickUnit(combatRng);
+				uses[k + 2] = pickUnit(combatRng) % static_cast<int>(combatSkills.size());
+			}
+
+			//Sum of the outcomes of each query, for the replay check
+			std::vector<std::vector<float>> combatTotals(2, std::vector<float>(options.queries, 0.f));
+			for (int run(0); run < 2; ++run)
+			{
+				PrintResult(options, map, RunBenchmark(run == 0 ? "combat" : "combatreplay", options.queries,
+					[]() { return 0; },
+					[&](int&, int i)
+					{
+						RandomStream random(options.seed, 0, static_cast<uint32_t>(i));
+						float total = 0.f;
+						long long hits = 0;
+						for (size_t k(0); k < uses.size(); k += 3)
+						{
+							CombatOutcome outcome = CombatResolver::Resolve(combatUnits[uses[k]], combatUnits[uses[k + 1]],
+								combatSkills[uses[k + 2]], random);
+							total += outcome.damage + outcome.heal + (outcome.crit ? 1.f : 0.f);
+							hits += outcome.hit ? 1 : 0;
+						}
+						combatTotals[run][i] = total;
+						return hits;
+					}));
+			}
+
+			for (int i(0); i < options.queries; ++i)
+			{
+				if (combatTotals[0][i] != combatTotals[1][i])
+				{
+					std::fprintf(stderr, "%s: combat outcomes differ between runs from the same seed (query %d)\n", map.name.c_str(), i);
+					break;
+				}
+			}
+
+			//Each fill is the stream of its own action, so the words differ between fills but not between methods
+			int fillCount = std::max(1, options.queries * RANDOM_FILLS_PER_64_QUERIES / 64);
+			std::vector<uint32_t> words(RANDOM_FILL_WORDS);
+			auto noState = []() { return 0; };
+			PrintResult(options, map, RunBenchmark("rngroll", fillCount, noState, [&](int&, int i)
+			{
+				RandomStream random(options.seed, 1, static_cast<uint32_t>(i));
+				for (auto& w : words)
+					w = random.NextU32();
+				return static_cast<long long>(words.size());
+			}));
+			PrintResult(options, map, RunBenchmark("rngfill", fillCount, noState, [&](int&, int i)
+			{
+				RandomStream random(options.seed, 1, static_cast<uint32_t>(i));
+				random.Fill(words.data(), words.size());
+				return static_cast<long long>(words.size());
+			}));
+			PrintResult(options, map, RunBenchmark("rngfillmt", fillCount, noState, [&](int&, int i)
+			{
+				RandomStream random(options.seed, 1, static_cast<uint32_t>(i));
+				random.FillParallel(words.data(), words.size(), 0);
+				return static_cast<long long>(words.size());
+			}));
+
+			//Fills from a few positions (not all on a block boundary) by every method and thread count must agree
+			std::vector<uint32_t> filled(RANDOM_FILL_WORDS);
+			for (int start(0); start < RandomStream::BLOCK_WORDS + 1; ++start)
+			{
+				RandomStream rolled(options.seed, 1, 0);
+				rolled.Seek(start);
+				for (auto& w : words)
+					w = rolled.NextU32();
+
+				for (int threads(0); threads <= 3; ++threads)
+				{
+					RandomStream random(options.seed, 1, 0);
+					random.Seek(start);
+					if (threads == 0)
+						random.Fill(filled.data(), filled.size());
+					else
+						random.FillParallel(filled.data(), filled.size(), threads);
+					RandomStream next = rolled;
+					if (filled != words || random.GetPosition() != rolled.GetPosition() || random.NextU32() != next.NextU32())
+					{
+						std::fprintf(stderr, "%s: random fill from word %d on %d threads differs from drawing the words one at a time\n",
+							map.name.c_str(), start, threads);
+					}
+				}
+			}
+
+			//The users and damage skills (the first two) of each units turn, drawn from the skill uses
+			auto turnUse = [&](int i, int target, int use, int& user, int& skill)
+			{
+				size_t k = (static_cast<size_t>(i * COMBAT_UNIT_COUNT + target) * TURN_USES + use) % COMBAT_BATCH * 3;
+				user = uses[k];
+				skill = uses[k + 2] % 2;
+			};
+
+			std::vector<float> forecastTotals(options.queries, 0.f);
+			PrintResult(options, map, RunBenchmark("forecast", options.queries, noState, [&](int&, int i)
+			{
+				float total = 0.f;
+				for (const auto& user : combatUnits)
+				{
+					for (const auto& target : combatUnits)
+					{
+						for (const auto& skill : combatSkills)
+						{
+							SkillForecast forecast = CombatForecast::Forecast(user, target, skill);
+							total += forecast.expectedHPLost + forecast.killChance + forecast.heal;
+						}
+					}
+				}
+				forecastTotals[i] = total;
+				return static_cast<long long>(combatUnits.size() * combatUnits.size() * combatSkills.size());
+			}));
+
+			std::string turnName = "turn" + std::to_string(TURN_USES);
+			DamageSequence sequence;
+			PrintResult(options, map, RunBenchmark(turnName.c_str(), options.queries, noState, [&](int&, int i)
+			{
+				long long outcomes = 0;
+				for (int t(0); t < COMBAT_UNIT_COUNT; ++t)
+				{
+					sequence.Begin(combatUnits[t].CurrentHP);
+					for (int u(0); u < TURN_USES; ++u)
+					{
+						int user, skill;
+						turnUse(i, t, u, user, skill);
+						sequence.AddUse(CombatForecast::Forecast(combatUnits[user], combatUnits[t], combatSkills[skill]));
+					}
+					outcomes += sequence.GetOutcomeCount();
+				}
+				return outcomes;
+			}));
+
+			//Resolving each checked turn many times must give the forecast kill chance and damage (within 5 sigma)
+			for (int t(0); t < FORECAST_CHECKS; ++t)
+			{
+				sequence.Begin(combatUnits[t].CurrentHP);
+				for (int u(0); u < TURN_USES; ++u)
+				{
+					int user, skill;
+					turnUse(0, t, u, user, skill);
+					sequence.AddUse(CombatForecast::Forecast(combatUnits[user], combatUnits[t], combatSkills[skill]));
+				}
+				double survived = 0.0;
+				for (int o(0); o < sequence.GetOutcomeCount(); ++o)
+					survived += sequence.GetOutcome(o).chance;
+
+				int kills = 0;
+				double damageSum = 0.0, damageSquares = 0.0;
+				for (int trial(0); trial < FORECAST_TRIALS; ++trial)
+				{
+					RandomStream random(options.seed, static_cast<uint32_t>(t), static_cast<uint32_t>(trial));
+					float hp = combatUnits[t].CurrentHP;
+					double damage = 0.0;
+					for (int u(0); u < TURN_USES; ++u)
+					{
+						int user, skill;
+						turnUse(0, t, u, user, skill);
+						CombatOutcome outcome = CombatResolver::Resolve(combatUnits[user], combatUnits[t], combatSkills[skill], random);
+						hp -= outcome.damage;
+						damage += outcome.damage;
+					}
+					kills += hp <= 0 ? 1 : 0;
+					damageSum += damage;
+					damageSquares += damage * damage;
+				}
+
+				double trials = static_cast<double>(FORECAST_TRIALS);
+				double killRate = kills / trials;
+				double killChance = sequence.GetKillChance();
+				double meanDamage = damageSum / trials;
+				double damageDeviation = std::sqrt(std::max(damageSquares / trials - meanDamage * meanDamage, 0.0) / trials);
+				if (std::fabs(killChance + survived - 1.0) > 1e-6 ||
+					std::fabs(killRate - killChance) > 5.0 * std::sqrt(killChance * (1.0 - killChance) / trials) + 1e-3 ||
+					std::fabs(meanDamage - sequence.GetExpectedDamage()) > 5.0 * damageDeviation + 1e-3)
+				{
+					std::fprintf(stderr, "%s: forecast turn of unit %d (kill %.4f, damage %.2f) differs from resolving it (kill %.4f, damage %.2f)\n",
+						map.name.c_str(), t, killChance, sequence.GetExpectedDamage(), killRate, meanDamage);
+				}
+			}
+		}
+
+		//
+		// Cooperative planning
+		//
+
+		for (int squadSize : SQUAD_SIZES)
+		{
+			//Each batch moves a squad packed around a start cell to a block of goals further along the map
+			int batchCount = std::max(2, options.queries / squadSize);
+			int spread = static_cast<int>(std::sqrt(static_cast<double>(squadSize))) + 2;
+			std::vector<std::vector<CooperativeMoveRequest>> batches(batchCount);
+			std::vector<int> window;
+			for (int b(0); b < batchCount; ++b)
+			{
+				auto gather = [&](int centreX, int centreY)
+				{
+					window.clear();
+					for (int y(std::max(centreY - spread, 0)); y <= std::min(centreY + spread, map.height - 1); ++y)
+						for (int x(std::max(centreX - spread, 0)); x <= std::min(centreX + spread, map.width - 1); ++x)
+							if (grid.CanEnter(grid.CoordsToCell(x, y), LAND_UNIT))
+								window.push_back(grid.CoordsToCell(x, y));
+					std::shuffle(window.begin(), window.end(), rng);
+				};
+
+				int x = grid.GetCellX(starts[b % options.queries]);
+				int y = grid.GetCellY(starts[b % options.queries]);
+				gather(x, y);
+				std::vector<int> squadStarts(window.begin(), window.begin() + std::min<size_t>(squadSize, window.size()));
+				gather(std::min(x + SQUAD_MOVE_DISTANCE, map.width - 1), y);
+
+				for (size_t u(0); u < squadStarts.size(); ++u)
+				{
+					CooperativeMoveRequest request;
+					request.startCell = squadStarts[u];
+					request.goalCell = window.empty() ? squadStarts[u] : window[u % window.size()];
+					request.unitType = LAND_UNIT;
+					batches[b].push_back(request);
+				}
+			}
+
+			const COOPERATIVE_CONFLICTS modes[2] = { COOPERATIVE_CONFLICTS::PASS_THROUGH, COOPERATIVE_CONFLICTS::STRICT };
+			const char* modeNames[2] = { "coop", "strict" };
+			for (int m(0); m < 2; ++m)
+			{
+				std::string name = modeNames[m] + std::to_string(squadSize);
+				PrintResult(options, map, RunBenchmark(name.c_str(), batchCount,
+					[&]()
+					{
+						std::unique_ptr<CooperativePathPlanner> planner(new CooperativePathPlanner());
+						planner->SetConflictMode(modes[m]);
+						return planner;
+					},
+					[&](std::unique_ptr<CooperativePathPlanner>& planner, int i)
+					{
+						planner->PlanBatch(grid, batches[i]);
+						return static_cast<long long>(planner->GetExpansionCount());
+					}));
+
+				//Check every batch outside the timing, reporting the first bad plan
+				CooperativePathPlanner planner;
+				planner.SetConflictMode(modes[m]);
+				for (int i(0); i < batchCount; ++i)
+				{
+					planner.PlanBatch(grid, batches[i]);
+					std::string error = CheckCooperativePlan(grid, batches[i], planner);
+					if (!error.empty())
+					{
+						std::fprintf(stderr, "%s: %s plan %d is invalid, %s\n", map.name.c_str(), name.c_str(), i, error.c_str());
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<int> ParseSizes(const char* arg)
+	{
+		std::vector<int> sizes;
+		for (const char* p = arg; *p; )
+		{
+			char* end = nullptr;
+			long size = std::strtol(p, &end, 10);
+			if (end == p)
+				break;
+			if (size > 0)
+				sizes.push_back(static_cast<int>(size));
+			p = (*end == ',') ? end + 1 : end;
+		}
+		return sizes;
+	}
+
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: PathfindingBenchmark [options]\n"
+			"  --sizes a,b,c    Generated map sizes (default 64,256,1024,4096)\n"
+			"  --queries n      Queries per search (default 1000, path queries are reduced on large maps)\n"
+			"  --seed n         Seed for map generation and query endpoints (default 1)\n"
+			"  --tilemap path   Tiled export to benchmark (default Tilemap_00.json, \"\" to skip)\n"
+			"  --csv            Print results as CSV\n"
+			"  --trace dir      Write path query logs and heatmaps to dir (needs a TRACE=1 build, slows path queries)\n"
+			"  --landmark-cache dir  Cache landmark tables in dir, adding the altload row\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	for (int i(1); i < argc; ++i)
+	{
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--sizes") && hasValue)
+			options.sizes = ParseSizes(argv[++i]);
+		else if (!std::strcmp(argv[i], "--queries") && hasValue)
+			options.queries = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--seed") && hasValue)
+			options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--tilemap") && hasValue)
+			options.tilemapPath = argv[++i];
+		else if (!std::strcmp(argv[i], "--csv"))
+			options.csv = true;
+		else if (!std::strcmp(argv[i], "--trace") && hasValue)
+			options.traceDir = argv[++i];
+		else if (!std::strcmp(argv[i], "--landmark-cache") && hasValue)
+			options.landmarkCacheDir = argv[++i];
+		else
+		{
+			PrintUsage();
+			return std::strcmp(argv[i], "--help") ? 1 : 0;
+		}
+	}
+
+	if (!options.traceDir.empty() && !PATH_TRACE_ENABLED)
+	{
+		std::fprintf(stderr, "--trace needs tracing compiled in (make TRACE=1)\n");
+		return 1;
+	}
+
+	PrintHeader(options);
+
+	std::string budgetedLayers = CheckBudgetedLayers();
+	if (!budgetedLayers.empty())
+		std::fprintf(stderr, "Budgeted cost layer check: %s\n", budgetedLayers.c_str());
+
+	if (!options.tilemapPath.empty())
+	{
+		BenchmarkMap tilemap;
+		if (BenchmarkMaps::LoadTilemap(tilemap, options.tilemapPath))
+			RunMapBenchmarks(options, tilemap);
+		else
+			std::fprintf(stderr, "Could not load %s (missing file, or built without RapidJSON), skipped\n", options.tilemapPath.c_str());
+	}
+
+	const BENCHMARK_MAP_TYPE corpus[] =
+	{
+		BENCHMARK_MAP_TYPE::OPEN_FIELD,
+		BENCHMARK_MAP_TYPE::MAZE,
+		BENCHMARK_MAP_TYPE::RIVERS,
+		BENCHMARK_MAP_TYPE::MIXED_TERRAIN
+	};
+	for (int size : options.sizes)
+	{
+		for (BENCHMARK_MAP_TYPE type : corpus)
+		{
+			BenchmarkMap map;
+			BenchmarkMaps::GenerateMap(map, type, size, options.seed);
+			RunMapBenchmarks(options, map);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+#include "CombatForecast.h"
+
+#include <algorithm>
+
+SkillForecast CombatForecast::Forecast(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill)
+{
+	SkillForecast forecast;
+
+	switch (skill.skillType)
+	{
+	case CombatResolver::SKILL_TYPE::DAMAGE:
+	{
+		//Resolve always rolls both, so the crit roll is independent of the hit roll
+		double hit = RollChance(CombatResolver::HitChance(user, target, skill));
+		double crit = RollChance(CombatResolver::CritChance(user, skill));
+		forecast.missChance = static_cast<float>(1.0 - hit);
+		forecast.hitChance = static_cast<float>(hit * (1.0 - crit));
+		forecast.critChance = static_cast<float>(hit * crit);
+		forecast.hitDamage = CombatResolver::Damage(user, target, skill, false);
+		forecast.critDamage = CombatResolver::Damage(user, target, skill, true);
+
+		float hp = std::max(target.CurrentHP, 0.0f);
+		forecast.expectedDamage = forecast.hitChance * forecast.hitDamage + forecast.critChance * forecast.critDamage;
+		forecast.expectedHPLost = forecast.hitChance * std::min(forecast.hitDamage, hp) +
+			forecast.critChance * std::min(forecast.critDamage, hp);
+		//As the HP is taken and checked after the skill
+		forecast.killChance =
+			(target.CurrentHP <= 0 ? forecast.missChance : 0.0f) +
+			(target.CurrentHP - forecast.hitDamage <= 0 ? forecast.hitChance : 0.0f) +
+			(target.CurrentHP - forecast.critDamage <= 0 ? forecast.critChance : 0.0f);
+		break;
+	}
+	case CombatResolver::SKILL_TYPE::HEAL:
+		forecast.hitChance = 1.0f;
+		forecast.heal = CombatResolver::Heal(user, target, skill);
+		break;
+	case CombatResolver::SKILL_TYPE::BUFF:
+		forecast.hitChance = 1.0f;
+		break;
+	}
+
+	return forecast;
+}
+
+double CombatForecast::RollChance(float chance)
+{
+	//Rolls of 1 to k pass, and a roll is at most k for words below k * 2^32 / 100 (rounded up)
+	if (chance < 1.0f)
+		return 0.0;
+	if (chance >= 100.0f)
+		return 1.0;
+	uint64_t k = static_cast<uint64_t>(chance);
+	uint64_t words = ((k << 32) + 99) / 100;
+	return static_cast<double>(words) / 4294967296.0;
+}
+
+void DamageSequence::Begin(float targetHP)
+{
+	m_TargetHP = targetHP;
+	m_ExpectedDamage = 0.0;
+	m_Exact = true;
+	if (targetHP <= 0)
+	{
+		m_KillChance = 1.0;
+		m_OutcomeCount = 0;
+		return;
+	}
+	m_KillChance = 0.0;
+	m_OutcomeCount = 1;
+	m_Outcomes[0].damage = 0.0f;
+	m_Outcomes[0].chance = 1.0;
+}
+
+void DamageSequence::AddUse(const SkillForecast& use)
+{
+	m_ExpectedDamage += use.expectedDamage;
+	if (use.hitDamage <= 0 && use.critDamage <= 0)
+		return;
+
+	/*
+		Each surviving outcome branches into a miss, hit and crit. The outcomes are in damage order, so each branch is
+		too, and merging the three keeps the new outcomes in order with equal totals side by side.
+	*/
+	const float damage[3] = { 0.0f, use.hitDamage, use.critDamage };
+	const double chance[3] = { use.missChance, use.hitChance, use.critChance };
+	int next[3] = { 0, 0, 0 };
+	int count(0);
+	for (;;)
+	{
+		int branch = -1;
+		float total = 0.0f;
+		for (int b(0); b < 3; ++b)
+		{
+			if (chance[b] <= 0.0 || next[b] == m_OutcomeCount)
+				continue;
+			float t = m_Outcomes[next[b]].damage + damage[b];
+			if (branch < 0 || t < total)
+			{
+				branch = b;
+				total = t;
+			}
+		}
+		if (branch < 0)
+			break;
+
+		double p = m_Outcomes[next[branch]].chance * chance[branch];
+		++next[branch];
+		if (m_TargetHP - total <= 0)
+			m_KillChance += p;
+		else if (count > 0 && total - m_Branches[count - 1].damage <= DAMAGE_TOLERANCE)
+			m_Branches[count - 1].chance += p;
+		else
+			m_Branches[count++] = { total, p };
+	}
+
+	m_OutcomeCount = count;
+	if (m_OutcomeCount > MAX_OUTCOMES)
+		Reduce();
+	std::copy(m_Branches, m_Branches + m_OutcomeCount, m_Outcomes);
+}
+
+void DamageSequence::Reduce()
+{
+	m_Exact = false;
+	while (m_OutcomeCount > MAX_OUTCOMES)
+	{
+		int closest(0);
+		for (int i(1); i < m_OutcomeCount - 1; ++i)
+		{
+			if (m_Branches[i + 1].damage - m_Branches[i].damage < m_Branches[closest + 1].damage - m_Branches[closest].damage)
+				closest = i;
+		}
+
+		//Merged at their mean, so the expected damage is unchanged (and both survive, so the merge does too)
+		DamageOutcome& a = m_Branches[closest];
+		const DamageOutcome& b = m_Branches[closest + 1];
+		double p = a.chance + b.chance;
+		a.damage = static_cast<float>((a.damage * a.chance + b.damage * b.chance) / p);
+		a.chance = p;
+		std::copy(m_Branches + closest + 2, m_Branches + m_OutcomeCount, m_Branches + closest + 1);
+		--m_OutcomeCount;
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CombatResolver.h"		//Combat rules being forecast
+
+/*
+	What a skill can do to a target, worked out from the combat rules rather than rolled. Each damage skill use is
+	one of three outcomes (miss, hit, crit), with chances taken from the rolls CombatResolver::Resolve makes, so the
+	forecast is the exact distribution of ProcessSkill for the same units.
+*/
+struct SkillForecast
+{
+	//Chance of each outcome (summing to 1)
+	float missChance = 0.0f;
+	float hitChance = 0.0f;
+	float critChance = 0.0f;
+	//Damage of a hit and of a crit
+	float hitDamage = 0.0f;
+	float critDamage = 0.0f;
+	//HP restored by a heal (heals always land)
+	float heal = 0.0f;
+
+	//Mean damage, and the mean HP it takes (capped at the targets current HP, so overkill counts for nothing)
+	float expectedDamage = 0.0f;
+	float expectedHPLost = 0.0f;
+	//Chance the use alone kills the target (as UnitStatusCheck, at 0 HP or below)
+	float killChance = 0.0f;
+};
+
+//A total of damage taken across a sequence of uses, and its chance
+struct DamageOutcome
+{
+	float damage = 0.0f;
+	double chance = 0.0;
+};
+
+/*
+	Closed form combat forecasts, for AI scoring and tooltips. Forecast is O(1) and touches neither unit nor any
+	random state, so it can be run for every attacker, target and skill each frame.
+
+	A DamageSequence follows a target through several damage skill uses in turn (the attacks of a turn), keeping the
+	distribution of the total damage taken among the outcomes the target survives, and the chance of it having died.
+	Totals within DAMAGE_TOLERANCE of each other are merged (different orders of the same hits), so the same N uses
+	give (N + 1)(N + 2) / 2 outcomes at most, and any 4 uses fit in MAX_OUTCOMES. Past that the closest outcomes are
+	merged (keeping their mean) and the sequence is marked inexact. Outcomes are held in fixed arrays, so a sequence
+	never allocates and can be kept and reused.
+*/
+class CombatForecast
+{
+public:
+
+	static SkillForecast Forecast(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill);
+
+	/*
+		Exact chance of RandomStream::RollPercent being at most the given chance. A roll is 1 + the top of a 32 bit
+		word scaled by 100, so this is the fraction of words giving a roll in range (within 1e-9 of chance / 100).
+	*/
+	static double RollChance(float chance);
+};
+
+class DamageSequence
+{
+public:
+
+	//Most surviving outcomes kept
+	static constexpr int MAX_OUTCOMES = 128;
+	//Totals closer than this are the same outcome
+	static constexpr float DAMAGE_TOLERANCE = 1e-3f;
+
+	DamageSequence() {}
+	~DamageSequence() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Chance the target has died by the end of the uses added
+	double GetKillChance() const { return m_KillChance; }
+	//Mean total damage of the uses added (uncapped, so summing each uses expected damage)
+	double GetExpectedDamage() const { return m_ExpectedDamage; }
+	//Outcomes the target survives, lowest total damage first (their chances sum to 1 less the kill chance)
+	int GetOutcomeCount() const { return m_OutcomeCount; }
+	const DamageOutcome& GetOutcome(int index) const { return m_Outcomes[index]; }
+	//False once outcomes have been merged to fit
+	bool IsExact() const { return m_Exact; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Starts the sequence against a target on the given HP, with no damage taken
+	void Begin(float targetHP);
+	//Adds a damage skill use (heal and buff forecasts leave the sequence as it is)
+	void AddUse(const SkillForecast& use);
+
+private:
+
+	//Merges the closest neighbouring outcomes until there are no more than MAX_OUTCOMES
+	void Reduce();
+
+	////////////
+	/// Data ///
+	////////////
+
+	float m_TargetHP = 0.0f;
+	double m_KillChance = 0.0;
+	double m_ExpectedDamage = 0.0;
+	bool m_Exact = true;
+
+	int m_OutcomeCount = 0;
+	DamageOutcome m_Outcomes[MAX_OUTCOMES];
+	//Outcomes after a use, before merging (each outcome branches three ways)
+	DamageOutcome m_Branches[MAX_OUTCOMES * 3];
+};
@@ -0,0 +1,64 @@
+#include "CombatResolver.h"
+
+CombatOutcome CombatResolver::Resolve(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill, RandomStream& random)
+{
+	CombatOutcome outcome;
+
+	switch (skill.skillType)
+	{
+	case SKILL_TYPE::DAMAGE:
+	{
+		int hitRoll = random.RollPercent();
+		int critRoll = random.RollPercent();
+		if (hitRoll <= HitChance(user, target, skill))
+		{
+			outcome.hit = true;
+			outcome.crit = critRoll <= CritChance(user, skill);
+			outcome.damage = Damage(user, target, skill, outcome.crit);
+		}
+		break;
+	}
+	case SKILL_TYPE::HEAL:
+		outcome.hit = true;
+		outcome.heal = Heal(user, target, skill);
+		break;
+	case SKILL_TYPE::BUFF:
+		outcome.hit = true;
+		outcome.buffApplied = true;
+		break;
+	}
+
+	return outcome;
+}
+
+float CombatResolver::HitChance(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill)
+{
+	if (skill.damageType == DAMAGE_TYPE::MAGICAL)
+		return user.TotalMagHit - target.TotalMagResist;
+	return user.TotalPhysHit - target.TotalEvasion;
+}
+
+float CombatResolver::CritChance(const ClassTotals& user, const CombatSkill& skill)
+{
+	return user.TotalCritHit + skill.innateCrit;
+}
+
+float CombatResolver::Damage(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill, bool crit)
+{
+	float damage = skill.damageType == DAMAGE_TYPE::MAGICAL ?
+		user.TotalMagAttack * skill.damageScaling - target.TotalMagArmour :
+		user.TotalPhysAttack * skill.damageScaling - target.TotalPhysArmour;
+	if (crit)
+		damage *= user.TotalCritMultiplier;
+	if (damage < 0)
+		damage = 0;
+	return damage;
+}
+
+float CombatResolver::Heal(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill)
+{
+	float healed = target.CurrentHP + user.MaxHP * skill.healPercent;
+	if (healed > target.MaxHP)
+		healed = target.MaxHP;
+	return healed - target.CurrentHP;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+#include "GameTypes.h"		//Class totals
+#include "CounterRandom.h"	//Combat rolls
+
+/*
+	Numbers of a skill the combat calculations need, taken from its ability data (see SkillInterface::GetCombatSkill)
+*/
+struct CombatSkill
+{
+	//Skill and damage types as in AbilityData.json (CombatResolver::SKILL_TYPE, CombatResolver::DAMAGE_TYPE)
+	int skillType = 0;
+	int damageType = 0;
+	//Attack multiplier of the damage type
+	float damageScaling = 0.0f;
+	//Crit chance added to the users
+	float innateCrit = 0.0f;
+	//Fraction of the users max HP restored
+	float healPercent = 0.0f;
+};
+
+//What a skill did to its target
+struct CombatOutcome
+{
+	CombatOutcome()
+		:damage(0.0f), heal(0.0f), hit(false), crit(false), buffApplied(false)
+	{}
+
+	//HP taken from the target (before clamping at 0, which is left to the death check)
+	float damage;
+	//HP restored to the target (already clamped to its max HP)
+	float heal;
+	//Skill landed (heals and buffs always land)
+	bool hit : 1;
+	bool crit : 1;
+	bool buffApplied : 1;
+};
+
+/*
+	Combat rules, apart from the units and their presentation. Resolve takes the users and targets totals, the skill
+	and a random stream, and gives back what happened without changing either unit, so fights can be resolved
+	headless (AI lookahead, simulation, tests) and the GameplayManager applies and animates the outcome separately.
+
+	Damage skills roll to hit (1 to 100 against the users hit less the targets evasion or magic resist) and then to
+	crit (against the users crit plus the skills), always drawing both rolls so every resolution uses the same amount
+	of the stream. Give each target of an action its own stream (see GameplayManager::ProcessSkill) and its rolls
+	don't depend on the order targets are resolved in.
+*/
+class CombatResolver
+{
+public:
+
+	enum SKILL_TYPE
+	{
+		DAMAGE,
+		HEAL,
+		BUFF
+	};
+
+	enum DAMAGE_TYPE
+	{
+		PHYSICAL,
+		MAGICAL
+	};
+
+	static CombatOutcome Resolve(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill, RandomStream& random);
+
+	//Chance (in percent) of a damage skill hitting
+	static float HitChance(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill);
+	//Chance (in percent) of a hit being a crit
+	static float CritChance(const ClassTotals& user, const CombatSkill& skill);
+	//Damage dealt by a hit
+	static float Damage(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill, bool crit);
+	//HP restored by a heal, up to the targets max HP
+	static float Heal(const ClassTotals& user, const ClassTotals& target, const CombatSkill& skill);
+};
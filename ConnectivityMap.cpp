@@ -0,0 +1,179 @@
+#include "ConnectivityMap.h"
+
+namespace
+{
+	//Passable cell awaiting a label while building
+	const int UNLABELLED = -2;
+}
+
+void ConnectivityMap::Build(NavGrid& grid, int unitTypeCount)
+{
+	Release();
+
+	m_Grid = &grid;
+	int cellCount = grid.GetCellCount();
+	m_UnitLabels.assign(unitTypeCount, UnitLabels());
+	m_FloodStack.reserve(cellCount);
+
+	for (int unitType(0); unitType < unitTypeCount; ++unitType)
+	{
+		UnitLabels& unit = m_UnitLabels[unitType];
+		unit.labels.resize(cellCount);
+		for (int cell(0); cell < cellCount; ++cell)
+			unit.labels[cell] = IsPassable(cell, unitType) ? UNLABELLED : NO_COMPONENT;
+
+		//Flood out from each passable cell not yet labelled
+		for (int cell(0); cell < cellCount; ++cell)
+		{
+			if (unit.labels[cell] != UNLABELLED)
+				continue;
+
+			int label = AllocateLabel(unit);
+			unit.sizes[label] = FloodLabel(unit, cell, UNLABELLED, label);
+		}
+	}
+
+	grid.AddListener(this);
+}
+
+void ConnectivityMap::Release()
+{
+	if (m_Grid)
+		m_Grid->RemoveListener(this);
+	m_Grid = nullptr;
+	m_UnitLabels.clear();
+}
+
+void ConnectivityMap::OnCellChanged(const NavGrid&, int cell)
+{
+	for (int unitType(0); unitType < GetUnitTypeCount(); ++unitType)
+	{
+		UnitLabels& unit = m_UnitLabels[unitType];
+		bool wasPassable = unit.labels[cell] != NO_COMPONENT;
+		bool isPassable = IsPassable(cell, unitType);
+
+		//Most changes (occupation, move cost) leave the terrain as it was
+		if (wasPassable == isPassable)
+			continue;
+
+		if (isPassable)
+			JoinCell(unit, cell);
+		else
+			SplitCell(unit, cell);
+	}
+}
+
+int ConnectivityMap::AllocateLabel(UnitLabels& unit)
+{
+	++unit.componentCount;
+	if (!unit.freeLabels.empty())
+	{
+		int label = unit.freeLabels.back();
+		unit.freeLabels.pop_back();
+		return label;
+	}
+
+	unit.sizes.push_back(0);
+	return static_cast<int>(unit.sizes.size()) - 1;
+}
+
+void ConnectivityMap::FreeLabel(UnitLabels& unit, int label)
+{
+	--unit.componentCount;
+	unit.sizes[label] = 0;
+	unit.freeLabels.push_back(label);
+}
+
+int ConnectivityMap::FloodLabel(UnitLabels& unit, int seedCell, int oldLabel, int newLabel)
+{
+	int count = 0;
+
+	m_FloodStack.clear();
+	m_FloodStack.push_back(seedCell);
+	unit.labels[seedCell] = newLabel;
+
+	while (!m_FloodStack.empty())
+	{
+		int cell = m_FloodStack.back();
+		m_FloodStack.pop_back();
+		++count;
+
+		for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+		{
+			int neighbour = cell + m_Grid->GetNeighbourOffset(i);
+			if (unit.labels[neighbour] != oldLabel)
+				continue;
+
+			unit.labels[neighbour] = newLabel;
+			m_FloodStack.push_back(neighbour);
+		}
+	}
+
+	return count;
+}
+
+void ConnectivityMap::JoinCell(UnitLabels& unit, int cell)
+{
+	//Find the largest component next to the cell, the others get merged into it
+	int joinLabel = NO_COMPONENT;
+	for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+	{
+		int label = unit.labels[cell + m_Grid->GetNeighbourOffset(i)];
+		if (label != NO_COMPONENT && (joinLabel == NO_COMPONENT || unit.sizes[label] > unit.sizes[joinLabel]))
+			joinLabel = label;
+	}
+
+	//Nothing around it, so it's a component of its own
+	if (joinLabel == NO_COMPONENT)
+		joinLabel = AllocateLabel(unit);
+
+	unit.labels[cell] = joinLabel;
+	++unit.sizes[joinLabel];
+
+	//Relabel the smaller components
+	for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+	{
+		int neighbour = cell + m_Grid->GetNeighbourOffset(i);
+		int label = unit.labels[neighbour];
+		if (label == NO_COMPONENT || label == joinLabel)
+			continue;
+
+		unit.sizes[joinLabel] += FloodLabel(unit, neighbour, label, joinLabel);
+		FreeLabel(unit, label);
+	}
+}
+
+void ConnectivityMap::SplitCell(UnitLabels& unit, int cell)
+{
+	int oldLabel = unit.labels[cell];
+	unit.labels[cell] = NO_COMPONENT;
+
+	//Gather the neighbours that were linked through this cell
+	int neighbours[NavGrid::NEIGHBOUR_COUNT];
+	int neighbourCount = 0;
+	for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+	{
+		int neighbour = cell + m_Grid->GetNeighbourOffset(i);
+		if (unit.labels[neighbour] == oldLabel)
+			neighbours[neighbourCount++] = neighbour;
+	}
+
+	//With one neighbour or less, no route can have depended on the cell
+	if (neighbourCount <= 1)
+	{
+		if (--unit.sizes[oldLabel] == 0)
+			FreeLabel(unit, oldLabel);
+		return;
+	}
+
+	//Flood each part that is still labelled with the old label into a new component
+	for (int i(0); i < neighbourCount; ++i)
+	{
+		if (unit.labels[neighbours[i]] != oldLabel)
+			continue;
+
+		int label = AllocateLabel(unit);
+		unit.sizes[label] = FloodLabel(unit, neighbours[i], oldLabel, label);
+	}
+	FreeLabel(unit, oldLabel);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+
+#include "NavGrid.h"		//Labelled grid
+
+/*
+	Connected component labels of the nav grid, one set per unit type. Two cells with the same label can reach
+	each other, so queries between cells with different labels can be rejected without searching.
+
+	Only the terrain is considered (impassable flags and terrain types), not occupation, as units move every
+	turn and can usually be walked around. Labels are updated as cells change: a cell opening up merges the
+	components around it, a cell closing off relabels only the component it belonged to.
+*/
+class ConnectivityMap : public NavGridListenerInterface
+{
+public:
+
+	//Label of cells that can't be entered by the unit type
+	static constexpr int NO_COMPONENT = -1;
+
+	ConnectivityMap() {}
+	~ConnectivityMap() { Release(); }
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Component label of a cell for a unit type (NO_COMPONENT if it can't be entered)
+	int GetComponent(int cell, int unitType) const { return m_UnitLabels[unitType].labels[cell]; }
+	//Can a unit of the given type ever travel between the two cells
+	bool AreConnected(int cellA, int cellB, int unitType) const
+	{
+		const std::vector<int>& labels = m_UnitLabels[unitType].labels;
+		return labels[cellA] != NO_COMPONENT && labels[cellA] == labels[cellB];
+	}
+	/*
+		Quick rejection test for searches. False only if the cells are known to be in different components,
+		so unlabelled unit types and start cells off passable terrain are left for the search to decide.
+	*/
+	bool MayBeReachable(int fromCell, int toCell, int unitType) const
+	{
+		if (unitType < 0 || unitType >= GetUnitTypeCount() || fromCell == toCell)
+			return true;
+		return GetComponent(fromCell, unitType) == NO_COMPONENT || AreConnected(fromCell, toCell, unitType);
+	}
+	int GetComponentCount(int unitType) const { return m_UnitLabels[unitType].componentCount; }
+	//Number of cells in a component
+	int GetComponentSize(int component, int unitType) const { return m_UnitLabels[unitType].sizes[component]; }
+	int GetUnitTypeCount() const { return static_cast<int>(m_UnitLabels.size()); }
+	//Per cell labels of a unit type (for debug views and tools), labels are not contiguous
+	const std::vector<int>& GetLabels(int unitType) const { return m_UnitLabels[unitType].labels; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Labels the grid for unit types 0 to unitTypeCount - 1 and starts listening for changes
+	void Build(NavGrid& grid, int unitTypeCount);
+	//Stops listening to the grid and releases the labels
+	void Release();
+
+	/////////////////
+	/// Overrides ///
+	/////////////////
+
+	void OnCellChanged(const NavGrid& grid, int cell) override;
+
+private:
+
+	struct UnitLabels
+	{
+		std::vector<int> labels;
+		//Cell count of each label (0 for unused labels)
+		std::vector<int> sizes;
+		std::vector<int> freeLabels;
+		int componentCount = 0;
+	};
+
+	//Can the unit type stand on the cell, ignoring occupation
+	bool IsPassable(int cell, int unitType) const
+	{
+		return !(m_Grid->GetFlags(cell) & (NavGrid::IMPASSABLE | NavGrid::BORDER)) && m_Grid->GetTerrainType(cell) == unitType;
+	}
+
+	//Takes an unused label
+	int AllocateLabel(UnitLabels& unit);
+	void FreeLabel(UnitLabels& unit, int label);
+	//Relabels every cell connected to the seed that holds the old label, returning the number relabelled
+	int FloodLabel(UnitLabels& unit, int seedCell, int oldLabel, int newLabel);
+
+	//Cell has become passable, joining any components next to it
+	void JoinCell(UnitLabels& unit, int cell);
+	//Cell has become impassable, splitting its component if it was the only link between parts of it
+	void SplitCell(UnitLabels& unit, int cell);
+
+	////////////
+	/// Data ///
+	////////////
+
+	NavGrid* m_Grid = nullptr;
+	std::vector<UnitLabels> m_UnitLabels;
+	std::vector<int> m_FloodStack;
+};
@@ -0,0 +1,406 @@
+#include "CooperativePathPlanner.h"
+
+#include <algorithm>	//std::reverse, std::find, std::min, std::max
+
+void SpaceTimeReservationTable::Reset(int cellCount)
+{
+	//Only allocate if the grid has grown since the last batch
+	if (static_cast<int>(m_RestUnits.size()) < cellCount)
+	{
+		m_RestUnits.resize(cellCount, -1);
+		m_RestTimes.resize(cellCount, MAX_TIME + 1);
+		m_LastTimes.resize(cellCount, -1);
+		m_TouchedSet.Resize(cellCount);
+		m_TouchedCells.reserve(cellCount);
+	}
+
+	for (int cell : m_TouchedCells)
+	{
+		m_RestUnits[cell] = -1;
+		m_RestTimes[cell] = MAX_TIME + 1;
+		m_LastTimes[cell] = -1;
+		m_TouchedSet.Reset(cell);
+	}
+	m_TouchedCells.clear();
+	m_Steps.Clear();
+	m_LastChangeTime = -1;
+}
+
+void SpaceTimeReservationTable::ReserveStep(int cell, int time, int unit)
+{
+	Touch(cell);
+	m_Steps.Insert(StepKey(cell, time), unit);
+	m_LastTimes[cell] = std::max(m_LastTimes[cell], time);
+	m_LastChangeTime = std::max(m_LastChangeTime, time);
+}
+
+void SpaceTimeReservationTable::ReserveRest(int cell, int fromTime, int unit)
+{
+	Touch(cell);
+	m_RestUnits[cell] = unit;
+	m_RestTimes[cell] = fromTime;
+	m_LastTimes[cell] = MAX_TIME;
+	m_LastChangeTime = std::max(m_LastChangeTime, fromTime);
+}
+
+void SpaceTimeReservationTable::Touch(int cell)
+{
+	if (m_TouchedSet.Test(cell))
+		return;
+
+	m_TouchedSet.Set(cell);
+	m_TouchedCells.push_back(cell);
+}
+
+PathResult CooperativePathPlanner::GetPlan(int unit) const
+{
+	const UnitPlan& p = m_Plans[unit];
+	if (p.length == 0)
+		return PathResult();
+
+	PathResult result;
+	result.cells = m_PlanCells.data() + p.first;
+	result.length = p.length;
+	result.cost = p.cost;
+	return result;
+}
+
+void CooperativePathPlanner::PlanBatch(const NavGrid& grid, const std::vector<CooperativeMoveRequest>& requests)
+{
+	int cellCount = grid.GetCellCount();
+	int unitCount = static_cast<int>(requests.size());
+	if (m_StartSet.GetBitCount() < cellCount)
+		m_StartSet.Resize(cellCount);
+
+	m_Staying.assign(unitCount, 0);
+	m_Plans.assign(unitCount, UnitPlan());
+	m_PlanCells.clear();
+	m_ExpansionCount = 0;
+	m_PassCount = 0;
+
+	//Batch units will be moving off their starts, so the searches don't treat them as occupied
+	for (auto& r : requests)
+		if (r.startCell >= 0 && r.startCell < cellCount)
+			m_StartSet.Set(r.startCell);
+
+	//Plan again for as long as units staying put got in the way of units planned before them
+	int replanFrom = 0;
+	while (replanFrom < unitCount)
+		replanFrom = PlanPass(grid, requests, replanFrom);
+
+	for (auto& r : requests)
+		if (r.startCell >= 0 && r.startCell < cellCount)
+			m_StartSet.Reset(r.startCell);
+}
+
+int CooperativePathPlanner::PlanPass(const NavGrid& grid, const std::vector<CooperativeMoveRequest>& requests, int replanFrom)
+{
+	++m_PassCount;
+	m_Reservations.Reset(grid.GetCellCount());
+
+	//Units known to be staying are held first, so everyone else plans around them
+	int unitCount = static_cast<int>(requests.size());
+	for (int u(0); u < unitCount; ++u)
+		if (m_Staying[u])
+			ReservePlan(u);
+
+	//Units before the first one a stayer got in the way of keep their plans, as nothing they used has changed
+	for (int u(0); u < replanFrom; ++u)
+		if (!m_Staying[u])
+			ReservePlan(u);
+
+	int nextReplanFrom = unitCount;
+	for (int u(replanFrom); u < unitCount; ++u)
+	{
+		const CooperativeMoveRequest& r = requests[u];
+		if (m_Staying[u])
+			continue;
+
+		//Nowhere to plan from
+		if (r.startCell < 0 || r.startCell >= grid.GetCellCount() || grid.IsBorder(r.startCell))
+		{
+			m_Plans[u] = UnitPlan();
+			continue;
+		}
+
+		int goalNode = SearchUnit<NavGrid::Topology>(grid, r);
+		if (goalNode != -1)
+		{
+			StoreRoute(u, goalNode);
+			ReservePlan(u);
+			continue;
+		}
+
+		//Can't get there, so stay put
+		UnitPlan& p = m_Plans[u];
+		p.first = static_cast<int>(m_PlanCells.size());
+		p.length = 1;
+		p.cost = 0.f;
+		p.reachedGoal = r.startCell == r.goalCell;
+		m_PlanCells.push_back(r.startCell);
+		m_Staying[u] = 1;
+
+		//If a unit planned earlier is already using the tile, everything from that unit on is planned again
+		bool blocksEarlier = m_Mode == COOPERATIVE_CONFLICTS::STRICT ?
+			m_Reservations.GetLastReservedTime(r.startCell) >= 0 : m_Reservations.GetRestingUnit(r.startCell) != -1;
+		if (blocksEarlier)
+			nextReplanFrom = std::min(nextReplanFrom, FindFirstUser(r.startCell, u));
+		ReservePlan(u);
+	}
+
+	return nextReplanFrom;
+}
+
+int CooperativePathPlanner::FindFirstUser(int cell, int beforeUnit) const
+{
+	bool strict = m_Mode == COOPERATIVE_CONFLICTS::STRICT;
+	for (int u(0); u < beforeUnit; ++u)
+	{
+		const UnitPlan& p = m_Plans[u];
+		if (m_Staying[u] || p.length == 0)
+			continue;
+
+		//Pass through units only hold the tile they end on
+		const int* cells = m_PlanCells.data() + p.first;
+		if (strict ? std::find(cells, cells + p.length, cell) != cells + p.length : cells[p.length - 1] == cell)
+			return u;
+	}
+	return beforeUnit;
+}
+
+template<typename Topology>
+int CooperativePathPlanner::SearchUnit(const NavGrid& grid, const CooperativeMoveRequest& request)
+{
+	int cellCount = grid.GetCellCount();
+	int goal = request.goalCell;
+	if (goal < 0 || goal >= cellCount || grid.IsBorder(goal) || m_Reservations.GetRestingUnit(goal) != -1)
+		return -1;
+	if (goal != request.startCell && !CanEnter(grid, goal, request.unitType))
+		return -1;
+
+	bool strict = m_Mode == COOPERATIVE_CONFLICTS::STRICT;
+	int stride = grid.GetStride();
+	int minMoveCost = grid.GetMinMoveCost();
+	int goalX = grid.GetCellX(goal);
+	int goalY = grid.GetCellY(goal);
+
+	//Strict searches go through time, so are guided by the true distance around staying units. This also rejects
+	//goals that can't be reached (or afforded) at all, before any searching through time.
+	if (strict)
+	{
+		BeginReverseSearch(grid, request);
+		int startDistance = GetGoalDistance<Topology>(grid, request, request.startCell);
+		if (startDistance < 0 || startDistance > request.maxCost)
+			return -1;
+	}
+	auto heuristic = [&](int cell)
+	{
+		if (strict)
+			return GetGoalDistance<Topology>(grid, request, cell);
+		return Topology::Distance(goalX - grid.GetCellX(cell), goalY - grid.GetCellY(cell), minMoveCost);
+	};
+
+	m_Nodes.clear();
+	m_NodeIndexes.Clear();
+	m_OpenList.Clear();
+
+	//Nothing changes past the last reservation, so states after it are keyed to the step after it
+	int lastChangeTime = m_Reservations.GetLastChangeTime();
+	auto stateTime = [&](int time) { return strict ? std::min(time, lastChangeTime + 1) : 0; };
+
+	bool isNew = false;
+	int startIndex = GetNode(request.startCell, stateTime(0), isNew);
+	m_Nodes[startIndex] = { request.startCell, 0, 0, 0, -1, false };
+	float startH = static_cast<float>(heuristic(request.startCell));
+	m_OpenList.Push(startIndex, startH, startH);
+
+	int expansions = 0;
+	while (!m_OpenList.IsEmpty() && expansions < m_SearchLimit)
+	{
+		int index = m_OpenList.Pop();
+		m_Nodes[index].closed = true;
+		++m_ExpansionCount;
+		++expansions;
+
+		//Copied out, as adding nodes can move the node array
+		SearchNode current = m_Nodes[index];
+		if (current.cell == goal && CanRest(goal, current.time))
+			return index;
+		if (current.time >= m_TimeHorizon)
+			continue;
+
+		int nextTime = current.time + 1;
+		auto relax = [&](int next, int stepCost, int moveStep)
+		{
+			if (strict)
+			{
+				//Someone else is on the cell next step
+				if (m_Reservations.GetUnitAt(next, nextTime) != -1)
+					return;
+				//The unit on the cell now is stepping onto this one (a swap)
+				int other = next != current.cell ? m_Reservations.GetUnitAt(next, current.time) : -1;
+				if (other != -1 && m_Reservations.GetUnitAt(current.cell, nextTime) == other)
+					return;
+			}
+
+			//Over budget, or (with true distances) can no longer make it within budget
+			int newMove = current.moveCost + moveStep;
+			int newH = heuristic(next);
+			if (newH < 0 || newMove + (strict ? newH : 0) > request.maxCost)
+				return;
+			int newG = current.gCost + stepCost;
+
+			//Friendly units don't block each other in pass through mode, so only the cell matters there
+			int child = GetNode(next, stateTime(nextTime), isNew);
+			if (isNew)
+			{
+				m_Nodes[child] = { next, nextTime, newG, newMove, index, false };
+				m_OpenList.Push(child, static_cast<float>(newG + newH), static_cast<float>(newH));
+			}
+			else if (!m_Nodes[child].closed && newG < m_Nodes[child].gCost)
+			{
+				m_Nodes[child] = { next, nextTime, newG, newMove, index, false };
+				m_OpenList.DecreaseKey(child, static_cast<float>(newG + newH), static_cast<float>(newH));
+			}
+		};
+
+		//Waiting only helps while units can still block each other
+		if (strict && current.time <= lastChangeTime)
+			relax(current.cell, WAIT_COST, 0);
+
+		ForEachDirection<Topology>([&](auto direction)
+		{
+			int next = current.cell + Topology::Offset(direction, stride);
+			if (!CanEnter(grid, next, request.unitType))
+				return;
+			int stepCost = Topology::StepCost(direction, grid.GetMoveCost(next));
+			relax(next, stepCost, stepCost);
+		});
+	}
+
+	return -1;
+}
+
+void CooperativePathPlanner::BeginReverseSearch(const NavGrid& grid, const CooperativeMoveRequest& request)
+{
+	m_ReverseSearch.BeginQuery(grid.GetCellCount());
+	m_ReverseSearch.OpenNode(request.goalCell, 0.f, -1);
+	m_ReverseSearch.GetOpenList().Push(request.goalCell, 0.f, 0.f);
+}
+
+template<typename Topology>
+int CooperativePathPlanner::GetGoalDistance(const NavGrid& grid, const CooperativeMoveRequest& request, int cell)
+{
+	if (m_ReverseSearch.IsNodeClosed(cell))
+		return static_cast<int>(m_ReverseSearch.GetGCost(cell));
+
+	//Carry on the search out from the goal (aimed at the units start) till the cell is settled
+	IndexedMinHeap& openList = m_ReverseSearch.GetOpenList();
+	int stride = grid.GetStride();
+	int minMoveCost = grid.GetMinMoveCost();
+	int startX = grid.GetCellX(request.startCell);
+	int startY = grid.GetCellY(request.startCell);
+	while (!openList.IsEmpty())
+	{
+		int current = openList.Pop();
+		m_ReverseSearch.CloseNode(current);
+		float currentG = m_ReverseSearch.GetGCost(current);
+
+		//Step backwards, to each neighbour that could have moved onto the current cell
+		ForEachDirection<Topology>([&](auto direction)
+		{
+			//Units held in place from the first step are as good as walls
+			int previous = current + Topology::Offset(direction, stride);
+			if (m_ReverseSearch.IsNodeClosed(previous) || !CanEnter(grid, previous, request.unitType) ||
+				(m_Reservations.GetRestTime(previous) == 0 && previous != request.startCell))
+				return;
+
+			float newG = currentG + Topology::StepCost(direction, grid.GetMoveCost(current));
+			float newH = static_cast<float>(Topology::Distance(startX - grid.GetCellX(previous), startY - grid.GetCellY(previous), minMoveCost));
+			if (!m_ReverseSearch.IsNodeSeen(previous))
+			{
+				m_ReverseSearch.OpenNode(previous, newG, current);
+				openList.Push(previous, newG + newH, newH);
+			}
+			else if (newG < m_ReverseSearch.GetGCost(previous))
+			{
+				m_ReverseSearch.OpenNode(previous, newG, current);
+				openList.DecreaseKey(previous, newG + newH, newH);
+			}
+		});
+
+		if (current == cell)
+			return static_cast<int>(currentG);
+	}
+
+	//Ran out of cells without reaching it
+	return -1;
+}
+
+void CooperativePathPlanner::StoreRoute(int unit, int goalNode)
+{
+	//Walk the parents back into a start to goal route
+	m_RouteScratch.clear();
+	for (int n = goalNode; n != -1; n = m_Nodes[n].parent)
+		m_RouteScratch.push_back(m_Nodes[n].cell);
+	std::reverse(m_RouteScratch.begin(), m_RouteScratch.end());
+
+	UnitPlan& p = m_Plans[unit];
+	p.first = static_cast<int>(m_PlanCells.size());
+	p.length = static_cast<int>(m_RouteScratch.size());
+	p.cost = static_cast<float>(m_Nodes[goalNode].moveCost) / NavGrid::MOVE_COST_SCALE;
+	p.reachedGoal = true;
+	m_PlanCells.insert(m_PlanCells.end(), m_RouteScratch.begin(), m_RouteScratch.end());
+}
+
+bool CooperativePathPlanner::CanEnter(const NavGrid& grid, int cell, int unitType) const
+{
+	if (grid.CanEnter(cell, unitType))
+		return true;
+
+	//Batch units are moving off their starts, so only the terrain blocks there
+	return m_StartSet.Test(cell) && !(grid.GetFlags(cell) & (NavGrid::IMPASSABLE | NavGrid::BORDER)) &&
+		grid.GetTerrainType(cell) == unitType;
+}
+
+bool CooperativePathPlanner::CanRest(int cell, int time) const
+{
+	//Strict units must have the cell to themselves from arrival, pass through units just can't share an end tile
+	if (m_Mode == COOPERATIVE_CONFLICTS::STRICT)
+		return m_Reservations.GetLastReservedTime(cell) < time;
+	return m_Reservations.GetRestingUnit(cell) == -1;
+}
+
+void CooperativePathPlanner::ReservePlan(int unit)
+{
+	const UnitPlan& p = m_Plans[unit];
+	if (p.length == 0)
+		return;
+
+	const int* cells = m_PlanCells.data() + p.first;
+	if (m_Mode == COOPERATIVE_CONFLICTS::STRICT)
+		for (int t(0); t < p.length; ++t)
+			m_Reservations.ReserveStep(cells[t], t, unit);
+	m_Reservations.ReserveRest(cells[p.length - 1], p.length - 1, unit);
+}
+
+int CooperativePathPlanner::GetNode(int cell, int time, bool& isNew)
+{
+	uint64_t key = (static_cast<uint64_t>(cell) << 20) | static_cast<uint64_t>(time);
+	int index = m_NodeIndexes.Find(key);
+	isNew = index == -1;
+	if (!isNew)
+		return index;
+
+	index = static_cast<int>(m_Nodes.size());
+	m_Nodes.push_back({ cell, time, 0, 0, -1, false });
+	m_NodeIndexes.Insert(key, index);
+
+	//Grow the open list in doubling steps, rather than one node at a time
+	if (static_cast<int>(m_Nodes.capacity()) > m_OpenListCapacity)
+	{
+		m_OpenListCapacity = static_cast<int>(m_Nodes.capacity());
+		m_OpenList.Resize(m_OpenListCapacity);
+	}
+	return index;
+}
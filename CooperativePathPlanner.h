@@ -0,0 +1,241 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "NavGrid.h"					//Searched grid
+#include "PathfindingContainers.h"		//Open list, state tables
+#include "PathQuery.h"					//Result type
+
+/*
+	How units planned in the same batch may share tiles.
+	PASS_THROUGH: friendly units walk through each other freely, but no two end on the same tile (turn based moves,
+	played one after the other).
+	STRICT: no two units are ever on the same tile at the same step, nor swap tiles in one step (moves played at once).
+*/
+enum class COOPERATIVE_CONFLICTS
+{
+	PASS_THROUGH,
+	STRICT
+};
+
+/*
+	One unit to move in a batch.
+*/
+struct CooperativeMoveRequest
+{
+	//NavGrid cells the unit starts on and wants to end on
+	int startCell = -1;
+	int goalCell = -1;
+	//UnitEntity::UNIT_TYPE of the unit, compared against the cells terrain type
+	int unitType = 0;
+	//Movement budget in fixed point, see NavGrid::QuantiseBudget (defaults to unbounded)
+	int maxCost = INT32_MAX;
+};
+
+/*
+	Space-time reservation table. Records which unit holds a cell at each time step of a batch, and which cells
+	units come to rest on (held from their arrival onwards). Step reservations are sparse (hashed by cell and time),
+	rest reservations are dense per cell.
+*/
+class SpaceTimeReservationTable
+{
+public:
+
+	//Largest time step that can be reserved
+	static constexpr int MAX_TIME = (1 << 20) - 1;
+
+	SpaceTimeReservationTable() {}
+	~SpaceTimeReservationTable() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Unit holding the cell at the time step, counting units at rest there (-1 if free)
+	int GetUnitAt(int cell, int time) const
+	{
+		if (m_RestTimes[cell] <= time)
+			return m_RestUnits[cell];
+		return m_Steps.Find(StepKey(cell, time));
+	}
+	//Unit resting on the cell, from which time step (-1 and MAX_TIME + 1 if none)
+	int GetRestingUnit(int cell) const { return m_RestUnits[cell]; }
+	int GetRestTime(int cell) const { return m_RestTimes[cell]; }
+	//Latest time step the cell is held by any unit (-1 if never, MAX_TIME if a unit rests there)
+	int GetLastReservedTime(int cell) const { return m_LastTimes[cell]; }
+	//Latest time step any single step reservation or rest starts at (past it, the table no longer changes)
+	int GetLastChangeTime() const { return m_LastChangeTime; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Empties the table for a grid of the given size (only allocates if the grid has grown)
+	void Reset(int cellCount);
+
+	//Holds the cell at a single time step
+	void ReserveStep(int cell, int time, int unit);
+	//Holds the cell from the time step onwards
+	void ReserveRest(int cell, int fromTime, int unit);
+
+private:
+
+	static uint64_t StepKey(int cell, int time) { return (static_cast<uint64_t>(cell) << 20) | static_cast<uint64_t>(time); }
+	void Touch(int cell);
+
+	StampedHashMap m_Steps;
+	std::vector<int> m_RestUnits;
+	std::vector<int> m_RestTimes;
+	std::vector<int> m_LastTimes;
+	//Cells with dense entries set, reset on the next Reset
+	std::vector<int> m_TouchedCells;
+	TileBitset m_TouchedSet;
+	int m_LastChangeTime = -1;
+};
+
+/*
+	Cooperative path planner (cooperative A* with a space-time reservation table, windowed by a time horizon).
+	Plans a batch of units one after the other in request order, each searching over (cell, time step) and
+	avoiding what the units before it reserved. Units in the batch treat each others start tiles as free, as they
+	will move off them.
+
+	Under STRICT, the search is guided by each cells true distance to the goal around the units staying put, found by a
+	reverse search from the goal that is resumed as cells are asked for (reverse resumable A*). Goals that can't be
+	reached at all, or not within budget, are rejected before searching through time, and states that can no longer
+	make the budget are pruned. Past the last time step anything is reserved at the table stops changing, so later
+	steps share one state per cell.
+
+	A unit that can't reach its goal within its budget, the horizon and the search limit (goal taken, blocked in, too
+	far) stays where it is. Staying may block a unit planned earlier, so the batch is planned again with every
+	staying unit held in place first, from the first unit that was blocked (the plans before it are kept), until no
+	new unit has to stay in anyones way. The result is always conflict free.
+
+	All containers are reused between batches, so planning does not allocate once warm.
+*/
+class CooperativePathPlanner
+{
+public:
+
+	//Default number of time steps a unit may take to reach its goal
+	static constexpr int DEFAULT_TIME_HORIZON = 64;
+	//Default number of states a single units search may expand before it gives up and stays
+	static constexpr int DEFAULT_SEARCH_LIMIT = 4096;
+	//Fixed point cost of waiting a step (STRICT only), so waits are taken over detours only when cheaper
+	static constexpr int WAIT_COST = 1;
+
+	CooperativePathPlanner() {}
+	~CooperativePathPlanner() {}
+
+	///////////
+	/// Set ///
+	///////////
+
+	void SetConflictMode(COOPERATIVE_CONFLICTS mode) { m_Mode = mode; }
+	void SetTimeHorizon(int steps) { m_TimeHorizon = steps < SpaceTimeReservationTable::MAX_TIME ? steps : SpaceTimeReservationTable::MAX_TIME; }
+	void SetSearchLimit(int expansions) { m_SearchLimit = expansions; }
+
+	///////////
+	/// Get ///
+	///////////
+
+	COOPERATIVE_CONFLICTS GetConflictMode() const { return m_Mode; }
+	int GetUnitCount() const { return static_cast<int>(m_Plans.size()); }
+	/*
+		Planned route of a unit in the last batch, one cell per time step starting at its start (a repeated cell is a
+		wait), ending where it comes to rest. Cost is the movement spent. Valid until the next batch is planned.
+	*/
+	PathResult GetPlan(int unit) const;
+	//Did the unit reach its goal (otherwise it stays on its start)
+	bool IsGoalReached(int unit) const { return m_Plans[unit].reachedGoal; }
+	//Nodes expanded over the whole of the last batch
+	int GetExpansionCount() const { return m_ExpansionCount; }
+	//Number of times the last batch was planned (1 unless units had to stay)
+	int GetPassCount() const { return m_PassCount; }
+	int GetTimeHorizon() const { return m_TimeHorizon; }
+	int GetSearchLimit() const { return m_SearchLimit; }
+	const SpaceTimeReservationTable& GetReservations() const { return m_Reservations; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Plans conflict free routes for every unit in the batch
+	void PlanBatch(const NavGrid& grid, const std::vector<CooperativeMoveRequest>& requests);
+
+private:
+
+	struct UnitPlan
+	{
+		int first = 0;
+		int length = 0;
+		float cost = 0.f;
+		bool reachedGoal = false;
+	};
+
+	struct SearchNode
+	{
+		int cell;
+		int time;
+		//Cost including waits, and movement spent
+		int gCost;
+		int moveCost;
+		int parent;
+		bool closed;
+	};
+
+	/*
+		Holds the staying units and the plans of units before replanFrom, then plans every unit from there on.
+		Returns the first unit a new stayer got in the way of (the unit count if none, and the batch is done).
+	*/
+	int PlanPass(const NavGrid& grid, const std::vector<CooperativeMoveRequest>& requests, int replanFrom);
+	//First unit before the given one whose plan holds the cell (beforeUnit if none)
+	int FindFirstUser(int cell, int beforeUnit) const;
+	//Cooperative A* for one unit (over cells and time steps if STRICT), returning the goal node or -1
+	template<typename Topology>
+	int SearchUnit(const NavGrid& grid, const CooperativeMoveRequest& request);
+	//Starts the reverse search from the units goal
+	void BeginReverseSearch(const NavGrid& grid, const CooperativeMoveRequest& request);
+	//Fixed point distance from the cell to the goal around staying units, resuming the reverse search as needed (-1 if unreachable)
+	template<typename Topology>
+	int GetGoalDistance(const NavGrid& grid, const CooperativeMoveRequest& request, int cell);
+	//Appends the route ending at the node as the units plan
+	void StoreRoute(int unit, int goalNode);
+	//Can the unit type stand on the cell (batch start cells count as unoccupied)
+	bool CanEnter(const NavGrid& grid, int cell, int unitType) const;
+	//Can the unit come to rest on the cell, arriving at the time step
+	bool CanRest(int cell, int time) const;
+	//Holds the route just planned for the unit
+	void ReservePlan(int unit);
+	//Finds or adds the node for a state, returning its index (sets isNew if added)
+	int GetNode(int cell, int time, bool& isNew);
+
+	////////////
+	/// Data ///
+	////////////
+
+	COOPERATIVE_CONFLICTS m_Mode = COOPERATIVE_CONFLICTS::PASS_THROUGH;
+	int m_TimeHorizon = DEFAULT_TIME_HORIZON;
+	int m_SearchLimit = DEFAULT_SEARCH_LIMIT;
+
+	SpaceTimeReservationTable m_Reservations;
+	//Start cells of the batch, and the units that have to stay on theirs
+	TileBitset m_StartSet;
+	std::vector<uint8_t> m_Staying;
+
+	//Routes of every unit, packed one after the other
+	std::vector<UnitPlan> m_Plans;
+	std::vector<int> m_PlanCells;
+
+	//Search state, nodes indexed through the state table
+	std::vector<SearchNode> m_Nodes;
+	StampedHashMap m_NodeIndexes;
+	IndexedMinHeap m_OpenList;
+	int m_OpenListCapacity = 0;
+	std::vector<int> m_RouteScratch;
+	//Reverse search from the current goal, over cells only
+	PathSearchArena m_ReverseSearch;
+
+	int m_ExpansionCount = 0;
+	int m_PassCount = 0;
+};
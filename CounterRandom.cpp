@@ -0,0 +1,186 @@
+#include "CounterRandom.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define COUNTER_RANDOM_SSE2 1
+#else
+	#define COUNTER_RANDOM_SSE2 0
+#endif
+
+namespace
+{
+	//Philox4x32 multipliers and key increments (the Weyl sequence of the golden ratio and sqrt(3) - 1)
+	const uint32_t PHILOX_M0 = 0xD2511F53u;
+	const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+	const uint32_t PHILOX_W0 = 0x9E3779B9u;
+	const uint32_t PHILOX_W1 = 0xBB67AE85u;
+	const int PHILOX_ROUNDS = 10;
+
+	//Below this many blocks a thread, splitting a fill costs more than it saves
+	const size_t PARALLEL_FILL_MIN_BLOCKS = 16384;
+
+#if COUNTER_RANDOM_SSE2
+	//Full 64 bit products of 4 lanes with m, split into their high and low words
+	inline void MulHiLo(__m128i a, __m128i m, __m128i& hi, __m128i& lo)
+	{
+		__m128i even = _mm_mul_epu32(a, m);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+		__m128i low = _mm_unpacklo_epi32(even, odd);
+		__m128i high = _mm_unpackhi_epi32(even, odd);
+		lo = _mm_unpacklo_epi64(low, high);
+		hi = _mm_unpackhi_epi64(low, high);
+	}
+#endif
+}
+
+void RandomStream::Reset(uint64_t matchID, uint32_t unitID, uint32_t actionID)
+{
+	m_Key[0] = static_cast<uint32_t>(matchID);
+	m_Key[1] = static_cast<uint32_t>(matchID >> 32);
+	m_UnitID = unitID;
+	m_ActionID = actionID;
+	m_Position = 0;
+	m_BufferedBlock = ~0ull;
+}
+
+void RandomStream::GenerateBlock(const uint32_t counter[BLOCK_WORDS], const uint32_t key[2], uint32_t out[BLOCK_WORDS])
+{
+	uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	uint32_t k0 = key[0], k1 = key[1];
+	for (int r(0); r < PHILOX_ROUNDS; ++r)
+	{
+		uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+		uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+		c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+		c1 = static_cast<uint32_t>(p1);
+		c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+		c3 = static_cast<uint32_t>(p0);
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+void RandomStream::Generate(uint64_t block)
+{
+	uint32_t counter[BLOCK_WORDS] = { static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32), m_ActionID, m_UnitID };
+	GenerateBlock(counter, m_Key, m_Buffer);
+	m_BufferedBlock = block;
+}
+
+void RandomStream::FillBlocks(uint64_t firstBlock, size_t blockCount, uint32_t* out) const
+{
+	size_t b(0);
+#if COUNTER_RANDOM_SSE2
+	//4 blocks at once, a lane each, so each round is a handful of instructions for all 4
+	const __m128i m0 = _mm_set1_epi32(static_cast<int>(PHILOX_M0));
+	const __m128i m1 = _mm_set1_epi32(static_cast<int>(PHILOX_M1));
+	const __m128i action = _mm_set1_epi32(static_cast<int>(m_ActionID));
+	const __m128i unit = _mm_set1_epi32(static_cast<int>(m_UnitID));
+	for (; b + 4 <= blockCount; b += 4)
+	{
+		uint64_t block = firstBlock + b;
+		__m128i c0 = _mm_set_epi32(static_cast<int>(block + 3), static_cast<int>(block + 2),
+			static_cast<int>(block + 1), static_cast<int>(block));
+		__m128i c1 = _mm_set_epi32(static_cast<int>((block + 3) >> 32), static_cast<int>((block + 2) >> 32),
+			static_cast<int>((block + 1) >> 32), static_cast<int>(block >> 32));
+		__m128i c2 = action;
+		__m128i c3 = unit;
+		uint32_t k0 = m_Key[0], k1 = m_Key[1];
+		for (int r(0); r < PHILOX_ROUNDS; ++r)
+		{
+			__m128i hi0, lo0, hi1, lo1;
+			MulHiLo(c0, m0, hi0, lo0);
+			MulHiLo(c2, m1, hi1, lo1);
+			c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(static_cast<int>(k0)));
+			c1 = lo1;
+			c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(static_cast<int>(k1)));
+			c3 = lo0;
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+
+		//Lanes hold blocks, so transpose to write each block's words together
+		__m128i t0 = _mm_unpacklo_epi32(c0, c1);
+		__m128i t1 = _mm_unpacklo_epi32(c2, c3);
+		__m128i t2 = _mm_unpackhi_epi32(c0, c1);
+		__m128i t3 = _mm_unpackhi_epi32(c2, c3);
+		__m128i* dest = reinterpret_cast<__m128i*>(out + b * BLOCK_WORDS);
+		_mm_storeu_si128(dest, _mm_unpacklo_epi64(t0, t1));
+		_mm_storeu_si128(dest + 1, _mm_unpackhi_epi64(t0, t1));
+		_mm_storeu_si128(dest + 2, _mm_unpacklo_epi64(t2, t3));
+		_mm_storeu_si128(dest + 3, _mm_unpackhi_epi64(t2, t3));
+	}
+#endif
+	//Remaining blocks (all of them without SSE2)
+	for (; b < blockCount; ++b)
+	{
+		uint64_t block = firstBlock + b;
+		uint32_t counter[BLOCK_WORDS] = { static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32), m_ActionID, m_UnitID };
+		GenerateBlock(counter, m_Key, out + b * BLOCK_WORDS);
+	}
+}
+
+template<typename FillWholeBlocks>
+void RandomStream::FillAligned(uint32_t* out, size_t count, FillWholeBlocks&& fillWholeBlocks)
+{
+	//Words up to the next block boundary come from the buffer
+	size_t written(0);
+	while (written < count && m_Position % BLOCK_WORDS != 0)
+		out[written++] = NextU32();
+
+	size_t blockCount = (count - written) / BLOCK_WORDS;
+	if (blockCount > 0)
+	{
+		fillWholeBlocks(m_Position / BLOCK_WORDS, blockCount, out + written);
+		written += blockCount * BLOCK_WORDS;
+		m_Position += blockCount * BLOCK_WORDS;
+	}
+
+	while (written < count)
+		out[written++] = NextU32();
+}
+
+void RandomStream::Fill(uint32_t* out, size_t count)
+{
+	FillAligned(out, count, [this](uint64_t firstBlock, size_t blockCount, uint32_t* dest)
+	{
+		FillBlocks(firstBlock, blockCount, dest);
+	});
+}
+
+void RandomStream::FillParallel(uint32_t* out, size_t count, int threadCount)
+{
+	FillAligned(out, count, [this, threadCount](uint64_t firstBlock, size_t blockCount, uint32_t* dest)
+	{
+		//Each thread fills a contiguous run of blocks, each block depending only on its counter
+		size_t threads = threadCount > 0 ? static_cast<size_t>(threadCount) : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		threads = std::min(threads, std::max<size_t>(blockCount / PARALLEL_FILL_MIN_BLOCKS, 1));
+		if (threads == 1)
+		{
+			FillBlocks(firstBlock, blockCount, dest);
+			return;
+		}
+
+		std::vector<std::thread> workers;
+		workers.reserve(threads);
+		for (size_t i(0); i < threads; ++i)
+		{
+			size_t first = blockCount * i / threads;
+			size_t last = blockCount * (i + 1) / threads;
+			workers.emplace_back([this, firstBlock, first, last, dest]()
+			{
+				FillBlocks(firstBlock + first, last - first, dest + first * BLOCK_WORDS);
+			});
+		}
+		for (auto& w : workers)
+			w.join();
+	});
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/*
+	Counter based random numbers (Philox4x32-10, Salmon et al. 2011). Each block of 4 words is a keyed hash of its
+	counter, so any word of any stream can be made without the ones before it:
+
+	- key:     the match (a 64 bit seed, so each match plays out differently)
+	- counter: the block within the stream (64 bit), then the action and the unit the stream belongs to
+
+	So every (match, unit, action) has its own stream, independent of how many rolls any other drew, and a stream can
+	skip ahead or seek to any position in O(1). A stream is a few words and takes no locks, so each thread or simulated
+	fight can hold its own, and bulk fills give the same words whether made one at a time, in SSE2 batches of 4
+	blocks, or split across any number of threads.
+*/
+class RandomStream
+{
+public:
+
+	//Words in a Philox block
+	static constexpr int BLOCK_WORDS = 4;
+
+	RandomStream() {}
+	RandomStream(uint64_t matchID, uint32_t unitID, uint32_t actionID) { Reset(matchID, unitID, actionID); }
+	~RandomStream() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Words drawn from the stream so far
+	uint64_t GetPosition() const { return m_Position; }
+
+	uint64_t GetMatchID() const { return static_cast<uint64_t>(m_Key[1]) << 32 | m_Key[0]; }
+	uint32_t GetUnitID() const { return m_UnitID; }
+	uint32_t GetActionID() const { return m_ActionID; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Starts the stream for a unit and action of a match, from its first word
+	void Reset(uint64_t matchID, uint32_t unitID, uint32_t actionID);
+	//Moves to a word of the stream (O(1), the words between are never made)
+	void Seek(uint64_t position) { m_Position = position; }
+	void SkipAhead(uint64_t words) { m_Position += words; }
+
+	uint32_t NextU32()
+	{
+		uint64_t block = m_Position / BLOCK_WORDS;
+		if (block != m_BufferedBlock)
+			Generate(block);
+		return m_Buffer[m_Position++ % BLOCK_WORDS];
+	}
+	uint64_t Next()
+	{
+		uint64_t low = NextU32();
+		return static_cast<uint64_t>(NextU32()) << 32 | low;
+	}
+	//Float in [0, 1) (24 bits, so each value is exactly representable)
+	float NextFloat() { return static_cast<float>(NextU32() >> 8) * (1.0f / 16777216.0f); }
+	//Percentage roll of 1 to 100 (scaling the word, so without modulo bias)
+	int RollPercent() { return 1 + static_cast<int>((static_cast<uint64_t>(NextU32()) * 100ull) >> 32); }
+
+	/*
+		Writes the next count words of the stream to out and moves past them, giving the same words as count calls
+		to NextU32. Whole blocks are made 4 at a time with SSE2 where available.
+	*/
+	void Fill(uint32_t* out, size_t count);
+	/*
+		As Fill, splitting the whole blocks between threads (0 for every hardware thread). The words are the same for
+		any thread count.
+	*/
+	void FillParallel(uint32_t* out, size_t count, int threadCount);
+
+	//The Philox4x32-10 block for a counter and key
+	static void GenerateBlock(const uint32_t counter[BLOCK_WORDS], const uint32_t key[2], uint32_t out[BLOCK_WORDS]);
+
+private:
+
+	//Buffers the words of a block
+	void Generate(uint64_t block);
+	//Writes blockCount whole blocks from firstBlock to out, without touching the buffer or position
+	void FillBlocks(uint64_t firstBlock, size_t blockCount, uint32_t* out) const;
+	//Splits the fill into the words before the first whole block, the whole blocks, and the words after
+	template<typename FillWholeBlocks>
+	void FillAligned(uint32_t* out, size_t count, FillWholeBlocks&& fillWholeBlocks);
+
+	////////////
+	/// Data ///
+	////////////
+
+	uint32_t m_Key[2] = { 0, 0 };
+	uint32_t m_UnitID = 0;
+	uint32_t m_ActionID = 0;
+	uint64_t m_Position = 0;
+	//Block the buffer holds (none to start with)
+	uint64_t m_BufferedBlock = ~0ull;
+	uint32_t m_Buffer[BLOCK_WORDS] = {};
+};
@@ -69,44 +69,26 @@ void CursorEntity::Move(CURSOR_DIR dir)
 	}
 }
 
-bool CursorEntity::SearchForUnitObject(std::vector<EntityInterface*>& container, int rowLength)
+bool CursorEntity::SearchForUnitObject(const UnitOccupancyMap& occupancy, std::vector<EntityInterface*>& container)
 {
-	for (auto& a : container)
-	{
-		XMINT2& coords = a->GetMapCoordinates();
-		//If cursor matches coordinates of object
-		if ((coords.x == m_MapCoordinates.x) && (coords.y == m_MapCoordinates.y))
-		{
-			m_Object = a;
-			return true;
-		}
-	}
-	//No matches so cursor is likely not hovering a unit anymore so clear pointer.
-	m_Object = nullptr;
-	return false;
+	int handle = occupancy.GetUnitAt(m_MapCoordinates.x, m_MapCoordinates.y);
+	//No unit on the tile so cursor is likely not hovering a unit anymore so clear pointer.
+	m_Object = handle != UnitOccupancyMap::NO_UNIT ? container[handle] : nullptr;
+	return m_Object != nullptr;
 }
 
-bool CursorEntity::SearchForSecondUnitObject(std::vector<EntityInterface*>& container, int rowLength)
+bool CursorEntity::SearchForSecondUnitObject(const UnitOccupancyMap& occupancy, std::vector<EntityInterface*>& container)
 {
-	for (auto& a : container)
-	{
-		XMINT2& coords = a->GetMapCoordinates();
-		//If cursor matches coordinates of object
-		if ((coords.x == m_MapCoordinates.x) && (coords.y == m_MapCoordinates.y))
-		{
-			m_2ndTarget = a;
-			return true;
-		}
-	}
-	//No matches so cursor is likely not hovering a unit anymore so clear pointer.
-	m_2ndTarget = nullptr;
-	return false;
+	int handle = occupancy.GetUnitAt(m_MapCoordinates.x, m_MapCoordinates.y);
+	//No unit on the tile so cursor is likely not hovering a unit anymore so clear pointer.
+	m_2ndTarget = handle != UnitOccupancyMap::NO_UNIT ? container[handle] : nullptr;
+	return m_2ndTarget != nullptr;
 }
 
 bool CursorEntity::SearchForTileObject(std::vector<MapTile*>& container, int rowLength)
 {
 	//Find tile using map coordinates (tile position needs to be accurate to its position in the container, i.e 0,5 = index 4 in array)
-	m_TileObject = container.at(static_cast<size_t>((m_MapCoordinates.x + m_MapCoordinates.y) + (m_MapCoordinates.y * rowLength)));
+	m_TileObject = container.at(static_cast<size_t>(MapTile::CoordsToTileIndex(m_MapCoordinates, rowLength)));
 
 	//Extra errorchecking
 	DBOUT(std::to_string(m_TileObject->GetMapCoordinates().x) << ", " << std::to_string(m_TileObject->GetMapCoordinates().y));
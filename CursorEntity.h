@@ -5,6 +5,7 @@
 
 #include "MapTile.h"		//For search algorithm
 #include "UnitEntity.h"
+#include "UnitOccupancy.h"	//Unit on each tile
 
 /*
 	Specialised class for representing a game unit. Setup for specific navigation and interact with the world space.
@@ -63,10 +64,10 @@ public:
 	//Move cursor coordinates (Doesn't move the visual cursor so sync with camera)
 	void MoveFixedCursorCoords(DirectX::XMINT2& newCoords) { m_MapCoordinates = newCoords; }
 
-	//Search a given container for coordinate matching object and store pointer to it
-	bool SearchForUnitObject(std::vector<EntityInterface*>& container, int rowLength);
-	//Search for a given container for coordinate matching enemy object and store pointer to it
-	bool SearchForSecondUnitObject(std::vector<EntityInterface*>& container, int rowLength);
+	//Look up the unit under the cursor in the occupancy map and store pointer to it (container indexed by handle)
+	bool SearchForUnitObject(const UnitOccupancyMap& occupancy, std::vector<EntityInterface*>& container);
+	//Look up the unit under the cursor in the occupancy map and store pointer to it as the second (target) unit
+	bool SearchForSecondUnitObject(const UnitOccupancyMap& occupancy, std::vector<EntityInterface*>& container);
 	//Search a given container for matching tile object and store pointer to it
 	bool SearchForTileObject(std::vector<MapTile*>& container, int rowLength);
 
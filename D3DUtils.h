@@ -3,6 +3,7 @@
 #include "D3DUtils_Debug.h"
 
 #include "MathHelper.h"
+#include "RangeShapes.h"		//Skill range and area shapes
 
 //
 // Suite of DX & Game related utilities, support types functions etc. for use.
@@ -129,6 +130,8 @@ struct DamageSkills
 	int ManaCost = 0;
 	int Range = 0;
 	int Radius = 0;
+	RANGE_SHAPE RangeShape = RANGE_SHAPE::DIAMOND;
+	RANGE_SHAPE RadiusShape = RANGE_SHAPE::DIAMOND;
 	float PhysDamageScaling = 0.0f;
 	float MagDamageScaling = 0.0f;
 	float InnateCrit = 0.0f;
@@ -145,6 +148,8 @@ struct HealSkills
 	int ManaCost = 0;
 	int Range = 0;
 	int Radius = 0;
+	RANGE_SHAPE RangeShape = RANGE_SHAPE::DIAMOND;
+	RANGE_SHAPE RadiusShape = RANGE_SHAPE::DIAMOND;
 	float HealPercent = 0.0f;
 	std::string ToolTip;
 };
@@ -160,6 +165,8 @@ struct BuffSkills
 	int TurnCount = 0;
 	int Range = 0;
 	int Radius = 0;
+	RANGE_SHAPE RangeShape = RANGE_SHAPE::DIAMOND;
+	RANGE_SHAPE RadiusShape = RANGE_SHAPE::DIAMOND;
 	float PhysDamageBuff = 0.0f;
 	float MagDamageBuff = 0.0f;
 	float PhysHitBuff = 0.0f;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 /*
 	Specific Types for this game.
 */
@@ -8,7 +10,7 @@
 struct TileProperties
 {
 	TileProperties()
-		:tileName("Tile"), tileID(-1), moveCost(-1), terrainTypeID(99),
+		:tileName("Tile"), tileID(-1), terrainTypeID(99), moveCost(-1),
 		impassable(false), occupied(false)
 	{}
 	std::string tileName;
@@ -17,4 +19,23 @@ struct TileProperties
 	float moveCost;
 	bool impassable : 1;
 	bool occupied : 1;
-};
\ No newline at end of file
+};
+
+//Sum of a units class, equipment and buffs, as used by the combat calculations (see CombatResolver)
+struct ClassTotals {
+	float MaxHP = 0.0f;
+	float CurrentHP = 0.0f;
+	int MaxMP = 0;
+	int CurrentMP = 0;
+	float TotalMovespeed = 0.0f;
+	float TotalPhysAttack = 0.0f;
+	float TotalMagAttack = 0.0f;
+	float TotalPhysHit = 0.0f;
+	float TotalMagHit = 0.0f;
+	float TotalCritHit = 0.0f;
+	float TotalCritMultiplier = 0.0f;
+	float TotalPhysArmour = 0.0f;
+	float TotalMagArmour = 0.0f;
+	float TotalEvasion = 0.0f;
+	float TotalMagResist = 0.0f;
+};
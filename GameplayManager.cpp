@@ -3,9 +3,13 @@
 #include "Game.h"
 #include "TestEntity.h"
 
+#include <ctime>
+
 GameplayManager::GameplayManager()
 {
 	m_AttackStateUnits.reserve(3);
+	//Until a match is started, play as one seeded from the clock
+	StartMatch(static_cast<uint64_t>(time(0)));
 }
 
 GameplayManager::~GameplayManager()
@@ -49,7 +53,12 @@ void GameplayManager::Update(const GameTimer& gt, UnitEntity* unit1, UnitEntity*
 {
 	MoveProjectiles(gt);
 
-	if (AttackPlayed && DamageHit)
+	//The display target reacts to its own outcome
+	const CombatOutcome* outcome = OutcomeShown ? nullptr : FindOutcome(unit2);
+	bool damageHit = outcome && outcome->hit;
+	bool damageDodge = outcome && !outcome->hit;
+
+	if (AttackPlayed && damageHit)
 	{
 		if (unit1->GetSkillAtIndex(index)->GetSkillRange() > 1 && ProjectileHit)
 		{
@@ -61,7 +70,7 @@ void GameplayManager::Update(const GameTimer& gt, UnitEntity* unit1, UnitEntity*
 		}
 	}
 
-	if (AttackPlayed && m_AttackStateUnits[2]->GetPrimarySprite().GetPosition().x > m_AttackStateUnits[1]->GetPrimarySprite().GetPosition().x - (ProjectileOffsetX * 10) && DamageDodge)
+	if (AttackPlayed && m_AttackStateUnits[2]->GetPrimarySprite().GetPosition().x > m_AttackStateUnits[1]->GetPrimarySprite().GetPosition().x - (ProjectileOffsetX * 10) && damageDodge)
 	{
 		PlayDodge(unit2);
 	}
@@ -73,97 +82,40 @@ void GameplayManager::Update(const GameTimer& gt, UnitEntity* unit1, UnitEntity*
 		ResetUnit2ToIdle(unit2);
 }
 
-void GameplayManager::ProcessSkill(UnitEntity* unit1, UnitEntity* unit2, int index)
+void GameplayManager::StartMatch(uint64_t matchID)
 {
-	switch (unit1->GetSkillAtIndex(index)->GetSkillType())
-	{
-	case SkillType::DAMAGE:
-		switch (unit1->GetSkillAtIndex(index)->GetDamageType())
-		{
-		case DamageType::PHYSICAL:
-
-			if (HitPercentage() <= PhysHit(unit1, unit2))
-			{
-				DamageHit = true;
-				if (CritHitPercentage() <= CritHit(unit1,index))
-				{
-					unit1->GetSkillAtIndex(index)->DoCrit(unit1, unit2);
-				}
-				else
-				{
-					unit1->GetSkillAtIndex(index)->DoAction(unit1, unit2);
-				}
-			}
-			else
-			{
-				DamageDodge = true;
-			}
-			break;
-		case DamageType::MAGICAL:
-
-			if (HitPercentage() <= MagHit(unit1, unit2))
-			{
-				DamageHit = true;
-				if (CritHitPercentage() <= CritHit(unit1, index))
-				{
-					unit1->GetSkillAtIndex(index)->DoCrit(unit1, unit2);
-				}
-				else
-				{
-					unit1->GetSkillAtIndex(index)->DoAction(unit1, unit2);
-				}
-			}
-			else
-			{
-				DamageDodge = true;
-			}
-			break;
-		}
-		break;
-	case SkillType::HEAL:
-		unit1->GetSkillAtIndex(index)->DoAction(unit1, unit2);
-		break;
-	case SkillType::BUFF:
-		unit1->GetSkillAtIndex(index)->DoAction(unit1, unit2);
-		break;
-	}
+	m_MatchID = matchID;
+	m_ActionCount = 0;
 }
 
-int GameplayManager::HitPercentage()
+CombatOutcome GameplayManager::ProcessSkill(UnitEntity* unit1, UnitEntity* unit2, int index)
 {
-	srand((unsigned)time(0));
-
-	int hitchance = rand() % 100 + 1;
-	return hitchance;
+	//The targets own stream for this action
+	RandomStream random(m_MatchID, static_cast<uint32_t>(unit2->GetOccupancyHandle()), m_ActionCount);
+	CombatOutcome outcome = CombatResolver::Resolve(unit1->GetClassTotals(), unit2->GetClassTotals(),
+		unit1->GetSkillAtIndex(index)->GetCombatSkill(), random);
+	ApplyOutcome(unit1, unit2, index, outcome);
+
+	m_Outcomes.push_back({ unit2, outcome });
+	return outcome;
 }
 
-int GameplayManager::CritHitPercentage()
+void GameplayManager::ApplyOutcome(UnitEntity* unit1, UnitEntity* unit2, int index, const CombatOutcome& outcome)
 {
-	srand((unsigned)time(0));
-
-	int critChance = rand() % 100 + 1;
-	return critChance;
-}
-
-float GameplayManager::PhysHit(UnitEntity* unit1, UnitEntity* unit2)
-{
-	float PhysHit = unit1->GetClassTotals().TotalPhysHit -
-		unit2->GetClassTotals().TotalEvasion;
-	return PhysHit;
-}
-
-float GameplayManager::MagHit(UnitEntity* unit1, UnitEntity* unit2)
-{
-	float MagHit = unit1->GetClassTotals().TotalMagHit -
-		unit2->GetClassTotals().TotalMagResist;
-	return MagHit;
+	unit2->GetClassTotals().CurrentHP += outcome.heal - outcome.damage;
+	//Buffs set the targets percentages from the skill data
+	if (outcome.buffApplied)
+		unit1->GetSkillAtIndex(index)->DoAction(unit1, unit2);
 }
 
-float GameplayManager::CritHit(UnitEntity* unit1, int index)
+const CombatOutcome* GameplayManager::FindOutcome(UnitEntity* target) const
 {
-	float CritHit = unit1->GetClassTotals().TotalCritHit +
-		unit1->GetSkillAtIndex(index)->GetSkillCrit();
-	return CritHit;
+	for (auto& o : m_Outcomes)
+	{
+		if (o.target == target)
+			return &o.outcome;
+	}
+	return nullptr;
 }
 
 int GameplayManager::ManaReductions(UnitEntity* unit1,int index)
@@ -178,6 +130,10 @@ int GameplayManager::ManaReductions(UnitEntity* unit1,int index)
 
 void GameplayManager::BeforeStateEnter(UnitEntity* unit1, UnitEntity* unit2, std::vector<MapTile*>& tiles, int maxMapX, int index)
 {
+	//Fresh action, so no outcomes yet and fresh streams
+	m_Outcomes.clear();
+	++m_ActionCount;
+	OutcomeShown = false;
 	SetupAttackStateUnit1(unit1);
 	SetupAttackStateUnit2(unit2);
 	SetupBattleScene(unit1, tiles, maxMapX);
@@ -655,7 +611,7 @@ void GameplayManager::PlayHit(UnitEntity* unit2)
 			m_AttackStateUnits[1]->GetPrimarySprite().GetAnimator().SetAnimation((int)(WarriorAnimIndexes::HURT_00), true, false, false);
 			break;
 		}
-		DamageHit = false;
+		OutcomeShown = true;
 		AttackPlayed = false;
 		ProjectileHit = false;
 }
@@ -687,7 +643,7 @@ void GameplayManager::PlayDodge(UnitEntity* unit2)
 			m_AttackStateUnits[1]->GetPrimarySprite().GetAnimator().SetAnimation((int)(WarriorAnimIndexes::JUMP_00), true, false, false);
 			break;
 		}
-		DamageDodge = false;
+		OutcomeShown = true;
 		AttackPlayed = false;
 		ProjectileHit = false;
 }
@@ -853,9 +809,7 @@ void GameplayManager::SetupBattleScene(UnitEntity* unit1, std::vector<MapTile*>&
 
 MapTile*& GameplayManager::GetTileInArrayByCoordinates(std::vector<MapTile*>& tiles, DirectX::XMINT2& coords, int maxMapX)
 {
-	MapTile* tile = tiles.at((coords.x + (coords.y)) + (coords.y * maxMapX));
-
-	return tile;
+	return tiles.at(MapTile::CoordsToTileIndex(coords, maxMapX));
 }
 
 void GameplayManager::ResetUnit1ToIdle(UnitEntity* unit1)
@@ -1,6 +1,7 @@
 #pragma once
 #include "UnitEntity.h"
 #include "MapTile.h"
+#include "CombatResolver.h"		//Skill outcomes
 
 class GameplayManager
 {
@@ -34,14 +35,19 @@ public:
 	
 	void Update(const GameTimer& gt, UnitEntity* unit1, UnitEntity* unit2,int index);
 
-	//Decides which calculations to run based on skill type and if necessary damage type
+	//Resolves the skill with the CombatResolver, applies the outcome to the units and keeps it for the animations
 	/*
 	* Note -
 	* Unit 1 and 2 can be the same unit
 	* i.e. unit 1 wants to heal themselves, when selecting heal target they select
 	* themselves which makes them both unit 1 and 2
 	*/
-	void ProcessSkill(UnitEntity* unit1, UnitEntity* unit2, int index);
+	CombatOutcome ProcessSkill(UnitEntity* unit1, UnitEntity* unit2, int index);
+	/*
+		Starts the combat rolls of a match. Each target of each action rolls from its own stream of the match
+		(see RandomStream), so the same match ID and actions replay the same rolls.
+	*/
+	void StartMatch(uint64_t matchID);
 
 	//Calculate the mana reductions and do a check to see if remaining mana
 	//is less than 0 is it is set it = 0
@@ -65,14 +71,17 @@ public:
 	void SetUnit1ResetBool(bool reset) { Unit1Reset = reset; }
 	void SetUnit2ResetBool(bool reset) { Unit2Reset = reset; }
 private:
-	//Hit chance generator (rand num between 0-100)
-	int HitPercentage();
-	int CritHitPercentage();
+	//Outcome of a skill on one of its targets
+	struct TargetOutcome
+	{
+		UnitEntity* target = nullptr;
+		CombatOutcome outcome;
+	};
 
-	//Calculate the Hit chances for Physical, Magical and Crit
-	float PhysHit(UnitEntity* unit1, UnitEntity* unit2);
-	float MagHit(UnitEntity* unit1, UnitEntity* unit2);
-	float CritHit(UnitEntity* unit1, int index);
+	//Changes the units as the outcome says
+	void ApplyOutcome(UnitEntity* unit1, UnitEntity* unit2, int index, const CombatOutcome& outcome);
+	//Outcome of the current action on a target (nullptr if it wasn't one)
+	const CombatOutcome* FindOutcome(UnitEntity* target) const;
 
 	//Sets up each of the Action display units
 	void SetupAttackStateUnit1(UnitEntity* unit1);
@@ -113,8 +122,8 @@ private:
 	bool Unit1Reset = false;
 	bool Unit2Reset = false;
 	bool HasAnimPlayed = false;
-	bool DamageHit = false;
-	bool DamageDodge = false;
+	//Set once the display target has reacted to its outcome
+	bool OutcomeShown = false;
 	bool AttackPlayed = false;
 	bool ProjectileHit = false;
 	//Vector storing 2 UnitEntities that are used just for playing animations
@@ -123,6 +132,12 @@ private:
 	//Vector holding the battle scenes
 	std::vector<EntityInterface*> m_BattleScenes;
 
+	//Match the combat rolls are drawn for, and the actions taken in it (counted in BeforeStateEnter)
+	uint64_t m_MatchID = 0;
+	uint32_t m_ActionCount = 0;
+	//Outcomes of the current action, one per target (AoE skills have several)
+	std::vector<TargetOutcome> m_Outcomes;
+
 
 	//Testing
 
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdlib>		//std::abs
+#include <utility>		//std::integer_sequence
+#include <type_traits>	//std::integral_constant
+
+/*
+	Compile time grid topology policies. A policy describes how cells on a row major grid connect to each other,
+	so the searches and range shapes can be written once and instantiated per topology:
+
+	- NEIGHBOUR_COUNT, and the DX/DY tables giving the coordinate step for each direction
+	- Offset(direction, stride), the cell index step for a direction on a grid with the given row stride
+	- StepCost(direction, cellCost), the fixed point cost of stepping onto a cell in a direction
+	- Distance(dx, dy, minCost), a lower bound on the cost of travelling a coordinate delta (search heuristic)
+	- RowSpanMin/Max(dy, range), the x offsets of row dy that fall inside a range shape around a cell
+
+	Every policy only ever steps one cell in x and y, so a one cell border is enough to stop moves off the map.
+*/
+
+/*
+	Square cells joined at their edges (0 = North, 1 = East, 2 = South, 3 = West).
+	Manhattan distance, with diamond range shapes.
+*/
+struct SquareGrid4
+{
+	static constexpr int NEIGHBOUR_COUNT = 4;
+	static constexpr int DX[NEIGHBOUR_COUNT] = { 0, 1, 0, -1 };
+	static constexpr int DY[NEIGHBOUR_COUNT] = { -1, 0, 1, 0 };
+
+	static constexpr int Offset(int direction, int stride) { return DY[direction] * stride + DX[direction]; }
+	static constexpr int StepCost(int, int cellCost) { return cellCost; }
+	static constexpr int MaxStepCost(int cellCost) { return cellCost; }
+	static int Distance(int dx, int dy, int minCost) { return (std::abs(dx) + std::abs(dy)) * minCost; }
+
+	static constexpr int RowSpanMin(int dy, int range) { return -(range - (dy < 0 ? -dy : dy)); }
+	static constexpr int RowSpanMax(int dy, int range) { return range - (dy < 0 ? -dy : dy); }
+};
+
+/*
+	Square cells joined at their edges and corners (edges as SquareGrid4, then 4 = NE, 5 = SE, 6 = SW, 7 = NW).
+	Diagonal steps cost DIAGONAL_COST / MOVE_COST_SCALE (~sqrt 2) times the cell cost, with the matching octile
+	distance. Range shapes are squares.
+*/
+struct SquareGrid8
+{
+	static constexpr int NEIGHBOUR_COUNT = 8;
+	static constexpr int DX[NEIGHBOUR_COUNT] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+	static constexpr int DY[NEIGHBOUR_COUNT] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+	//Diagonal multiplier in tenths, matching NavGrid::MOVE_COST_SCALE
+	static constexpr int DIAGONAL_COST = 14;
+
+	static constexpr int Offset(int direction, int stride) { return DY[direction] * stride + DX[direction]; }
+	static constexpr int DiagonalCost(int cellCost) { return (cellCost * DIAGONAL_COST + 5) / 10; }
+	static constexpr int StepCost(int direction, int cellCost) { return direction < 4 ? cellCost : DiagonalCost(cellCost); }
+	static constexpr int MaxStepCost(int cellCost) { return DiagonalCost(cellCost); }
+	//Octile distance (diagonal steps for the shorter axis, straight steps for the rest)
+	static int Distance(int dx, int dy, int minCost)
+	{
+		int ax = std::abs(dx);
+		int ay = std::abs(dy);
+		int diagonals = ax < ay ? ax : ay;
+		int straights = (ax < ay ? ay : ax) - diagonals;
+		return diagonals * DiagonalCost(minCost) + straights * minCost;
+	}
+
+	static constexpr int RowSpanMin(int, int range) { return -range; }
+	static constexpr int RowSpanMax(int, int range) { return range; }
+};
+
+/*
+	Hex cells in axial coordinates, x being q and y being r (stored row major, so the map is a rhombus).
+	0 = NE, 1 = E, 2 = SE, 3 = SW, 4 = W, 5 = NW. Hex distance, with hexagonal range shapes.
+*/
+struct HexAxialGrid
+{
+	static constexpr int NEIGHBOUR_COUNT = 6;
+	static constexpr int DX[NEIGHBOUR_COUNT] = { 1, 1, 0, -1, -1, 0 };
+	static constexpr int DY[NEIGHBOUR_COUNT] = { -1, 0, 1, 1, 0, -1 };
+
+	static constexpr int Offset(int direction, int stride) { return DY[direction] * stride + DX[direction]; }
+	static constexpr int StepCost(int, int cellCost) { return cellCost; }
+	static constexpr int MaxStepCost(int cellCost) { return cellCost; }
+	static int Distance(int dx, int dy, int minCost) { return ((std::abs(dx) + std::abs(dy) + std::abs(dx + dy)) / 2) * minCost; }
+
+	static constexpr int RowSpanMin(int dy, int range) { return dy < 0 ? -range - dy : -range; }
+	static constexpr int RowSpanMax(int dy, int range) { return dy < 0 ? range : range - dy; }
+};
+
+namespace GridTopologyDetail
+{
+	template<typename Func, int... Directions>
+	inline void ForEachDirection(Func& func, std::integer_sequence<int, Directions...>)
+	{
+		(func(std::integral_constant<int, Directions>()), ...);
+	}
+}
+
+/*
+	Calls func once per direction of the topology, fully unrolled. The direction is passed as a
+	std::integral_constant, so per direction lookups (offsets, step costs) fold to constants.
+	Use return in place of continue to skip to the next direction.
+*/
+template<typename Topology, typename Func>
+inline void ForEachDirection(Func&& func)
+{
+	GridTopologyDetail::ForEachDirection(func, std::make_integer_sequence<int, Topology::NEIGHBOUR_COUNT>());
+}
@@ -0,0 +1,496 @@
+#include "HierarchicalPathfinder.h"
+#include "ConnectivityMap.h"
+
+#include <algorithm>	//std::min, std::fill, std::reverse
+#include <cstdlib>		//std::abs
+#include <type_traits>	//std::is_same
+
+//Entrances are placed along the four cluster sides, so only edge connected square grids are supported
+static_assert(std::is_same<NavGrid::Topology, SquareGrid4>::value, "HierarchicalPathfinder requires a SquareGrid4 nav grid");
+
+int HierarchicalPathfinder::GetNodeCount(int unitType) const
+{
+	int count = 0;
+	for (auto& c : m_Graphs[unitType].clusters)
+		count += static_cast<int>(c.nodeCells.size());
+	return count;
+}
+
+void HierarchicalPathfinder::Build(NavGrid& grid, int unitTypeCount, int clusterSize)
+{
+	Release();
+
+	m_Grid = &grid;
+	m_ClusterSize = clusterSize;
+	m_ClustersX = (grid.GetWidth() + clusterSize - 1) / clusterSize;
+	m_ClustersY = (grid.GetHeight() + clusterSize - 1) / clusterSize;
+	int clusterCount = m_ClustersX * m_ClustersY;
+
+	m_Graphs.resize(unitTypeCount);
+	for (auto& g : m_Graphs)
+	{
+		g.clusters.assign(clusterCount, Cluster());
+		g.nodeSlots.assign(grid.GetCellCount(), -1);
+	}
+
+	m_ClusterDirtyFlags.assign(clusterCount, 0);
+	m_DirtyClusters.clear();
+
+	//Size the cluster search scratch
+	int localCount = clusterSize * clusterSize;
+	m_ClusterDistances.resize(localCount);
+	m_ClusterParents.resize(localCount);
+	m_ClusterOpenList.Resize(localCount);
+
+	for (int i(0); i < clusterCount; ++i)
+		BuildCluster(i);
+
+	grid.AddListener(this);
+}
+
+void HierarchicalPathfinder::Release()
+{
+	if (m_Grid)
+		m_Grid->RemoveListener(this);
+
+	m_Grid = nullptr;
+	m_Graphs.clear();
+	m_DirtyClusters.clear();
+	m_ClusterDirtyFlags.clear();
+	m_Waypoints.clear();
+	m_RefinedPath.clear();
+}
+
+void HierarchicalPathfinder::UpdateDirtyClusters()
+{
+	for (int cluster : m_DirtyClusters)
+	{
+		BuildCluster(cluster);
+		m_ClusterDirtyFlags[cluster] = 0;
+	}
+	m_DirtyClusters.clear();
+}
+
+PathResult HierarchicalPathfinder::FindAbstractPath(const PathQuery& query, PathSearchArena& arena)
+{
+	m_Waypoints.clear();
+	m_RefinedPath.clear();
+
+	int cellCount = m_Grid ? m_Grid->GetCellCount() : 0;
+	if (query.unitType < 0 || query.unitType >= static_cast<int>(m_Graphs.size()) ||
+		query.startCell < 0 || query.startCell >= cellCount || m_Grid->IsBorder(query.startCell) ||
+		query.goalCell < 0 || query.goalCell >= cellCount || m_Grid->IsBorder(query.goalCell))
+		return PathResult();
+	if (query.goalCell != query.startCell && !m_Grid->CanEnter(query.goalCell, query.unitType))
+		return PathResult();
+	if (query.connectivity && !query.connectivity->MayBeReachable(query.startCell, query.goalCell, query.unitType))
+		return PathResult();
+
+	UpdateDirtyClusters();
+
+	const NavGrid& grid = *m_Grid;
+	UnitGraph& graph = m_Graphs[query.unitType];
+	m_PathUnitType = query.unitType;
+
+	int startCluster = GetClusterOfCell(query.startCell);
+	int goalCluster = GetClusterOfCell(query.goalCell);
+
+	//
+	//Join the goal to its clusters nodes
+	//
+
+	Cluster& goalNodes = graph.clusters[goalCluster];
+	RunClusterSearch(goalCluster, query.goalCell, query.unitType, true);
+	m_GoalCosts.resize(goalNodes.nodeCells.size());
+	for (size_t i(0); i < goalNodes.nodeCells.size(); ++i)
+		m_GoalCosts[i] = GetClusterDistance(goalNodes.nodeCells[i]);
+
+	//
+	//Join the start to the graph. The start is usually occupied by the moving unit, so it never forms an entrance
+	//itself, meaning any step it can take straight into a neighbouring cluster is joined here too.
+	//
+
+	m_StartEdges.clear();
+	int firstCost[NavGrid::NEIGHBOUR_COUNT + 1] = { 0 };
+	int sources[NavGrid::NEIGHBOUR_COUNT + 1] = { query.startCell };
+	int sourceCount = 1;
+	for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+	{
+		int neighbour = query.startCell + grid.GetNeighbourOffset(i);
+		if (grid.CanEnter(neighbour, query.unitType) && GetClusterOfCell(neighbour) != startCluster)
+		{
+			firstCost[sourceCount] = grid.GetMoveCost(neighbour);
+			sources[sourceCount++] = neighbour;
+		}
+	}
+	for (int s(0); s < sourceCount; ++s)
+	{
+		int cluster = GetClusterOfCell(sources[s]);
+		RunClusterSearch(cluster, sources[s], query.unitType, false);
+
+		for (int nodeCell : graph.clusters[cluster].nodeCells)
+		{
+			if (GetClusterDistance(nodeCell) != INT32_MAX)
+				m_StartEdges.push_back({ nodeCell, firstCost[s] + GetClusterDistance(nodeCell) });
+		}
+		//Direct route when the goal shares the cluster
+		if (cluster == goalCluster && GetClusterDistance(query.goalCell) != INT32_MAX)
+			m_StartEdges.push_back({ query.goalCell, firstCost[s] + GetClusterDistance(query.goalCell) });
+	}
+
+	//
+	//Abstract A*
+	//
+
+	arena.BeginQuery(cellCount);
+	IndexedMinHeap& openList = arena.GetOpenList();
+
+	int goalX = grid.GetCellX(query.goalCell);
+	int goalY = grid.GetCellY(query.goalCell);
+	int minMoveCost = query.minMoveCost < 0 ? grid.GetMinMoveCost() : query.minMoveCost;
+	auto heuristic = [&](int cell)
+	{
+		return static_cast<float>((std::abs(goalX - grid.GetCellX(cell)) + std::abs(goalY - grid.GetCellY(cell))) * minMoveCost);
+	};
+
+	//Relaxes one edge of the abstract graph
+	auto relax = [&](int fromCell, float fromG, int toCell, int cost)
+	{
+		if (arena.IsNodeClosed(toCell))
+			return;
+
+		float newG = fromG + cost;
+		if (newG > static_cast<float>(query.maxCost))
+			return;
+
+		if (!arena.IsNodeSeen(toCell))
+		{
+			float h = heuristic(toCell);
+			arena.OpenNode(toCell, newG, fromCell);
+			openList.Push(toCell, newG + h, h);
+		}
+		else if (newG < arena.GetGCost(toCell))
+		{
+			float h = heuristic(toCell);
+			arena.OpenNode(toCell, newG, fromCell);
+			openList.DecreaseKey(toCell, newG + h, h);
+		}
+	};
+
+	float startH = heuristic(query.startCell);
+	arena.OpenNode(query.startCell, 0.f, -1);
+	openList.Push(query.startCell, startH, startH);
+
+	while (!openList.IsEmpty())
+	{
+		int currentCell = openList.Pop();
+		arena.CloseNode(currentCell);
+
+		if (currentCell == query.goalCell)
+		{
+			//Hold on to the waypoints for refinement, as the arena may be reused before then
+			PathResult result = arena.BuildResult(currentCell);
+			m_Waypoints.assign(result.begin(), result.end());
+			result.cells = m_Waypoints.data();
+			return result;
+		}
+
+		float currentG = arena.GetGCost(currentCell);
+
+		//The start uses its temporary edges, anything else is an entrance node
+		if (currentCell == query.startCell)
+		{
+			for (auto& e : m_StartEdges)
+				relax(currentCell, currentG, e.toCell, e.cost);
+			continue;
+		}
+
+		int cluster = GetClusterOfCell(currentCell);
+		int slot = graph.nodeSlots[currentCell];
+		for (auto& e : graph.clusters[cluster].edges[slot])
+			relax(currentCell, currentG, e.toCell, e.cost);
+
+		if (cluster == goalCluster && m_GoalCosts[slot] != INT32_MAX)
+			relax(currentCell, currentG, query.goalCell, m_GoalCosts[slot]);
+	}
+
+	return PathResult();
+}
+
+PathResult HierarchicalPathfinder::RefinePath(int maxCells)
+{
+	m_RefinedPath.clear();
+	if (m_Waypoints.empty() || !m_Grid)
+		return PathResult();
+
+	m_RefinedPath.push_back(m_Waypoints[0]);
+	for (size_t i(1); i < m_Waypoints.size(); ++i)
+	{
+		if (maxCells >= 0 && static_cast<int>(m_RefinedPath.size()) - 1 >= maxCells)
+			break;
+		if (!RefineSegment(m_Waypoints[i - 1], m_Waypoints[i]))
+			return PathResult();
+	}
+
+	PathResult result;
+	result.cells = m_RefinedPath.data();
+	result.length = static_cast<int>(m_RefinedPath.size());
+	return result;
+}
+
+void HierarchicalPathfinder::OnCellChanged(const NavGrid& grid, int cell)
+{
+	int x = grid.GetCellX(cell);
+	int y = grid.GetCellY(cell);
+	int cx = x / m_ClusterSize;
+	int cy = y / m_ClusterSize;
+
+	MarkClusterDirty(cy * m_ClustersX + cx);
+
+	//Cells on a cluster edge also decide the entrances of the cluster across that edge
+	if (x % m_ClusterSize == 0 && cx > 0)
+		MarkClusterDirty(cy * m_ClustersX + cx - 1);
+	if ((x % m_ClusterSize == m_ClusterSize - 1) && cx < m_ClustersX - 1)
+		MarkClusterDirty(cy * m_ClustersX + cx + 1);
+	if (y % m_ClusterSize == 0 && cy > 0)
+		MarkClusterDirty((cy - 1) * m_ClustersX + cx);
+	if ((y % m_ClusterSize == m_ClusterSize - 1) && cy < m_ClustersY - 1)
+		MarkClusterDirty((cy + 1) * m_ClustersX + cx);
+}
+
+void HierarchicalPathfinder::BuildCluster(int cluster)
+{
+	for (int unitType(0); unitType < static_cast<int>(m_Graphs.size()); ++unitType)
+	{
+		UnitGraph& graph = m_Graphs[unitType];
+		Cluster& c = graph.clusters[cluster];
+
+		//Drop the old nodes
+		for (int cell : c.nodeCells)
+			graph.nodeSlots[cell] = -1;
+		c.nodeCells.clear();
+		c.edges.clear();
+
+		//Place entrances (and their edges across the border) along each side
+		for (int side(0); side < NavGrid::NEIGHBOUR_COUNT; ++side)
+			BuildEntrances(graph, cluster, side, unitType);
+
+		//Find the cheapest in-cluster route between each pair of entrances
+		for (size_t i(0); i < c.nodeCells.size(); ++i)
+		{
+			RunClusterSearch(cluster, c.nodeCells[i], unitType, false);
+			for (size_t j(0); j < c.nodeCells.size(); ++j)
+			{
+				int distance = GetClusterDistance(c.nodeCells[j]);
+				if (i != j && distance != INT32_MAX)
+					c.edges[i].push_back({ c.nodeCells[j], distance });
+			}
+		}
+	}
+}
+
+void HierarchicalPathfinder::BuildEntrances(UnitGraph& graph, int cluster, int side, int unitType)
+{
+	const NavGrid& grid = *m_Grid;
+
+	int x0, y0, x1, y1;
+	GetClusterBounds(cluster, x0, y0, x1, y1);
+
+	//Walk along the chosen edge, with the matching cell across the border
+	int insideStart, length, step;
+	switch (side)
+	{
+	case 0:		//North
+		if (y0 == 0) return;
+		insideStart = grid.CoordsToCell(x0, y0); length = x1 - x0 + 1; step = 1;
+		break;
+	case 1:		//East
+		if (x1 == grid.GetWidth() - 1) return;
+		insideStart = grid.CoordsToCell(x1, y0); length = y1 - y0 + 1; step = grid.GetStride();
+		break;
+	case 2:		//South
+		if (y1 == grid.GetHeight() - 1) return;
+		insideStart = grid.CoordsToCell(x0, y1); length = x1 - x0 + 1; step = 1;
+		break;
+	default:	//West
+		if (x0 == 0) return;
+		insideStart = grid.CoordsToCell(x0, y0); length = y1 - y0 + 1; step = grid.GetStride();
+		break;
+	}
+	int across = grid.GetNeighbourOffset(side);
+
+	//Adds a transition at a position along the edge
+	auto addTransition = [&](int position)
+	{
+		int inside = insideStart + position * step;
+		int slot = AddNode(graph, cluster, inside);
+		graph.clusters[cluster].edges[slot].push_back({ inside + across, grid.GetMoveCost(inside + across) });
+	};
+
+	//Find each run of cells crossable from both sides. Runs are scanned in the same order from either side of
+	//the border, so both clusters agree on where the transitions sit.
+	int runStart = -1;
+	for (int i(0); i <= length; ++i)
+	{
+		int inside = insideStart + i * step;
+		bool open = i < length && grid.CanEnter(inside, unitType) && grid.CanEnter(inside + across, unitType);
+
+		if (open && runStart < 0)
+			runStart = i;
+		else if (!open && runStart >= 0)
+		{
+			int runLength = i - runStart;
+			if (runLength >= LONG_ENTRANCE_LENGTH)
+			{
+				addTransition(runStart);
+				addTransition(i - 1);
+			}
+			else
+			{
+				addTransition(runStart + runLength / 2);
+			}
+			runStart = -1;
+		}
+	}
+}
+
+int HierarchicalPathfinder::AddNode(UnitGraph& graph, int cluster, int cell)
+{
+	if (graph.nodeSlots[cell] >= 0)
+		return graph.nodeSlots[cell];
+
+	Cluster& c = graph.clusters[cluster];
+	int slot = static_cast<int>(c.nodeCells.size());
+	c.nodeCells.push_back(cell);
+	c.edges.emplace_back();
+	graph.nodeSlots[cell] = static_cast<int16_t>(slot);
+	return slot;
+}
+
+void HierarchicalPathfinder::MarkClusterDirty(int cluster)
+{
+	if (!m_ClusterDirtyFlags[cluster])
+	{
+		m_ClusterDirtyFlags[cluster] = 1;
+		m_DirtyClusters.push_back(cluster);
+	}
+}
+
+void HierarchicalPathfinder::GetClusterBounds(int cluster, int& x0, int& y0, int& x1, int& y1) const
+{
+	x0 = (cluster % m_ClustersX) * m_ClusterSize;
+	y0 = (cluster / m_ClustersX) * m_ClusterSize;
+	x1 = std::min(x0 + m_ClusterSize, m_Grid->GetWidth()) - 1;
+	y1 = std::min(y0 + m_ClusterSize, m_Grid->GetHeight()) - 1;
+}
+
+int HierarchicalPathfinder::ToClusterLocal(int cell) const
+{
+	int x0 = (m_SearchCluster % m_ClustersX) * m_ClusterSize;
+	int y0 = (m_SearchCluster / m_ClustersX) * m_ClusterSize;
+	return (m_Grid->GetCellX(cell) - x0) + (m_Grid->GetCellY(cell) - y0) * m_ClusterSize;
+}
+
+void HierarchicalPathfinder::RunClusterSearch(int cluster, int sourceCell, int unitType, bool reverse, int targetCell)
+{
+	const NavGrid& grid = *m_Grid;
+
+	m_SearchCluster = cluster;
+	std::fill(m_ClusterDistances.begin(), m_ClusterDistances.end(), INT32_MAX);
+	m_ClusterOpenList.Clear();
+
+	int x0, y0, x1, y1;
+	GetClusterBounds(cluster, x0, y0, x1, y1);
+
+	int sourceLocal = ToClusterLocal(sourceCell);
+	m_ClusterDistances[sourceLocal] = 0;
+	m_ClusterParents[sourceLocal] = -1;
+	m_ClusterOpenList.Push(sourceLocal, 0.f, 0.f);
+
+	while (!m_ClusterOpenList.IsEmpty())
+	{
+		int local = m_ClusterOpenList.Pop();
+		int lx = local % m_ClusterSize;
+		int ly = local / m_ClusterSize;
+		int cell = grid.CoordsToCell(x0 + lx, y0 + ly);
+		if (cell == targetCell)
+			return;
+
+		for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+		{
+			int neighbour = cell + grid.GetNeighbourOffset(i);
+			int nx = grid.GetCellX(neighbour);
+			int ny = grid.GetCellY(neighbour);
+
+			//Stay inside the cluster
+			if (nx < x0 || nx > x1 || ny < y0 || ny > y1 || !grid.CanEnter(neighbour, unitType))
+				continue;
+
+			//Forward pays to enter the neighbour, reverse pays to enter the current cell from the neighbour
+			int newDistance = m_ClusterDistances[local] + (reverse ? grid.GetMoveCost(cell) : grid.GetMoveCost(neighbour));
+			int neighbourLocal = (nx - x0) + (ny - y0) * m_ClusterSize;
+			if (newDistance >= m_ClusterDistances[neighbourLocal])
+				continue;
+
+			bool queued = m_ClusterDistances[neighbourLocal] != INT32_MAX;
+			m_ClusterDistances[neighbourLocal] = newDistance;
+			m_ClusterParents[neighbourLocal] = local;
+			if (queued)
+				m_ClusterOpenList.DecreaseKey(neighbourLocal, static_cast<float>(newDistance), 0.f);
+			else
+				m_ClusterOpenList.Push(neighbourLocal, static_cast<float>(newDistance), 0.f);
+		}
+	}
+}
+
+bool HierarchicalPathfinder::RefineSegment(int fromCell, int toCell)
+{
+	const NavGrid& grid = *m_Grid;
+	int toCluster = GetClusterOfCell(toCell);
+
+	//Find where the segment enters the target cluster (either already inside it, or one step across the border)
+	int entryCell = -1;
+	int bestCost = INT32_MAX;
+	if (GetClusterOfCell(fromCell) == toCluster)
+	{
+		entryCell = fromCell;
+	}
+	else
+	{
+		for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+		{
+			int neighbour = fromCell + grid.GetNeighbourOffset(i);
+			if (!grid.CanEnter(neighbour, m_PathUnitType) || GetClusterOfCell(neighbour) != toCluster)
+				continue;
+
+			RunClusterSearch(toCluster, neighbour, m_PathUnitType, false, toCell);
+			int cost = GetClusterDistance(toCell);
+			if (cost != INT32_MAX && cost + grid.GetMoveCost(neighbour) < bestCost)
+			{
+				bestCost = cost + grid.GetMoveCost(neighbour);
+				entryCell = neighbour;
+			}
+		}
+		if (entryCell < 0)
+			return false;
+		m_RefinedPath.push_back(entryCell);
+	}
+
+	if (entryCell == toCell)
+		return true;
+
+	//Walk the in-cluster route back from the target
+	RunClusterSearch(toCluster, entryCell, m_PathUnitType, false, toCell);
+	if (GetClusterDistance(toCell) == INT32_MAX)
+		return false;
+
+	int x0, y0, x1, y1;
+	GetClusterBounds(toCluster, x0, y0, x1, y1);
+
+	m_SegmentScratch.clear();
+	for (int local = ToClusterLocal(toCell); local != ToClusterLocal(entryCell); local = m_ClusterParents[local])
+		m_SegmentScratch.push_back(grid.CoordsToCell(x0 + local % m_ClusterSize, y0 + local / m_ClusterSize));
+
+	m_RefinedPath.insert(m_RefinedPath.end(), m_SegmentScratch.rbegin(), m_SegmentScratch.rend());
+	return true;
+}
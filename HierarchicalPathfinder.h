@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "NavGrid.h"					//Searched grid
+#include "PathfindingContainers.h"		//Cluster search heap
+#include "PathQuery.h"					//Query/result types
+
+/*
+	Hierarchical pathfinder (HPA*) for long range queries on large maps.
+
+	The grid is partitioned into square clusters. Wherever two neighbouring clusters can be crossed between,
+	entrance nodes are placed on each side, and the cheapest in-cluster routes between the entrances of a cluster
+	are precomputed. This gives a small abstract graph (one per unit type) that is searched in place of the grid,
+	with the result only refined into cells as far ahead as the caller needs.
+
+	Paths found are near optimal rather than optimal, as routes are forced through entrance nodes.
+
+	Registers with the grid to be told of cell changes, marking only the clusters a change can affect as dirty.
+	Dirty clusters are rebuilt before the next search (or on calling UpdateDirtyClusters).
+	Queries share the pathfinders scratch buffers, so only one query can be in flight per pathfinder.
+*/
+class HierarchicalPathfinder : public NavGridListenerInterface
+{
+public:
+
+	static constexpr int DEFAULT_CLUSTER_SIZE = 16;
+	//Crossable border runs at least this long get an entrance at each end, rather than one in the middle
+	static constexpr int LONG_ENTRANCE_LENGTH = 6;
+
+	HierarchicalPathfinder() {}
+	~HierarchicalPathfinder() { Release(); }
+
+	///////////
+	/// Get ///
+	///////////
+
+	int GetClusterSize() const { return m_ClusterSize; }
+	int GetClusterCountX() const { return m_ClustersX; }
+	int GetClusterCountY() const { return m_ClustersY; }
+	//Number of entrance nodes in the abstract graph for a unit type
+	int GetNodeCount(int unitType) const;
+	//Cluster index that a cell belongs to
+	int GetClusterOfCell(int cell) const
+	{
+		return (m_Grid->GetCellY(cell) / m_ClusterSize) * m_ClustersX + m_Grid->GetCellX(cell) / m_ClusterSize;
+	}
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Partitions the grid and builds the abstract graphs for unit types 0 to unitTypeCount - 1
+	void Build(NavGrid& grid, int unitTypeCount, int clusterSize = DEFAULT_CLUSTER_SIZE);
+	//Stops listening to the grid and releases the graphs
+	void Release();
+
+	//Rebuilds any clusters affected by cell changes since the last update
+	void UpdateDirtyClusters();
+
+	/*
+		Finds the abstract path for the query, returning its waypoints (start, entrance nodes, goal) and its
+		total cost. The waypoints stay valid until the next abstract search.
+	*/
+	PathResult FindAbstractPath(const PathQuery& query, PathSearchArena& arena = PathSearchArena::GetThreadArena());
+	/*
+		Refines the last abstract path into cells, stopping once at least maxCells cells past the start have been
+		found (-1 refines the whole path). Result runs from the start cell and stays valid until the next refinement.
+	*/
+	PathResult RefinePath(int maxCells = -1);
+
+	/////////////////
+	/// Overrides ///
+	/////////////////
+
+	void OnCellChanged(const NavGrid& grid, int cell) override;
+
+private:
+
+	struct Edge
+	{
+		int toCell;
+		int cost;
+	};
+
+	struct Cluster
+	{
+		//Entrance node cells, with the outgoing edges of each
+		std::vector<int> nodeCells;
+		std::vector<std::vector<Edge>> edges;
+	};
+
+	struct UnitGraph
+	{
+		std::vector<Cluster> clusters;
+		//Slot of each cell in its clusters node list (-1 if not a node)
+		std::vector<int16_t> nodeSlots;
+	};
+
+	//////////////////////
+	/// Graph Building ///
+	//////////////////////
+
+	//Rebuilds the entrances and edges of a cluster for every unit type
+	void BuildCluster(int cluster);
+	//Places entrance nodes along one side (0 = North, 1 = East, 2 = South, 3 = West) of a cluster
+	void BuildEntrances(UnitGraph& graph, int cluster, int side, int unitType);
+	//Adds a node to a cluster (if not already present), returning its slot
+	int AddNode(UnitGraph& graph, int cluster, int cell);
+	void MarkClusterDirty(int cluster);
+
+	////////////////////////
+	/// Cluster Searches ///
+	////////////////////////
+
+	//Cell bounds of a cluster (inclusive)
+	void GetClusterBounds(int cluster, int& x0, int& y0, int& x1, int& y1) const;
+	/*
+		Dijkstra from a cell, limited to the cells of one cluster. Forward finds the cost from the source to each
+		cell, reverse finds the cost from each cell to the source. Stops early once the target (if any) is settled.
+	*/
+	void RunClusterSearch(int cluster, int sourceCell, int unitType, bool reverse, int targetCell = -1);
+	//Results of the last cluster search by cell (INT32_MAX if not reached)
+	int GetClusterDistance(int cell) const { return m_ClusterDistances[ToClusterLocal(cell)]; }
+	int ToClusterLocal(int cell) const;
+
+	//Appends the refined cells from one waypoint to the next onto the refined path
+	bool RefineSegment(int fromCell, int toCell);
+
+	////////////
+	/// Data ///
+	////////////
+
+	NavGrid* m_Grid = nullptr;
+	int m_ClusterSize = DEFAULT_CLUSTER_SIZE;
+	int m_ClustersX = 0;
+	int m_ClustersY = 0;
+
+	//One abstract graph per unit type
+	std::vector<UnitGraph> m_Graphs;
+
+	//Clusters awaiting a rebuild
+	std::vector<int> m_DirtyClusters;
+	std::vector<uint8_t> m_ClusterDirtyFlags;
+
+	//Cluster search scratch (indexed by cell position within the cluster)
+	int m_SearchCluster = -1;
+	std::vector<int> m_ClusterDistances;
+	std::vector<int> m_ClusterParents;
+	IndexedMinHeap m_ClusterOpenList;
+
+	//Temporary edges joining the start and goal of a query to the abstract graph
+	std::vector<Edge> m_StartEdges;
+	std::vector<int> m_GoalCosts;
+
+	//Last abstract path and its refinement
+	int m_PathUnitType = 0;
+	std::vector<int> m_Waypoints;
+	std::vector<int> m_RefinedPath;
+	std::vector<int> m_SegmentScratch;
+};
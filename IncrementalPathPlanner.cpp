@@ -0,0 +1,267 @@
+#include "IncrementalPathPlanner.h"
+
+#include <algorithm>	//std::min, std::fill
+#include <limits>		//Infinity
+
+namespace
+{
+	const float INFINITE_COST = std::numeric_limits<float>::infinity();
+}
+
+float IncrementalPathPlanner::GetDistanceToGoal(int cell) const
+{
+	if (m_GCosts[cell] == INFINITE_COST)
+		return -1.f;
+	return m_GCosts[cell] / NavGrid::MOVE_COST_SCALE;
+}
+
+void IncrementalPathPlanner::Initialise(NavGrid& grid, int unitType, const std::vector<int>& goalCells)
+{
+	Release();
+
+	m_Grid = &grid;
+	m_UnitType = unitType;
+	m_StartCell = -1;
+
+	int cellCount = grid.GetCellCount();
+	m_GCosts.resize(cellCount);
+	m_RhsCosts.resize(cellCount);
+	m_GoalSet.Resize(cellCount);
+	m_OpenList.Resize(cellCount);
+	m_PathBuffer.reserve(cellCount);
+
+	SetGoals(goalCells);
+	grid.AddListener(this);
+}
+
+void IncrementalPathPlanner::Release()
+{
+	if (m_Grid)
+		m_Grid->RemoveListener(this);
+	m_Grid = nullptr;
+}
+
+void IncrementalPathPlanner::SetGoals(const std::vector<int>& goalCells)
+{
+	for (int cell : m_GoalCells)
+		m_GoalSet.Reset(cell);
+	m_GoalCells = goalCells;
+	for (int cell : m_GoalCells)
+		m_GoalSet.Set(cell);
+
+	ResetSearch();
+}
+
+void IncrementalPathPlanner::SetStart(int startCell)
+{
+	if (startCell == m_StartCell)
+		return;
+
+	//Dropping the start leaves queued keys above their heuristic free values, so start over
+	if (startCell < 0)
+	{
+		m_StartCell = -1;
+		ResetSearch();
+		return;
+	}
+
+	//Moving the start shifts every heuristic by at most the distance moved, so offset new keys by that instead of requeuing
+	if (m_StartCell >= 0)
+	{
+		m_KeyModifier += static_cast<float>(NavGrid::Topology::Distance(m_Grid->GetCellX(startCell) - m_Grid->GetCellX(m_StartCell),
+			m_Grid->GetCellY(startCell) - m_Grid->GetCellY(m_StartCell), m_HeuristicCost));
+	}
+	m_StartCell = startCell;
+}
+
+void IncrementalPathPlanner::Replan()
+{
+	m_ExpansionCount = 0;
+	if (!m_Grid)
+		return;
+
+	//A cheaper cell than the heuristic assumed makes the old keys invalid
+	if (m_Grid->GetMinMoveCost() < m_HeuristicCost)
+		ResetSearch();
+
+	while (!m_OpenList.IsEmpty())
+	{
+		if (m_StartCell >= 0 && IsStartSettled())
+			break;
+
+		int cell = m_OpenList.GetTop();
+		float key, tieBreak;
+		CalculateKey(cell, key, tieBreak);
+
+		//Key was out of date (the start has moved since it was queued), so requeue it
+		if (m_OpenList.GetTopKey() < key || (m_OpenList.GetTopKey() == key && m_OpenList.GetTopTieBreak() < tieBreak))
+		{
+			m_OpenList.UpdateKey(cell, key, tieBreak);
+			continue;
+		}
+
+		++m_ExpansionCount;
+
+		//Overconsistent, so the cell has found a cheaper route
+		if (m_GCosts[cell] > m_RhsCosts[cell])
+		{
+			m_GCosts[cell] = m_RhsCosts[cell];
+			m_OpenList.Remove(cell);
+		}
+		//Underconsistent, so its old route has become more expensive
+		else
+		{
+			m_GCosts[cell] = INFINITE_COST;
+			UpdateCell(cell);
+		}
+
+		//Cells that can't be entered don't offer a route to anything
+		if (m_Grid->CanEnter(cell, m_UnitType))
+			UpdatePredecessors(cell);
+	}
+}
+
+PathResult IncrementalPathPlanner::GetPath()
+{
+	m_PathBuffer.clear();
+	if (m_StartCell < 0 || m_GCosts[m_StartCell] == INFINITE_COST)
+		return PathResult();
+
+	const NavGrid& grid = *m_Grid;
+
+	//Step downhill through the field till a goal is reached
+	int cell = m_StartCell;
+	m_PathBuffer.push_back(cell);
+	while (!m_GoalSet.Test(cell))
+	{
+		int bestCell = -1;
+		float bestCost = INFINITE_COST;
+		for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+		{
+			int neighbour = cell + grid.GetNeighbourOffset(i);
+			if (!grid.CanEnter(neighbour, m_UnitType))
+				continue;
+
+			float cost = NavGrid::Topology::StepCost(i, grid.GetMoveCost(neighbour)) + m_GCosts[neighbour];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestCell = neighbour;
+			}
+		}
+
+		//Dead end, or the field has looped (shouldn't happen once replanned)
+		if (bestCell < 0 || static_cast<int>(m_PathBuffer.size()) >= grid.GetCellCount())
+		{
+			m_PathBuffer.clear();
+			return PathResult();
+		}
+
+		cell = bestCell;
+		m_PathBuffer.push_back(cell);
+	}
+
+	PathResult result;
+	result.cells = m_PathBuffer.data();
+	result.length = static_cast<int>(m_PathBuffer.size());
+	result.cost = m_GCosts[m_StartCell] / NavGrid::MOVE_COST_SCALE;
+	return result;
+}
+
+void IncrementalPathPlanner::OnCellChanged(const NavGrid&, int cell)
+{
+	//The cost of stepping onto the cell has changed, so everything next to it needs another look
+	if (!m_GCosts.empty())
+		UpdatePredecessors(cell);
+}
+
+void IncrementalPathPlanner::ResetSearch()
+{
+	if (!m_Grid)
+		return;
+
+	std::fill(m_GCosts.begin(), m_GCosts.end(), INFINITE_COST);
+	std::fill(m_RhsCosts.begin(), m_RhsCosts.end(), INFINITE_COST);
+	m_OpenList.Clear();
+	m_KeyModifier = 0.f;
+	m_HeuristicCost = m_Grid->GetMinMoveCost();
+
+	//Search outwards from the goals
+	for (int cell : m_GoalCells)
+	{
+		m_RhsCosts[cell] = 0.f;
+		if (!m_OpenList.Contains(cell))
+		{
+			float key, tieBreak;
+			CalculateKey(cell, key, tieBreak);
+			m_OpenList.Push(cell, key, tieBreak);
+		}
+	}
+}
+
+float IncrementalPathPlanner::CalculateHeuristic(int cell) const
+{
+	if (m_StartCell < 0)
+		return 0.f;
+
+	return static_cast<float>(NavGrid::Topology::Distance(m_Grid->GetCellX(cell) - m_Grid->GetCellX(m_StartCell),
+		m_Grid->GetCellY(cell) - m_Grid->GetCellY(m_StartCell), m_HeuristicCost));
+}
+
+void IncrementalPathPlanner::CalculateKey(int cell, float& key, float& tieBreak) const
+{
+	tieBreak = std::min(m_GCosts[cell], m_RhsCosts[cell]);
+	key = tieBreak + CalculateHeuristic(cell) + m_KeyModifier;
+}
+
+void IncrementalPathPlanner::UpdateCell(int cell)
+{
+	const NavGrid& grid = *m_Grid;
+	if (grid.IsBorder(cell))
+		return;
+
+	//Goals always cost nothing, anything else costs its cheapest step onto a neighbour plus that neighbours cost
+	if (!m_GoalSet.Test(cell))
+	{
+		float best = INFINITE_COST;
+		for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+		{
+			int neighbour = cell + grid.GetNeighbourOffset(i);
+			if (grid.CanEnter(neighbour, m_UnitType))
+				best = std::min(best, NavGrid::Topology::StepCost(i, grid.GetMoveCost(neighbour)) + m_GCosts[neighbour]);
+		}
+		m_RhsCosts[cell] = best;
+	}
+
+	//Queue the cell only while it is inconsistent
+	bool queued = m_OpenList.Contains(cell);
+	if (m_GCosts[cell] != m_RhsCosts[cell])
+	{
+		float key, tieBreak;
+		CalculateKey(cell, key, tieBreak);
+		if (queued)
+			m_OpenList.UpdateKey(cell, key, tieBreak);
+		else
+			m_OpenList.Push(cell, key, tieBreak);
+	}
+	else if (queued)
+	{
+		m_OpenList.Remove(cell);
+	}
+}
+
+void IncrementalPathPlanner::UpdatePredecessors(int cell)
+{
+	for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+		UpdateCell(cell + m_Grid->GetNeighbourOffset(i));
+}
+
+bool IncrementalPathPlanner::IsStartSettled() const
+{
+	if (m_GCosts[m_StartCell] != m_RhsCosts[m_StartCell])
+		return false;
+
+	float key, tieBreak;
+	CalculateKey(m_StartCell, key, tieBreak);
+	return m_OpenList.GetTopKey() > key || (m_OpenList.GetTopKey() == key && m_OpenList.GetTopTieBreak() >= tieBreak);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+
+#include "NavGrid.h"					//Searched grid
+#include "PathfindingContainers.h"		//Priority queue, goal set
+#include "PathQuery.h"					//Result type
+
+/*
+	Incremental planner (D* Lite) keeping a cost-to-goal field for one unit type and goal set up to date as the
+	grid changes. The search runs backwards from the goals, so when a handful of cells change occupancy or cost
+	only the part of the field those changes reach is repaired, rather than searching again from nothing.
+
+	With a start set, replanning only does the work needed to make the start's path correct (and the start can
+	move without losing the search so far). With no start set, the whole distance field is kept correct.
+
+	Registers with the grid for cell changes, which are queued into the search as they happen and repaired on
+	the next call to Replan.
+*/
+class IncrementalPathPlanner : public NavGridListenerInterface
+{
+public:
+
+	IncrementalPathPlanner() {}
+	~IncrementalPathPlanner() { Release(); }
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Cost from a cell to its nearest goal as of the last replan (negative if no goal can be reached)
+	float GetDistanceToGoal(int cell) const;
+	//Number of cells expanded by the last replan
+	int GetLastExpansionCount() const { return m_ExpansionCount; }
+	int GetStart() const { return m_StartCell; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Sets up the planner for a unit type (UnitEntity::UNIT_TYPE) and goal set, and starts listening to the grid
+	void Initialise(NavGrid& grid, int unitType, const std::vector<int>& goalCells);
+	//Stops listening to the grid and releases the search
+	void Release();
+
+	//Replaces the goal set (this restarts the search)
+	void SetGoals(const std::vector<int>& goalCells);
+	//Moves the start (as the unit moves), keeping the search so far. -1 plans the full distance field instead.
+	void SetStart(int startCell);
+
+	//Repairs the search after any changes
+	void Replan();
+	//Cheapest path from the start to its nearest goal, following the field. Valid until the next call.
+	PathResult GetPath();
+
+	/////////////////
+	/// Overrides ///
+	/////////////////
+
+	void OnCellChanged(const NavGrid& grid, int cell) override;
+
+private:
+
+	//Resets the search back to just the goals
+	void ResetSearch();
+
+	float CalculateHeuristic(int cell) const;
+	void CalculateKey(int cell, float& key, float& tieBreak) const;
+	//Recalculates the cells best cost through its neighbours, queuing it if inconsistent
+	void UpdateCell(int cell);
+	//Updates every cell that can step onto this one
+	void UpdatePredecessors(int cell);
+	//Is the top of the queue ahead of the start's key (or the queue empty)
+	bool IsStartSettled() const;
+
+	////////////
+	/// Data ///
+	////////////
+
+	NavGrid* m_Grid = nullptr;
+	int m_UnitType = 0;
+
+	std::vector<int> m_GoalCells;
+	TileBitset m_GoalSet;
+
+	int m_StartCell = -1;
+	//Heuristic offset built up as the start moves
+	float m_KeyModifier = 0.f;
+	//Cheapest move cost when the search began, the heuristic is only valid while nothing is cheaper
+	int m_HeuristicCost = 0;
+
+	//Current cost to goal per cell, and the one step lookahead cost
+	std::vector<float> m_GCosts;
+	std::vector<float> m_RhsCosts;
+	IndexedMinHeap m_OpenList;
+
+	int m_ExpansionCount = 0;
+	std::vector<int> m_PathBuffer;
+};
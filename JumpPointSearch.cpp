@@ -0,0 +1,306 @@
+#include "JumpPointSearch.h"
+
+#include <cstdlib>		//std::abs
+#include <algorithm>	//std::max, std::min
+
+namespace
+{
+	//Neighbour offset indexes, matching NavGrid::GetNeighbourOffset
+	enum DIRECTION
+	{
+		NORTH,
+		EAST,
+		SOUTH,
+		WEST
+	};
+
+	bool IsHorizontal(int direction) { return direction == EAST || direction == WEST; }
+
+	//Every enterable neighbour costs the same to enter as the cell itself
+	bool IsUniform(const NavGrid& grid, int unitType, int cell)
+	{
+		int moveCost = grid.GetMoveCost(cell);
+		for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+		{
+			int neighbour = cell + grid.GetNeighbourOffset(i);
+			if (grid.CanEnter(neighbour, unitType) && grid.GetMoveCost(neighbour) != moveCost)
+				return false;
+		}
+		return true;
+	}
+
+	/*
+		Has a neighbour to the given side that can only be reached cheapest by turning at this cell, as the
+		matching cell beside the previous cell in the run is blocked or costs something different.
+	*/
+	bool HasForcedNeighbour(const NavGrid& grid, int unitType, int cell, int direction, int side)
+	{
+		int offset = grid.GetNeighbourOffset(side);
+		int beside = cell - grid.GetNeighbourOffset(direction) + offset;
+		return grid.CanEnter(cell + offset, unitType) &&
+			(!grid.CanEnter(beside, unitType) || grid.GetMoveCost(beside) != grid.GetMoveCost(cell));
+	}
+
+	//Does a horizontal run stop on the (enterable) cell, whatever the goal
+	bool IsHorizontalJumpPoint(const NavGrid& grid, int unitType, int cell, int direction)
+	{
+		return !IsUniform(grid, unitType, cell) || HasForcedNeighbour(grid, unitType, cell, direction, NORTH) ||
+			HasForcedNeighbour(grid, unitType, cell, direction, SOUTH);
+	}
+
+	class JumpPointSearch
+	{
+	public:
+
+		JumpPointSearch(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena)
+			: m_Query(query), m_Grid(grid), m_Arena(arena), m_Table(*query.jumpPoints)
+		{
+			m_GoalX = grid.GetCellX(query.goalCell);
+			m_GoalY = grid.GetCellY(query.goalCell);
+			m_MinMoveCost = query.minMoveCost < 0 ? grid.GetMinMoveCost() : query.minMoveCost;
+		}
+
+		PathResult Run()
+		{
+			IndexedMinHeap& openList = m_Arena.GetOpenList();
+			float maxCost = static_cast<float>(m_Query.maxCost);
+
+			float startH = CalculateHeuristic(m_Query.startCell);
+			m_Arena.OpenNode(m_Query.startCell, 0.f, -1);
+			openList.Push(m_Query.startCell, startH, startH);
+
+			while (!openList.IsEmpty())
+			{
+				int currentCell = openList.Pop();
+				m_Arena.CloseNode(currentCell);
+
+				if (currentCell == m_Query.goalCell)
+					return m_Arena.BuildJumpResult(currentCell, m_Grid.GetStride());
+
+				float currentG = m_Arena.GetGCost(currentCell);
+				int directions = GetSuccessorDirections(currentCell);
+
+				for (int i(0); i < NavGrid::NEIGHBOUR_COUNT; ++i)
+				{
+					if (!(directions & (1 << i)))
+						continue;
+
+					int runCost = 0;
+					int jumpPoint = Jump(currentCell, i, runCost);
+					if (jumpPoint < 0 || m_Arena.IsNodeClosed(jumpPoint))
+						continue;
+
+					//Cost of the whole run (discard if over budget)
+					float newG = currentG + runCost;
+					if (newG > maxCost)
+						continue;
+
+					if (!m_Arena.IsNodeSeen(jumpPoint))
+					{
+						float newH = CalculateHeuristic(jumpPoint);
+						m_Arena.OpenNode(jumpPoint, newG, currentCell);
+						openList.Push(jumpPoint, newG + newH, newH);
+					}
+					else if (newG < m_Arena.GetGCost(jumpPoint))
+					{
+						float newH = CalculateHeuristic(jumpPoint);
+						m_Arena.OpenNode(jumpPoint, newG, currentCell);
+						openList.DecreaseKey(jumpPoint, newG + newH, newH);
+					}
+				}
+			}
+
+			return PathResult();
+		}
+
+	private:
+
+		float CalculateHeuristic(int cell) const
+		{
+			return static_cast<float>((std::abs(m_GoalX - m_Grid.GetCellX(cell)) + std::abs(m_GoalY - m_Grid.GetCellY(cell))) * m_MinMoveCost);
+		}
+
+		bool CanEnter(int cell) const { return m_Grid.CanEnter(cell, m_Query.unitType); }
+		int GetOffset(int direction) const { return m_Grid.GetNeighbourOffset(direction); }
+
+		bool IsUniform(int cell) const { return ::IsUniform(m_Grid, m_Query.unitType, cell); }
+		bool HasForcedNeighbour(int cell, int direction, int side) const
+		{
+			return ::HasForcedNeighbour(m_Grid, m_Query.unitType, cell, direction, side);
+		}
+
+		//Bit mask of the directions to jump in from a jump point, depending on how it was arrived at
+		int GetSuccessorDirections(int cell) const
+		{
+			int parent = m_Arena.GetParent(cell);
+
+			//Start cells and cells on a cost boundary get expanded in full
+			if (parent < 0 || !IsUniform(cell))
+				return 0xF;
+
+			int offset = cell - parent;
+			if (offset % m_Grid.GetStride() == 0)
+			{
+				//Vertical runs carry on, and branch off horizontally
+				int direction = offset > 0 ? SOUTH : NORTH;
+				return (1 << direction) | (1 << EAST) | (1 << WEST);
+			}
+
+			//Horizontal runs only carry on, unless forced to turn
+			int direction = offset > 0 ? EAST : WEST;
+			int directions = 1 << direction;
+			if (HasForcedNeighbour(cell, direction, NORTH))
+				directions |= 1 << NORTH;
+			if (HasForcedNeighbour(cell, direction, SOUTH))
+				directions |= 1 << SOUTH;
+			return directions;
+		}
+
+		/*
+			Looks a horizontal run up in the table, returning the jump point it reaches (-1 if none) and its steps.
+			The goal isn't in the table, so it ends the run early if it lies along it.
+		*/
+		int RunHorizontal(int cell, int direction, int& steps) const
+		{
+			int length = m_Table.GetRunLength(m_Query.unitType, cell, direction == EAST);
+			steps = std::abs(length);
+			if (m_Grid.GetCellY(cell) == m_GoalY)
+			{
+				int goalSteps = direction == EAST ? m_GoalX - m_Grid.GetCellX(cell) : m_Grid.GetCellX(cell) - m_GoalX;
+				if (goalSteps > 0 && goalSteps < steps)
+				{
+					steps = goalSteps;
+					return m_Query.goalCell;
+				}
+			}
+			return length > 0 ? cell + length * GetOffset(direction) : -1;
+		}
+
+		//Jumps from a cell in one direction, returning the jump point reached (-1 if none) and the cost of getting there
+		int Jump(int cell, int direction, int& runCost) const
+		{
+			int offset = GetOffset(direction);
+
+			//Every cell before the jump point is uniform, so the whole run costs the same per step as its first cell
+			if (IsHorizontal(direction))
+			{
+				int steps = 0;
+				int jumpPoint = RunHorizontal(cell, direction, steps);
+				if (jumpPoint >= 0)
+					runCost += steps * m_Grid.GetMoveCost(cell + offset);
+				return jumpPoint;
+			}
+
+			for (;;)
+			{
+				cell += offset;
+				if (!CanEnter(cell))
+					return -1;
+				runCost += m_Grid.GetMoveCost(cell);
+
+				//Stop at the goal, and at cost boundaries to expand them in full
+				if (cell == m_Query.goalCell || !IsUniform(cell))
+					return cell;
+
+				//Stop where the run has to turn to find the cheapest route
+				if (HasForcedNeighbour(cell, direction, EAST) || HasForcedNeighbour(cell, direction, WEST))
+					return cell;
+
+				//Also stop wherever a horizontal run off the cell leads somewhere
+				int steps = 0;
+				if (RunHorizontal(cell, EAST, steps) >= 0 || RunHorizontal(cell, WEST, steps) >= 0)
+					return cell;
+			}
+		}
+
+		const PathQuery& m_Query;
+		const NavGrid& m_Grid;
+		PathSearchArena& m_Arena;
+		const JumpPointTable& m_Table;
+
+		int m_GoalX = 0;
+		int m_GoalY = 0;
+		int m_MinMoveCost = 0;
+	};
+}
+
+PathResult RunJumpPointSearch(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena)
+{
+	return JumpPointSearch(query, grid, arena).Run();
+}
+
+bool JumpPointTable::Build(NavGrid& grid, int unitTypeCount)
+{
+	Release();
+	if (grid.GetStride() > INT16_MAX)
+		return false;
+
+	m_Grid = &grid;
+	m_CellCount = grid.GetCellCount();
+	grid.AddListener(this);
+
+	m_RunLengths.resize(unitTypeCount);
+	for (int unitType(0); unitType < unitTypeCount; ++unitType)
+	{
+		m_RunLengths[unitType].assign(static_cast<size_t>(m_CellCount) * 2, -1);
+		for (int y(0); y < grid.GetHeight(); ++y)
+			BuildRow(unitType, y);
+	}
+	return true;
+}
+
+void JumpPointTable::Release()
+{
+	if (m_Grid)
+		m_Grid->RemoveListener(this);
+	m_Grid = nullptr;
+	m_RunLengths.clear();
+	m_CellCount = 0;
+}
+
+void JumpPointTable::OnCellChanged(const NavGrid& grid, int cell)
+{
+	//A cell is a jump point depending on the cells around it, so only its row and the rows either side change
+	int y = grid.GetCellY(cell);
+	for (int unitType(0); unitType < GetUnitTypeCount(); ++unitType)
+		for (int row(std::max(y - 1, 0)); row <= std::min(y + 1, grid.GetHeight() - 1); ++row)
+			BuildRow(unitType, row);
+}
+
+void JumpPointTable::BuildRow(int unitType, int y)
+{
+	const NavGrid& grid = *m_Grid;
+	std::vector<int16_t>& lengths = m_RunLengths[unitType];
+
+	//Each cell's run is one step longer than its neighbours, unless that neighbour stops it
+	int first = grid.CoordsToCell(-NavGrid::BORDER_SIZE, y);
+	int last = first + grid.GetStride() - 1;
+	for (int cell(last); cell >= first; --cell)
+	{
+		int next = cell + 1;
+		int16_t& length = lengths[static_cast<size_t>(cell) * 2];
+		if (!grid.CanEnter(next, unitType))
+			length = -1;
+		else if (IsHorizontalJumpPoint(grid, unitType, next, EAST))
+			length = 1;
+		else
+		{
+			int16_t nextLength = lengths[static_cast<size_t>(next) * 2];
+			length = static_cast<int16_t>(nextLength > 0 ? nextLength + 1 : nextLength - 1);
+		}
+	}
+	for (int cell(first); cell <= last; ++cell)
+	{
+		int next = cell - 1;
+		int16_t& length = lengths[static_cast<size_t>(cell) * 2 + 1];
+		if (!grid.CanEnter(next, unitType))
+			length = -1;
+		else if (IsHorizontalJumpPoint(grid, unitType, next, WEST))
+			length = 1;
+		else
+		{
+			int16_t nextLength = lengths[static_cast<size_t>(next) * 2 + 1];
+			length = static_cast<int16_t>(nextLength > 0 ? nextLength + 1 : nextLength - 1);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "NavGrid.h"		//Searched grid
+#include "PathQuery.h"		//Query/result types, arena
+
+/*
+	Jump point search for the 4-connected nav grid, run through RunPathQuery with PATH_SEARCH_METHOD::JUMP_POINT.
+
+	Within a patch of cells sharing one move cost, many equally cheap paths exist between two cells, so only one
+	ordering of them is searched (vertical runs, with horizontal runs branching off them). Rather than opening
+	every cell along a run, the search jumps straight down it, only stopping on cells where that ordering could
+	miss a cheaper path: next to blocked cells, next to the goal, or next to a change in move cost. Cells at cost
+	boundaries are expanded in every direction just like A*, so the path cost found is always the same.
+
+	Vertical runs stop on any cell a horizontal run leads somewhere from, so the horizontal runs are looked up in
+	the querys JumpPointTable rather than stepped along (see PathQuery::jumpPoints).
+
+	The arena must have been prepared with BeginQuery and the query validated by the caller.
+*/
+PathResult RunJumpPointSearch(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena);
+
+/*
+	Precomputed horizontal runs for jump point search (as JPS+ precomputes its jumps). For each unit type and cell,
+	holds how many steps a run east or west takes to reach a jump point, or the first cell it can't enter if it
+	finds none. Only jump points set by the grid are held, a querys goal is checked against the run as it's used.
+
+	Whether a cell is a jump point depends only on the cells around it, so when a cell changes just the rows above,
+	through and below it are rebuilt, and the table is always in step with the grid.
+*/
+class JumpPointTable : public NavGridListenerInterface
+{
+public:
+
+	JumpPointTable() {}
+	~JumpPointTable() { Release(); }
+
+	///////////
+	/// Get ///
+	///////////
+
+	bool IsBuilt() const { return m_Grid != nullptr; }
+	int GetUnitTypeCount() const { return static_cast<int>(m_RunLengths.size()); }
+	int GetCellCount() const { return m_CellCount; }
+
+	//Steps from the cell to the jump point a run east (or west) reaches, or minus the steps to the cell stopping it
+	int GetRunLength(int unitType, int cell, bool east) const
+	{
+		return m_RunLengths[unitType][static_cast<size_t>(cell) * 2 + (east ? 0 : 1)];
+	}
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	/*
+		Builds the tables for unit types 0 to unitTypeCount - 1 and starts listening for changes. Returns false
+		(leaving the table unbuilt) for maps too wide for the run lengths to fit.
+	*/
+	bool Build(NavGrid& grid, int unitTypeCount);
+	//Stops listening to the grid and releases the tables
+	void Release();
+
+	/////////////////
+	/// Overrides ///
+	/////////////////
+
+	void OnCellChanged(const NavGrid& grid, int cell) override;
+
+private:
+
+	//Fills the run lengths of a row (map row, not counting the border) for a unit type
+	void BuildRow(int unitType, int y);
+
+	////////////
+	/// Data ///
+	////////////
+
+	NavGrid* m_Grid = nullptr;
+	int m_CellCount = 0;
+	//Per unit type, the run lengths east then west of each cell
+	std::vector<std::vector<int16_t>> m_RunLengths;
+};
@@ -0,0 +1,324 @@
+#include "LandmarkHeuristic.h"
+
+#include <fstream>
+#include <cstdio>		//std::snprintf
+#include <algorithm>	//std::min, std::max
+
+namespace
+{
+	//Bumped whenever the cache layout or the way tables are built changes, so old caches are rebuilt
+	const uint8_t CACHE_VERSION = 1;
+	const char CACHE_MAGIC[4] = { 'A', 'L', 'T', 'C' };
+
+	//FNV-1a, fed a value at a time
+	const uint64_t HASH_OFFSET = 14695981039346656037ull;
+	const uint64_t HASH_PRIME = 1099511628211ull;
+	void HashValue(uint64_t& hash, uint32_t value)
+	{
+		for (int i(0); i < 4; ++i)
+		{
+			hash ^= (value >> (i * 8)) & 0xFF;
+			hash *= HASH_PRIME;
+		}
+	}
+
+	template<typename T>
+	void WriteValues(std::ofstream& file, const T* values, size_t count)
+	{
+		file.write(reinterpret_cast<const char*>(values), sizeof(T) * count);
+	}
+	template<typename T>
+	bool ReadValues(std::ifstream& file, T* values, size_t count)
+	{
+		file.read(reinterpret_cast<char*>(values), sizeof(T) * count);
+		return file.good();
+	}
+}
+
+bool LandmarkHeuristic::Build(NavGrid& grid, int unitTypeCount, int landmarkCount, const std::string& cacheDirectory)
+{
+	Release();
+	m_Grid = &grid;
+	m_LandmarkCount = std::min(std::max(landmarkCount, 1), MAX_LANDMARKS);
+	m_CellCount = grid.GetCellCount();
+	m_MapHash = HashGrid(grid);
+	m_Stale = false;
+	m_LoadedFromCache = false;
+	grid.AddListener(this);
+
+	//Keep the terrain the tables are built against, to check changes against
+	m_BuiltMoveCosts.resize(m_CellCount);
+	m_BuiltTerrainTypes.resize(m_CellCount);
+	m_BuiltImpassable.Resize(m_CellCount);
+	for (int cell(0); cell < m_CellCount; ++cell)
+	{
+		m_BuiltMoveCosts[cell] = grid.GetMoveCost(cell);
+		m_BuiltTerrainTypes[cell] = grid.GetTerrainType(cell);
+		if (grid.GetFlags(cell) & NavGrid::IMPASSABLE)
+			m_BuiltImpassable.Set(cell);
+	}
+
+	std::string cachePath = cacheDirectory.empty() ? std::string() : GetCachePath(cacheDirectory, m_MapHash);
+	if (!cachePath.empty() && LoadCache(cachePath, unitTypeCount))
+	{
+		m_LoadedFromCache = true;
+		return true;
+	}
+
+	m_UnitTables.assign(unitTypeCount, UnitTable());
+	for (int t(0); t < unitTypeCount; ++t)
+		BuildUnitTable<NavGrid::Topology>(m_UnitTables[t], t);
+
+	return cachePath.empty() || SaveCache(cachePath);
+}
+
+void LandmarkHeuristic::Release()
+{
+	if (m_Grid)
+		m_Grid->RemoveListener(this);
+	m_Grid = nullptr;
+	m_UnitTables.clear();
+	m_LandmarkCount = 0;
+	m_CellCount = 0;
+}
+
+int LandmarkHeuristic::SelectLandmarks(int unitType, int startCell, int goalCell, int* landmarks, int maxCount) const
+{
+	const UnitTable& table = m_UnitTables[unitType];
+	const uint16_t* startEntries = GetCellEntries(unitType, startCell);
+	const uint16_t* goalEntries = GetCellEntries(unitType, goalCell);
+
+	//Keep the best bounds found so far in order, inserting each landmark that beats the worst kept
+	int bounds[MAX_LANDMARKS];
+	int count = 0;
+	for (int k(0); k < static_cast<int>(table.landmarks.size()); ++k)
+	{
+		int bound = GetLandmarkBound(startEntries, goalEntries, k, table.shifts[k]);
+		if (bound <= 0 || (count == maxCount && bound <= bounds[count - 1]))
+			continue;
+
+		int i = count < maxCount ? count++ : count - 1;
+		for (; i > 0 && bounds[i - 1] < bound; --i)
+		{
+			bounds[i] = bounds[i - 1];
+			landmarks[i] = landmarks[i - 1];
+		}
+		bounds[i] = bound;
+		landmarks[i] = k;
+	}
+	return count;
+}
+
+bool LandmarkHeuristic::AreExact(int unitType, const int* landmarks, int count) const
+{
+	for (int i(0); i < count; ++i)
+		if (m_UnitTables[unitType].shifts[landmarks[i]] != 0)
+			return false;
+	return true;
+}
+
+uint64_t LandmarkHeuristic::HashGrid(const NavGrid& grid)
+{
+	uint64_t hash = HASH_OFFSET;
+	HashValue(hash, static_cast<uint32_t>(grid.GetWidth()));
+	HashValue(hash, static_cast<uint32_t>(grid.GetHeight()));
+	HashValue(hash, static_cast<uint32_t>(NavGrid::NEIGHBOUR_COUNT));
+	for (int y(0); y < grid.GetHeight(); ++y)
+	{
+		for (int x(0); x < grid.GetWidth(); ++x)
+		{
+			int cell = grid.CoordsToCell(x, y);
+			uint32_t impassable = (grid.GetFlags(cell) & NavGrid::IMPASSABLE) ? 1u : 0u;
+			HashValue(hash, grid.GetMoveCost(cell) | (grid.GetTerrainType(cell) << 8) | (impassable << 16));
+		}
+	}
+	return hash;
+}
+
+std::string LandmarkHeuristic::GetCachePath(const std::string& cacheDirectory, uint64_t mapHash)
+{
+	char name[64];
+	std::snprintf(name, sizeof(name), "landmarks_%016llx.alt", static_cast<unsigned long long>(mapHash));
+	return cacheDirectory + "/" + name;
+}
+
+void LandmarkHeuristic::OnCellChanged(const NavGrid& grid, int cell)
+{
+	//Dearer or blocked cells only make routes longer, so the bound still holds. Anything else may not.
+	if (grid.GetMoveCost(cell) < m_BuiltMoveCosts[cell] || grid.GetTerrainType(cell) != m_BuiltTerrainTypes[cell] ||
+		(m_BuiltImpassable.Test(cell) && !(grid.GetFlags(cell) & NavGrid::IMPASSABLE)))
+		m_Stale = true;
+}
+
+template<typename Topology>
+void LandmarkHeuristic::BuildUnitTable(UnitTable& table, int unitType)
+{
+	int landmarkCount = m_LandmarkCount;
+	table.landmarks.clear();
+	table.shifts.clear();
+	table.distances.assign(static_cast<size_t>(m_CellCount) * landmarkCount * 2, UNREACHABLE);
+
+	//Distance from each cell to its nearest landmark so far (-1 if no landmark reaches it)
+	m_NearestLandmark.assign(m_CellCount, -1);
+
+	//The first landmark is the cell farthest from an arbitrary one
+	int seed = -1;
+	for (int cell(0); cell < m_CellCount && seed == -1; ++cell)
+		if (IsPassable(cell, unitType))
+			seed = cell;
+	if (seed == -1)
+		return;
+	RunDijkstra<Topology>(seed, unitType, false, m_Costs);
+	int next = seed;
+	for (int cell(0); cell < m_CellCount; ++cell)
+		if (m_Costs[cell] > m_Costs[next])
+			next = cell;
+
+	for (int k(0); k < landmarkCount; ++k)
+	{
+		RunDijkstra<Topology>(next, unitType, false, m_Costs);
+		RunDijkstra<Topology>(next, unitType, true, m_ReverseCosts);
+
+		//Shift the distances down till the largest fits
+		int largest = 0;
+		for (int cell(0); cell < m_CellCount; ++cell)
+			largest = std::max(largest, std::max(m_Costs[cell], m_ReverseCosts[cell]));
+		int shift = 0;
+		while ((largest >> shift) >= UNREACHABLE)
+			++shift;
+
+		table.landmarks.push_back(next);
+		table.shifts.push_back(static_cast<uint8_t>(shift));
+		for (int cell(0); cell < m_CellCount; ++cell)
+		{
+			uint16_t* entries = table.distances.data() + static_cast<size_t>(cell) * landmarkCount * 2;
+			if (m_Costs[cell] >= 0)
+				entries[k] = static_cast<uint16_t>(m_Costs[cell] >> shift);
+			if (m_ReverseCosts[cell] >= 0)
+				entries[landmarkCount + k] = static_cast<uint16_t>(m_ReverseCosts[cell] >> shift);
+
+			if (m_Costs[cell] >= 0 && (m_NearestLandmark[cell] < 0 || m_Costs[cell] < m_NearestLandmark[cell]))
+				m_NearestLandmark[cell] = m_Costs[cell];
+		}
+
+		//Next is the first cell no landmark reaches yet, or failing that the one farthest from them all
+		next = -1;
+		int farthest = 0;
+		for (int cell(0); cell < m_CellCount; ++cell)
+		{
+			if (!IsPassable(cell, unitType))
+				continue;
+			if (m_NearestLandmark[cell] < 0)
+			{
+				next = cell;
+				break;
+			}
+			if (m_NearestLandmark[cell] > farthest)
+			{
+				farthest = m_NearestLandmark[cell];
+				next = cell;
+			}
+		}
+
+		//Every cell is a landmark already
+		if (next == -1)
+			break;
+	}
+}
+
+template<typename Topology>
+void LandmarkHeuristic::RunDijkstra(int source, int unitType, bool reverse, std::vector<int>& costs)
+{
+	costs.assign(m_CellCount, -1);
+	m_OpenList.Resize(m_CellCount);
+	m_OpenList.Clear();
+
+	int stride = m_Grid->GetStride();
+	costs[source] = 0;
+	m_OpenList.Push(source, 0.f, 0.f);
+	while (!m_OpenList.IsEmpty())
+	{
+		int current = m_OpenList.Pop();
+		int currentCost = costs[current];
+
+		ForEachDirection<Topology>([&](auto direction)
+		{
+			int neighbour = current + Topology::Offset(direction, stride);
+			if (!IsPassable(neighbour, unitType))
+				return;
+
+			//Forwards pays for entering the neighbour, backwards for the step from it onto the current cell
+			int newCost = currentCost + Topology::StepCost(direction, m_Grid->GetMoveCost(reverse ? current : neighbour));
+			if (costs[neighbour] >= 0 && newCost >= costs[neighbour])
+				return;
+
+			//Keys are floats, which can round on huge maps, so a cell popped early is pushed again if improved
+			costs[neighbour] = newCost;
+			float key = static_cast<float>(newCost);
+			if (m_OpenList.Contains(neighbour))
+				m_OpenList.DecreaseKey(neighbour, key, key);
+			else
+				m_OpenList.Push(neighbour, key, key);
+		});
+	}
+}
+
+bool LandmarkHeuristic::LoadCache(const std::string& filePath, int unitTypeCount)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file)
+		return false;
+
+	//Header must match this map and build exactly
+	char magic[4] = {};
+	uint8_t version = 0;
+	uint64_t mapHash = 0;
+	int32_t header[5] = {};
+	if (!ReadValues(file, magic, 4) || !ReadValues(file, &version, 1) || !ReadValues(file, &mapHash, 1) || !ReadValues(file, header, 5))
+		return false;
+	if (!std::equal(magic, magic + 4, CACHE_MAGIC) || version != CACHE_VERSION || mapHash != m_MapHash ||
+		header[0] != m_Grid->GetWidth() || header[1] != m_Grid->GetHeight() || header[2] != m_CellCount ||
+		header[3] != unitTypeCount || header[4] != m_LandmarkCount)
+		return false;
+
+	std::vector<UnitTable> tables(unitTypeCount);
+	for (auto& t : tables)
+	{
+		int32_t placed = 0;
+		if (!ReadValues(file, &placed, 1) || placed < 0 || placed > m_LandmarkCount)
+			return false;
+
+		t.landmarks.resize(placed);
+		t.shifts.resize(placed);
+		t.distances.resize(static_cast<size_t>(m_CellCount) * m_LandmarkCount * 2);
+		if (!ReadValues(file, t.landmarks.data(), placed) || !ReadValues(file, t.shifts.data(), placed) ||
+			!ReadValues(file, t.distances.data(), t.distances.size()))
+			return false;
+	}
+
+	m_UnitTables.swap(tables);
+	return true;
+}
+
+bool LandmarkHeuristic::SaveCache(const std::string& filePath) const
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file)
+		return false;
+
+	//Native byte order, the cache is only read back on the machine that wrote it
+	int32_t header[5] = { m_Grid->GetWidth(), m_Grid->GetHeight(), m_CellCount, GetUnitTypeCount(), m_LandmarkCount };
+	WriteValues(file, CACHE_MAGIC, 4);
+	WriteValues(file, &CACHE_VERSION, 1);
+	WriteValues(file, &m_MapHash, 1);
+	WriteValues(file, header, 5);
+	for (auto& t : m_UnitTables)
+	{
+		int32_t placed = static_cast<int32_t>(t.landmarks.size());
+		WriteValues(file, &placed, 1);
+		WriteValues(file, t.landmarks.data(), t.landmarks.size());
+		WriteValues(file, t.shifts.data(), t.shifts.size());
+		WriteValues(file, t.distances.data(), t.distances.size());
+	}
+	return file.good();
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "NavGrid.h"					//Measured grid
+#include "PathfindingContainers.h"		//Dijkstra open list
+
+/*
+	Landmark (ALT) distance tables, giving A* a heuristic that accounts for terrain costs. For a handful of
+	landmark cells the true cost to and from every cell is stored, and the triangle inequality bounds the cost
+	between any two cells from below:
+
+		cost(v, t) >= cost(L, t) - cost(L, v)	and		cost(v, t) >= cost(v, L) - cost(t, L)
+
+	The tables are built per unit type over the terrain only (impassable flags, terrain types and move costs, not
+	occupation), so units blocking cells never make the bound overestimate. Landmarks are picked by farthest point
+	selection: each new landmark is the cell farthest from the ones already chosen, which spreads them around the
+	edges of the map (where the bounds are tightest). Cells in parts of the map not reached yet are picked first.
+
+	Distances are held as uint16 in fixed point (see NavGrid::MOVE_COST_SCALE), shifted down for landmarks whose
+	distances wouldn't otherwise fit (only on very large maps). The bound allows for the rounding so it never
+	overestimates, but it is then no longer consistent, so searches using shifted landmarks reopen closed nodes.
+
+	Building runs two Dijkstra searches per landmark and unit type, so the tables can be cached to disk keyed by a
+	hash of the map, and later builds of the same map load them instead. Tables are marked stale (and should then
+	be ignored) if a cell changes in a way that could make the bound overestimate: cheaper, opened up, or a new
+	terrain type.
+*/
+class LandmarkHeuristic : public NavGridListenerInterface
+{
+public:
+
+	static constexpr int DEFAULT_LANDMARK_COUNT = 8;
+	static constexpr int MAX_LANDMARKS = 16;
+	//Landmarks a search consults, the ones giving the tightest bound between its start and goal
+	static constexpr int ACTIVE_LANDMARK_COUNT = 4;
+	//Table entry for cells the landmark can't reach (or be reached from)
+	static constexpr uint16_t UNREACHABLE = 0xFFFF;
+
+	LandmarkHeuristic() {}
+	~LandmarkHeuristic() { Release(); }
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Built, and no change to the grid since has made the tables overestimate
+	bool IsValid() const { return m_Grid != nullptr && !m_Stale; }
+	//Was the last build loaded from the cache rather than computed
+	bool WasLoadedFromCache() const { return m_LoadedFromCache; }
+	int GetLandmarkCount() const { return m_LandmarkCount; }
+	int GetUnitTypeCount() const { return static_cast<int>(m_UnitTables.size()); }
+	int GetCellCount() const { return m_CellCount; }
+	//Hash of the grid the tables were built for
+	uint64_t GetMapHash() const { return m_MapHash; }
+
+	//Landmarks placed for a unit type (fewer than the landmark count if it has too few cells)
+	int GetPlacedLandmarkCount(int unitType) const { return static_cast<int>(m_UnitTables[unitType].landmarks.size()); }
+	int GetLandmarkCell(int unitType, int landmark) const { return m_UnitTables[unitType].landmarks[landmark]; }
+	//Bits a landmarks distances are shifted down by (0 unless the map is very large)
+	int GetDistanceShift(int unitType, int landmark) const { return m_UnitTables[unitType].shifts[landmark]; }
+	/*
+		Table entries of a cell for a unit type: GetLandmarkCount() shifted distances from each landmark to the cell,
+		followed by the same number from the cell to each landmark (UNREACHABLE where there is no route).
+	*/
+	const uint16_t* GetCellEntries(int unitType, int cell) const
+	{
+		return m_UnitTables[unitType].distances.data() + static_cast<size_t>(cell) * m_LandmarkCount * 2;
+	}
+
+	/*
+		Fills landmarks with up to maxCount landmark indexes, those giving the tightest bound from the start to the
+		goal, returning how many were found (0 if neither cell is covered by the tables)
+	*/
+	int SelectLandmarks(int unitType, int startCell, int goalCell, int* landmarks, int maxCount) const;
+	//Fixed point lower bound on the cost from the cell to the goal, over the given landmarks (0 if none apply)
+	int GetLowerBound(int unitType, int cell, int goalCell, const int* landmarks, int count) const
+	{
+		const UnitTable& table = m_UnitTables[unitType];
+		const uint16_t* cellEntries = GetCellEntries(unitType, cell);
+		const uint16_t* goalEntries = GetCellEntries(unitType, goalCell);
+		int best = 0;
+		for (int i(0); i < count; ++i)
+		{
+			int k = landmarks[i];
+			best = std::max(best, GetLandmarkBound(cellEntries, goalEntries, k, table.shifts[k]));
+		}
+		return best;
+	}
+	//Are all of the given landmarks unshifted (so the bound over them is consistent)
+	bool AreExact(int unitType, const int* landmarks, int count) const;
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	/*
+		Builds the tables for unit types 0 to unitTypeCount - 1 and starts listening for changes. If a cache
+		directory is given, tables saved there for the same map are loaded instead, and freshly built tables are
+		saved there. Returns false if the cache could not be written (the tables are still built).
+	*/
+	bool Build(NavGrid& grid, int unitTypeCount, int landmarkCount = DEFAULT_LANDMARK_COUNT, const std::string& cacheDirectory = "");
+	//Stops listening to the grid and releases the tables
+	void Release();
+
+	//Hash of everything the tables depend on: map size, topology, terrain types, move costs and impassable cells
+	static uint64_t HashGrid(const NavGrid& grid);
+	//Path of the cache file for a map hash within the directory
+	static std::string GetCachePath(const std::string& cacheDirectory, uint64_t mapHash);
+
+	/////////////////
+	/// Overrides ///
+	/////////////////
+
+	void OnCellChanged(const NavGrid& grid, int cell) override;
+
+private:
+
+	struct UnitTable
+	{
+		std::vector<int> landmarks;
+		std::vector<uint8_t> shifts;
+		//Per cell, distances from and then to each landmark (see GetCellEntries)
+		std::vector<uint16_t> distances;
+	};
+
+	/*
+		Bound from one landmark. Entries are rounded down by the shift, so each is up to (1 << shift) - 1 short of
+		the true distance, which the difference allows for.
+	*/
+	int GetLandmarkBound(const uint16_t* cellEntries, const uint16_t* goalEntries, int landmark, int shift) const
+	{
+		int rounding = (1 << shift) - 1;
+		int best = 0;
+
+		//cost(v, t) >= cost(L, t) - cost(L, v)
+		int fromCell = cellEntries[landmark];
+		int fromGoal = goalEntries[landmark];
+		if (fromCell != UNREACHABLE && fromGoal != UNREACHABLE)
+			best = std::max(best, (fromGoal - fromCell) * (1 << shift) - rounding);
+
+		//cost(v, t) >= cost(v, L) - cost(t, L)
+		int toCell = cellEntries[m_LandmarkCount + landmark];
+		int toGoal = goalEntries[m_LandmarkCount + landmark];
+		if (toCell != UNREACHABLE && toGoal != UNREACHABLE)
+			best = std::max(best, (toCell - toGoal) * (1 << shift) - rounding);
+		return best;
+	}
+
+	//Can the unit type stand on the cell, ignoring occupation
+	bool IsPassable(int cell, int unitType) const
+	{
+		return !(m_Grid->GetFlags(cell) & (NavGrid::IMPASSABLE | NavGrid::BORDER)) && m_Grid->GetTerrainType(cell) == unitType;
+	}
+
+	//Picks the landmarks and fills the table of one unit type
+	template<typename Topology>
+	void BuildUnitTable(UnitTable& table, int unitType);
+	//Fixed point costs from the source to every cell (or to the source from every cell if reverse), -1 if unreachable
+	template<typename Topology>
+	void RunDijkstra(int source, int unitType, bool reverse, std::vector<int>& costs);
+
+	//Loads tables saved for this map, landmark count and number of unit types
+	bool LoadCache(const std::string& filePath, int unitTypeCount);
+	bool SaveCache(const std::string& filePath) const;
+
+	////////////
+	/// Data ///
+	////////////
+
+	NavGrid* m_Grid = nullptr;
+	std::vector<UnitTable> m_UnitTables;
+	int m_LandmarkCount = 0;
+	int m_CellCount = 0;
+	uint64_t m_MapHash = 0;
+	bool m_LoadedFromCache = false;
+	bool m_Stale = false;
+
+	//Terrain the tables were built against, to tell which changes make them overestimate
+	std::vector<uint8_t> m_BuiltMoveCosts;
+	std::vector<uint8_t> m_BuiltTerrainTypes;
+	TileBitset m_BuiltImpassable;
+
+	//Build scratch
+	IndexedMinHeap m_OpenList;
+	std::vector<int> m_Costs;
+	std::vector<int> m_ReverseCosts;
+	std::vector<int> m_NearestLandmark;
+};
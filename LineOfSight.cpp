@@ -0,0 +1,247 @@
+#include "LineOfSight.h"
+
+#include <thread>
+#include <algorithm>	//std::min, std::max
+#include <cstdlib>		//std::abs
+
+namespace
+{
+	//Calls func(x, y) for each cell strictly between the ends of the Bresenham line from one to the other (ends must differ)
+	template<typename Func>
+	void WalkBresenham(int fromX, int fromY, int toX, int toY, Func&& func)
+	{
+		int dx = std::abs(toX - fromX);
+		int dy = -std::abs(toY - fromY);
+		int stepX = fromX < toX ? 1 : -1;
+		int stepY = fromY < toY ? 1 : -1;
+		int error = dx + dy;
+
+		int x = fromX;
+		int y = fromY;
+		while (true)
+		{
+			int doubled = error * 2;
+			if (doubled >= dy)
+			{
+				error += dy;
+				x += stepX;
+			}
+			if (doubled <= dx)
+			{
+				error += dx;
+				y += stepY;
+			}
+			if (x == toX && y == toY)
+				return;
+			func(x, y);
+		}
+	}
+}
+
+bool VisibilityCache::IsVisible(int sourceCell, int targetCell) const
+{
+	int dx = m_Grid->GetCellX(targetCell) - m_Grid->GetCellX(sourceCell);
+	int dy = m_Grid->GetCellY(targetCell) - m_Grid->GetCellY(sourceCell);
+	if (std::abs(dx) > m_MaxRange || std::abs(dy) > m_MaxRange)
+		return HasLineOfSight(sourceCell, targetCell);
+
+	int bit = (dy + m_MaxRange) * m_WindowSide + dx + m_MaxRange;
+	return (GetWindow(sourceCell)[bit >> 6] >> (bit & 63)) & 1ull;
+}
+
+bool VisibilityCache::HasLineOfSight(int sourceCell, int targetCell) const
+{
+	if (sourceCell == targetCell)
+		return true;
+
+	int stride = m_Grid->GetStride();
+	int sourceX = m_Grid->GetCellX(sourceCell);
+	int sourceY = m_Grid->GetCellY(sourceCell);
+	int targetX = m_Grid->GetCellX(targetCell);
+	int targetY = m_Grid->GetCellY(targetCell);
+
+	bool blocked = false;
+	WalkBresenham(sourceX, sourceY, targetX, targetY, [&](int x, int y)
+	{
+		blocked = blocked || m_Opaque.Test(sourceCell + (x - sourceX) + (y - sourceY) * stride);
+	});
+	if (!blocked)
+		return true;
+
+	blocked = false;
+	WalkBresenham(targetX, targetY, sourceX, sourceY, [&](int x, int y)
+	{
+		blocked = blocked || m_Opaque.Test(sourceCell + (x - sourceX) + (y - sourceY) * stride);
+	});
+	return !blocked;
+}
+
+void VisibilityCache::Build(NavGrid& grid, int maxRange, int threadCount)
+{
+	Release();
+	m_Grid = &grid;
+	m_MaxRange = std::max(maxRange, 0);
+	m_WindowSide = m_MaxRange * 2 + 1;
+	m_WindowWords = (m_WindowSide * m_WindowSide + 63) >> 6;
+	grid.AddListener(this);
+
+	int cellCount = grid.GetCellCount();
+	m_Opaque.Resize(cellCount);
+	for (int cell(0); cell < cellCount; ++cell)
+	{
+		if (grid.GetFlags(cell) & (NavGrid::IMPASSABLE | NavGrid::BORDER))
+			m_Opaque.Set(cell);
+	}
+	m_Windows.assign(static_cast<size_t>(cellCount) * m_WindowWords, 0ull);
+	BuildOffsetTables();
+
+	//Each thread builds a contiguous block of windows, so none share a word
+	if (threadCount <= 0)
+		threadCount = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+	threadCount = std::min(threadCount, std::max(cellCount / 1024, 1));
+	if (threadCount == 1)
+	{
+		BuildWindows(0, cellCount);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	for (int i(0); i < threadCount; ++i)
+	{
+		int first = static_cast<int>(static_cast<long long>(cellCount) * i / threadCount);
+		int last = static_cast<int>(static_cast<long long>(cellCount) * (i + 1) / threadCount);
+		threads.emplace_back([this, first, last]() { BuildWindows(first, last); });
+	}
+	for (auto& t : threads)
+		t.join();
+}
+
+void VisibilityCache::Release()
+{
+	if (m_Grid)
+		m_Grid->RemoveListener(this);
+	m_Grid = nullptr;
+	m_MaxRange = 0;
+	m_WindowSide = 0;
+	m_WindowWords = 0;
+	m_Windows.clear();
+}
+
+void VisibilityCache::OnCellChanged(const NavGrid& grid, int cell)
+{
+	//Only walls matter, not costs or units
+	bool opaque = (grid.GetFlags(cell) & (NavGrid::IMPASSABLE | NavGrid::BORDER)) != 0;
+	if (opaque == m_Opaque.Test(cell))
+		return;
+
+	if (opaque)
+		m_Opaque.Set(cell);
+	else
+		m_Opaque.Reset(cell);
+
+	//Any line through the cell has its source within R of it on both axes
+	int x = grid.GetCellX(cell);
+	int y = grid.GetCellY(cell);
+	for (int sourceY(std::max(y - m_MaxRange, 0)); sourceY <= std::min(y + m_MaxRange, grid.GetHeight() - 1); ++sourceY)
+	{
+		for (int sourceX(std::max(x - m_MaxRange, 0)); sourceX <= std::min(x + m_MaxRange, grid.GetWidth() - 1); ++sourceX)
+			BuildWindow(grid.CoordsToCell(sourceX, sourceY));
+	}
+}
+
+void VisibilityCache::BuildOffsetTables()
+{
+	int stride = m_Grid->GetStride();
+	int bitCount = m_WindowSide * m_WindowSide;
+
+	m_BitCellDeltas.resize(bitCount);
+	m_LineStarts.clear();
+	m_LineDeltas.clear();
+	for (int bit(0); bit < bitCount; ++bit)
+	{
+		int dx = bit % m_WindowSide - m_MaxRange;
+		int dy = bit / m_WindowSide - m_MaxRange;
+		m_BitCellDeltas[bit] = dx + dy * stride;
+
+		//From the source out, then from the bit back (both as deltas from the source)
+		m_LineStarts.push_back(static_cast<int>(m_LineDeltas.size()));
+		if (dx != 0 || dy != 0)
+			WalkBresenham(0, 0, dx, dy, [&](int x, int y) { m_LineDeltas.push_back(x + y * stride); });
+		m_LineStarts.push_back(static_cast<int>(m_LineDeltas.size()));
+		if (dx != 0 || dy != 0)
+			WalkBresenham(dx, dy, 0, 0, [&](int x, int y) { m_LineDeltas.push_back(x + y * stride); });
+	}
+	m_LineStarts.push_back(static_cast<int>(m_LineDeltas.size()));
+
+	//Shape masks are laid out from the shapes row spans
+	int rangeCount = m_MaxRange + 1;
+	m_RangeMasks.assign(static_cast<size_t>(RANGE_SHAPE::COUNT) * rangeCount * m_WindowWords, 0ull);
+	for (int shape(0); shape < static_cast<int>(RANGE_SHAPE::COUNT); ++shape)
+	{
+		for (int range(0); range <= m_MaxRange; ++range)
+		{
+			uint64_t* mask = m_RangeMasks.data() + (static_cast<size_t>(shape) * rangeCount + range) * m_WindowWords;
+			NavGrid::Shapes::ForEachSpan(static_cast<RANGE_SHAPE>(shape), SHAPE_FACING::ALL, range, [&](int dy, int minX, int maxX)
+			{
+				for (int dx(minX); dx <= maxX; ++dx)
+				{
+					int bit = (dy + m_MaxRange) * m_WindowSide + dx + m_MaxRange;
+					mask[bit >> 6] |= 1ull << (bit & 63);
+				}
+			});
+		}
+	}
+}
+
+void VisibilityCache::BuildWindows(int firstCell, int lastCell)
+{
+	for (int cell(firstCell); cell < lastCell; ++cell)
+		BuildWindow(cell);
+}
+
+void VisibilityCache::BuildWindow(int sourceCell)
+{
+	uint64_t* window = m_Windows.data() + static_cast<size_t>(sourceCell) * m_WindowWords;
+	for (int w(0); w < m_WindowWords; ++w)
+		window[w] = 0ull;
+
+	//Nobody looks out from a wall
+	if (m_Opaque.Test(sourceCell))
+		return;
+
+	int sourceX = m_Grid->GetCellX(sourceCell);
+	int sourceY = m_Grid->GetCellY(sourceCell);
+	int width = m_Grid->GetWidth();
+	int height = m_Grid->GetHeight();
+
+	for (int dy(-m_MaxRange); dy <= m_MaxRange; ++dy)
+	{
+		int y = sourceY + dy;
+		if (y < 0 || y >= height)
+			continue;
+
+		//Clip the row to the map, so lines never leave it
+		int xStart = std::max(-m_MaxRange, -sourceX);
+		int xEnd = std::min(m_MaxRange, width - 1 - sourceX);
+		int rowBit = (dy + m_MaxRange) * m_WindowSide + m_MaxRange;
+		for (int dx(xStart); dx <= xEnd; ++dx)
+		{
+			int bit = rowBit + dx;
+			int run = bit * 2;
+			if (!IsLineBlocked(sourceCell, m_LineStarts[run], m_LineStarts[run + 1]) ||
+				!IsLineBlocked(sourceCell, m_LineStarts[run + 1], m_LineStarts[run + 2]))
+				window[bit >> 6] |= 1ull << (bit & 63);
+		}
+	}
+}
+
+bool VisibilityCache::IsLineBlocked(int startCell, int firstDelta, int lastDelta) const
+{
+	for (int i(firstDelta); i < lastDelta; ++i)
+	{
+		if (m_Opaque.Test(startCell + m_LineDeltas[i]))
+			return true;
+	}
+	return false;
+}
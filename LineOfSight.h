@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "NavGrid.h"					//Grid walls are read from
+#include "PathfindingContainers.h"		//Opaque cell bitset
+
+/*
+	Line of sight between tiles, with every source tile's visible surroundings cached as bits.
+
+	A tile is visible from another if a Bresenham line between their centres passes no impassable tile (the end
+	tiles themselves don't block). Lines are walked in both directions and either being clear counts, so sight is
+	symmetric: if A can see B, B can see A. Units never block sight.
+
+	For each cell the cache holds a (2R + 1) x (2R + 1) window of bits centred on it, R being the range the cache
+	was built for, packed row after row into a few 64 bit words. Targeting with a range shape is then the window
+	ANDed with a mask of the shape, a word at a time. Bresenham lines only depend on the offset between their ends,
+	so each offset's line is walked once as a list of cell deltas, shared by every source.
+
+	Building walks every line of every window, split across threads by source cell (each thread writes only its own
+	windows). The cache listens to the grid, and when a tile becomes passable or impassable only the windows that
+	could have a line through it (sources within R of it on both axes) are rebuilt.
+*/
+class VisibilityCache : public NavGridListenerInterface
+{
+public:
+
+	VisibilityCache() {}
+	~VisibilityCache() { Release(); }
+
+	///////////
+	/// Get ///
+	///////////
+
+	bool IsBuilt() const { return m_Grid != nullptr; }
+	//Largest range the windows cover, visibility further out is worked out by walking the line
+	int GetMaxRange() const { return m_MaxRange; }
+	int GetWindowWordCount() const { return m_WindowWords; }
+	//Visibility window of a cell (bit (dy + R) * (2R + 1) + dx + R is the cell at offset dx, dy)
+	const uint64_t* GetWindow(int cell) const { return m_Windows.data() + static_cast<size_t>(cell) * m_WindowWords; }
+
+	//Can the cell be seen from the source (from the cache when within range, otherwise by walking the line)
+	bool IsVisible(int sourceCell, int targetCell) const;
+	//Walks the line between the cells both ways, without the cache
+	bool HasLineOfSight(int sourceCell, int targetCell) const;
+
+	//Calls func(cell) for each map cell within the range shape of the source that it can see
+	template<typename Func>
+	void ForEachVisibleInRange(int sourceCell, int range, Func&& func) const
+	{
+		ForEachVisibleInShape(sourceCell, RANGE_SHAPE::DIAMOND, range, func);
+	}
+
+	//As ForEachVisibleInRange, for a shape facing every way (see SHAPE_FACING::ALL)
+	template<typename Func>
+	void ForEachVisibleInShape(int sourceCell, RANGE_SHAPE shape, int range, Func&& func) const
+	{
+		if (range <= m_MaxRange)
+		{
+			//Window AND the shape, a word at a time
+			const uint64_t* window = GetWindow(sourceCell);
+			const uint64_t* mask = GetShapeMask(shape, range);
+			for (int w(0); w < m_WindowWords; ++w)
+			{
+				for (uint64_t bits = window[w] & mask[w]; bits; bits &= bits - 1)
+					func(sourceCell + m_BitCellDeltas[(w << 6) + CountTrailingZeros(bits)]);
+			}
+			return;
+		}
+
+		//Out past the windows, so lay out the shape and walk each line
+		m_Grid->ForEachSpanInShape(m_Grid->GetCellX(sourceCell), m_Grid->GetCellY(sourceCell), shape, SHAPE_FACING::ALL, range,
+			[&](int firstCell, int lastCell)
+		{
+			for (int cell(firstCell); cell <= lastCell; ++cell)
+			{
+				if (HasLineOfSight(sourceCell, cell))
+					func(cell);
+			}
+		});
+	}
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	/*
+		Builds the windows for every cell of the grid out to maxRange, and starts listening for changes. threadCount
+		of 0 uses one thread per hardware thread.
+	*/
+	void Build(NavGrid& grid, int maxRange, int threadCount = 0);
+	//Stops listening to the grid and releases the windows
+	void Release();
+
+	/////////////////
+	/// Overrides ///
+	/////////////////
+
+	void OnCellChanged(const NavGrid& grid, int cell) override;
+
+private:
+
+	//Window bits inside the shape at a range of 0 to R
+	const uint64_t* GetShapeMask(RANGE_SHAPE shape, int range) const
+	{
+		return m_RangeMasks.data() + (static_cast<size_t>(shape) * (m_MaxRange + 1) + range) * m_WindowWords;
+	}
+
+	//Lays out the line deltas, bit deltas and shape masks for the windows
+	void BuildOffsetTables();
+	//Rebuilds the windows of the source cells in [first, last)
+	void BuildWindows(int firstCell, int lastCell);
+	void BuildWindow(int sourceCell);
+	//Is any cell along the line (start + each delta) opaque
+	bool IsLineBlocked(int startCell, int firstDelta, int lastDelta) const;
+
+	////////////
+	/// Data ///
+	////////////
+
+	NavGrid* m_Grid = nullptr;
+	int m_MaxRange = 0;
+	//Width of a window, 2R + 1
+	int m_WindowSide = 0;
+	int m_WindowWords = 0;
+
+	//Windows, m_WindowWords per cell
+	std::vector<uint64_t> m_Windows;
+	//Cells that block sight (impassable or border), as the windows were last built against
+	TileBitset m_Opaque;
+
+	//Per window bit, the cell delta of its offset
+	std::vector<int> m_BitCellDeltas;
+	/*
+		Cells between the source and each window bit, as deltas from the source. Run 2 * bit is the line walked
+		from the source, run 2 * bit + 1 the line walked back from the bit, each from m_LineStarts[run] up to
+		m_LineStarts[run + 1].
+	*/
+	std::vector<int> m_LineStarts;
+	std::vector<int> m_LineDeltas;
+	//Per shape (facing every way), then per range 0 to R, the window bits inside the shape
+	std::vector<uint64_t> m_RangeMasks;
+};
@@ -1,9 +1,13 @@
 #include "MainGameMode.h"
 
+#include <filesystem>				//Cache directory
+#include <ctime>					//Match seeds
+
 #include "RapidJSONLoaderUtils.h"   //Map data loader
 
 #include "GeneralUtils.h"		//String Conversion
 #include "TilemapUtils.h"		//Tilemap Loading Help
+#include "CombatForecast.h"		//AoE target scoring
 
 //Game Objects
 #include "TestEntity.h"         //Entity Testing
@@ -16,6 +20,9 @@ using namespace DirectX;
 using namespace rapidjson;
 using namespace TiledLoaders;
 
+//Where landmark tables are kept between runs, so each map is only measured once
+static const char* LANDMARK_CACHE_DIRECTORY = "data/cache";
+
 
 MainGameMode::MainGameMode(size_t id)
 	:ModeInterface(id), m_State(MODE_STATE::UNIT_SELECTION)
@@ -452,31 +459,56 @@ void MainGameMode::InitMapTiles()
 		//Get coords
 		XMINT2& coords = t->GetMapCoordinates();
 
-		//Do some checking to verify what neighbours should be added
-		if (coords.y > 0)				//North Check
-			t->SetNeighbourAtIndex(0, m_TileMap.at((coords.x + (coords.y - 1)) + ((coords.y - 1) * m_MapLimit.y)));
-		if (coords.x < m_MapLimit.x)	//East Check
-			t->SetNeighbourAtIndex(1, m_TileMap.at((coords.x + 1 + coords.y) + (coords.y * m_MapLimit.y)));
-		if (coords.y < m_MapLimit.y)	//South Check
-			t->SetNeighbourAtIndex(2, m_TileMap.at((coords.x + (coords.y + 1)) + ((coords.y + 1) * m_MapLimit.y)));
-		if (coords.x > 0)				//West Check
-			t->SetNeighbourAtIndex(3, m_TileMap.at((coords.x - 1 + coords.y) + (coords.y * m_MapLimit.y)));
-
+		//Link each neighbour in the topologys direction order, skipping any off the edge of the map
+		for (int i(0); i < NUM_OF_NEIGHBOURS; ++i)
+		{
+			XMINT2 neighbourCoords = { coords.x + NavGrid::Topology::DX[i], coords.y + NavGrid::Topology::DY[i] };
+			if (neighbourCoords.x >= 0 && neighbourCoords.x <= m_MapLimit.x && neighbourCoords.y >= 0 && neighbourCoords.y <= m_MapLimit.y)
+				t->SetNeighbourAtIndex(i, m_TileMap.at(MapTile::CoordsToTileIndex(neighbourCoords, m_MapLimit.y)));
+		}
 	}
 
+	//Build the search grid from the finished map and hand it to the systems that search it
+	std::vector<TileProperties> tileProperties;
+	tileProperties.reserve(m_TileMap.size());
+	for (auto& t : m_TileMap)
+		tileProperties.push_back(t->GetTileProperties());
+	m_NavGrid.Build(tileProperties, mapCols, mapRows);
+	for (size_t i(0); i < m_TileMap.size(); ++i)
+		m_TileMap[i]->BindNavGrid(&m_NavGrid, m_NavGrid.TileToCell(static_cast<int>(i)));
+	m_Connectivity.Build(m_NavGrid, static_cast<int>(UnitEntity::UNIT_TYPE::AIR) + 1);
+	std::error_code error;
+	std::filesystem::create_directories(LANDMARK_CACHE_DIRECTORY, error);
+	m_Landmarks.Build(m_NavGrid, static_cast<int>(UnitEntity::UNIT_TYPE::AIR) + 1,
+		LandmarkHeuristic::DEFAULT_LANDMARK_COUNT, LANDMARK_CACHE_DIRECTORY);
+	m_Visibility.Build(m_NavGrid, Game::GetGame()->GetAssetManager().GetMaxSkillRange());
+	m_Overlays.Resize(m_NavGrid.GetCellCount());
+	m_Occupancy.Resize(m_NavGrid);
+	m_Overlays.SetFrame(TILE_OVERLAY::MOVEMENT, UI_ATLAS_01_FRAMES::MOVE_TILE_HIGHLIGHT);
+	m_Overlays.SetFrame(TILE_OVERLAY::PLACEMENT, UI_ATLAS_01_FRAMES::MOVE_TILE_HIGHLIGHT);
+	m_Overlays.SetFrame(TILE_OVERLAY::PATH, UI_ATLAS_01_FRAMES::ATTACK_TILE_HIGHLIGHT);
+	m_Overlays.SetVisible(TILE_OVERLAY::AOE, false);
+	m_PathFinder.SetNavGrid(&m_NavGrid);
+	m_PathFinder.SetOverlays(&m_Overlays);
+	m_PathFinder.SetConnectivityMap(&m_Connectivity);
+	m_PathFinder.SetLandmarks(&m_Landmarks);
+	m_PathFinder.SetVisibility(&m_Visibility);
+	m_TargetingSystem.SetNavGrid(&m_NavGrid);
+	m_TargetingSystem.SetOverlays(&m_Overlays);
+	m_TargetingSystem.SetVisibility(&m_Visibility);
+
 }
 
 void MainGameMode::FinaliseInit()
 {
 	//Run cursor search for edge case errors
 	m_Cursor->SearchForTileObject(m_TileMap, m_MapLimit.x);
-	m_Cursor->SearchForUnitObject(m_Actors, m_MapLimit.x);
+	m_Cursor->SearchForUnitObject(m_Occupancy, m_Actors);
 
 	//Set starting team ID
 	m_CurrentTeamID = 1;
 
 	//Update targeting system with what it needs to know
-	m_TargetingSystem.SetTileMapLength(m_MapLimit.x);
 	m_TargetingSystem.SetTileOverlayFrameIndex(19);
 
 }
@@ -513,6 +545,8 @@ void MainGameMode::InitUnitSelection()
 		unit->GetPrimarySprite().SetScale(SPRITE_SCALE_ADJ, SPRITE_SCALE_ADJ);
 		unit->SetUnitTeamID(1);
 		unit->GetEntityData().isActive = false;
+		//Goes on the occupancy map once placed
+		unit->BindOccupancy(&m_Occupancy, static_cast<int>(m_Actors.size()));
 
 		m_Actors.push_back(unit);
 		m_TeamOne.push_back(unit);
@@ -528,6 +562,7 @@ void MainGameMode::InitUnitSelection()
 		unit->GetPrimarySprite().SetScale(SPRITE_SCALE_ADJ, SPRITE_SCALE_ADJ);
 		unit->SetUnitTeamID(2);
 		unit->GetEntityData().isActive = false;
+		unit->BindOccupancy(&m_Occupancy, static_cast<int>(m_Actors.size()));
 
 		m_Actors.push_back(unit);
 		m_TeamTwo.push_back(unit);
@@ -842,7 +877,7 @@ void MainGameMode::ProcessKeyUnitMenuOpenState(char key)
 				//Play Select Audio
 				Game::GetGame()->GetAudioManager().PlayOneShot(Game::GetGame()->GetAudioManager().GetSFXManager().m_SFX1);
 				//Generate movement grid from unit position
-				m_PathFinder.GenerateTileGrid(m_TileMap, static_cast<UnitEntity*>(m_Cursor->GetCurrentObject()), m_MapLimit.x);
+				m_PathFinder.GenerateTileGrid(m_TileMap, static_cast<UnitEntity*>(m_Cursor->GetCurrentObject()));
 				//Change State
 				m_State = MODE_STATE::MOVE_MENU_OPEN;
 			}
@@ -991,7 +1026,7 @@ void MainGameMode::ProcessKeyMoveMenuOpenState(char key)
 				Game::GetGame()->GetAudioManager().GetSFXManager().m_SFX1);
 			//Flag that current tile is no longer occupied
 			MapTile::FindTileInArray(m_TileMap, m_Cursor->GetCurrentObject()->GetMapCoordinates(),
-				m_MapLimit.x)->GetTileProperties().occupied = false;
+				m_MapLimit.x)->SetOccupationStatus(false);
 
 			//Move unit
 			static_cast<UnitEntity*>(m_Cursor->GetCurrentObject())->MoveToCoordinate(
@@ -999,7 +1034,7 @@ void MainGameMode::ProcessKeyMoveMenuOpenState(char key)
 
 			//Flag current tile as occupied
 			MapTile::FindTileInArray(m_TileMap, m_Cursor->GetCurrentObject()->GetMapCoordinates(),
-				m_MapLimit.x)->GetTileProperties().occupied = true;
+				m_MapLimit.x)->SetOccupationStatus(true);
 
 			//Release current manifest
 			m_PathFinder.ReleaseManifest();
@@ -1030,22 +1065,8 @@ void MainGameMode::ProcessKeyMoveMenuOpenState(char key)
 		{
 			UpdateTileTooltip(m_TileTooltip, m_Cursor->GetCurrentTileObject());
 
-			//Run A*
-
-			//If the tile highlighted is in the grid, attempt to path find
-			if (m_PathFinder.IsTileInGrid(m_Cursor->GetCurrentTileObject()))
-			{
-				m_PathFinder.ResetGridEffectToDefault();
-				const XMINT2& coords = m_Cursor->GetCurrentObject()->GetMapCoordinates();
-				MapTile* tile = m_TileMap.at((coords.x + (coords.y)) + ((coords.y) * m_MapLimit.y));
-				m_PathFinder.RunAStarAlgorithm(tile, m_Cursor->GetCurrentTileObject());
-
-			}
-			//The cursor has likely left the grid, so remove the effect
-			else
-			{
-				m_PathFinder.ResetGridEffectToDefault();
-			}
+			//Update the path preview (clears itself if the tile is outside the grid)
+			m_PathFinder.PreviewPath(m_Cursor->GetCurrentTileObject());
 
 		}
 		break;
@@ -1058,22 +1079,8 @@ void MainGameMode::ProcessKeyMoveMenuOpenState(char key)
 		{
 			UpdateTileTooltip(m_TileTooltip, m_Cursor->GetCurrentTileObject());
 
-			//Run A*
-
-			//If the tile highlighted is in the grid, attempt to path find
-			if (m_PathFinder.IsTileInGrid(m_Cursor->GetCurrentTileObject()))
-			{
-				m_PathFinder.ResetGridEffectToDefault();
-				const XMINT2& coords = m_Cursor->GetCurrentObject()->GetMapCoordinates();
-				MapTile* tile = m_TileMap.at((coords.x + (coords.y)) + ((coords.y) * m_MapLimit.y));
-				m_PathFinder.RunAStarAlgorithm(tile, m_Cursor->GetCurrentTileObject());
-
-			}
-			//The cursor has likely left the grid, so remove the effect
-			else
-			{
-				m_PathFinder.ResetGridEffectToDefault();
-			}
+			//Update the path preview (clears itself if the tile is outside the grid)
+			m_PathFinder.PreviewPath(m_Cursor->GetCurrentTileObject());
 
 		}
 		break;
@@ -1086,40 +1093,8 @@ void MainGameMode::ProcessKeyMoveMenuOpenState(char key)
 		{
 			UpdateTileTooltip(m_TileTooltip, m_Cursor->GetCurrentTileObject());
 
-			//Run A*
-
-			//If the tile highlighted is in the grid, attempt to path find
-			if (m_PathFinder.IsTileInGrid(m_Cursor->GetCurrentTileObject()))
-			{
-				m_PathFinder.ResetGridEffectToDefault();
-				const XMINT2& coords = m_Cursor->GetCurrentObject()->GetMapCoordinates();
-				MapTile* tile = m_TileMap.at((coords.x + (coords.y)) + ((coords.y) * m_MapLimit.y));
-				m_PathFinder.RunAStarAlgorithm(tile, m_Cursor->GetCurrentTileObject());
-
-			}
-			//The cursor has likely left the grid, so remove the effect
-			else
-			{
-				m_PathFinder.ResetGridEffectToDefault();
-
-				//Run A*
-
-				//If the tile highlighted is in the grid, attempt to path find
-				if (m_PathFinder.IsTileInGrid(m_Cursor->GetCurrentTileObject()))
-				{
-					m_PathFinder.ResetGridEffectToDefault();
-					const XMINT2& coords = m_Cursor->GetCurrentObject()->GetMapCoordinates();
-					MapTile* tile = m_TileMap.at((coords.x + (coords.y)) + ((coords.y) * m_MapLimit.y));
-					m_PathFinder.RunAStarAlgorithm(tile, m_Cursor->GetCurrentTileObject());
-
-				}
-				//The cursor has likely left the grid, so remove the effect
-				else
-				{
-					m_PathFinder.ResetGridEffectToDefault();
-				}
-
-			}
+			//Update the path preview (clears itself if the tile is outside the grid)
+			m_PathFinder.PreviewPath(m_Cursor->GetCurrentTileObject());
 
 		}
 		break;
@@ -1132,22 +1107,8 @@ void MainGameMode::ProcessKeyMoveMenuOpenState(char key)
 		{
 			UpdateTileTooltip(m_TileTooltip, m_Cursor->GetCurrentTileObject());
 
-			//Run A*
-
-			//If the tile highlighted is in the grid, attempt to path find
-			if (m_PathFinder.IsTileInGrid(m_Cursor->GetCurrentTileObject()))
-			{
-				m_PathFinder.ResetGridEffectToDefault();
-				const XMINT2& coords = m_Cursor->GetCurrentObject()->GetMapCoordinates();
-				MapTile* tile = m_TileMap.at((coords.x + (coords.y)) + ((coords.y) * m_MapLimit.y));
-				m_PathFinder.RunAStarAlgorithm(tile, m_Cursor->GetCurrentTileObject());
-
-			}
-			//The cursor has likely left the grid, so remove the effect
-			else
-			{
-				m_PathFinder.ResetGridEffectToDefault();
-			}
+			//Update the path preview (clears itself if the tile is outside the grid)
+			m_PathFinder.PreviewPath(m_Cursor->GetCurrentTileObject());
 
 		}
 		break;
@@ -1334,6 +1295,16 @@ void MainGameMode::ProcessKeyFindTargetState(char key)
 		m_Camera.MoveSceneLeft();
 		UpdateCursorTargetingMode();
 
+		break;
+	case 'r':
+	case 'R':
+		//Aim AoE skills where they hit the most (the cursor otherwise stays where the player put it)
+		if (static_cast<UnitEntity*>(m_Cursor->GetCurrentObject())->GetSkillAtIndex(m_SkillIndex)->GetSkillRadius() > 0)
+		{
+			AimAoEAtBestPlacement();
+			UpdateCursorTargetingMode();
+		}
+
 		break;
 	}
 }
@@ -1452,7 +1423,7 @@ bool MainGameMode::SetupSelectedUnit()
 			break;
 		}
 
-		m_Cursor->GetCurrentTileObject()->GetTileProperties().occupied = true;
+		m_Cursor->GetCurrentTileObject()->SetOccupationStatus(true);
 
 		return true;
 	}
@@ -1487,8 +1458,11 @@ void MainGameMode::StartFreshGame()
 
 	for (auto& t : m_TileMap)
 	{
-		t->GetTileProperties().occupied = false;
+		t->SetOccupationStatus(false);
 	}
+	m_Occupancy.Clear();
+	//New match, new combat rolls
+	game->GetGameplayManager().StartMatch(static_cast<uint64_t>(time(nullptr)));
 
 	//Init Navigation Elements
 	manager->GetNavigationMenuByTypeID(m_UnitMenu, UIElementIDs::UNIT_MENU_00);
@@ -1671,17 +1645,7 @@ void MainGameMode::EnablePlacementGrid()
 		for (int x(0); x < m_PlacementGridSize.x; ++x)
 		{
 			for (int y(0); y < m_PlacementGridSize.y; ++y)
-			{
-
-				//			t->SetNeighbourAtIndex(0, m_TileMap.at((coords.x + (coords.y - 1)) + ((coords.y - 1) * m_MapLimit.y)));
-
-				int index = (m_TeamOneGridStart.x + m_TeamOneGridStart.y + x + y) + ((m_TeamOneGridStart.y + y) * m_MapLimit.y);
-
-				MapTile* tile = m_TileMap.at(index);
-				tile->SetDrawGridFlag(true);
-				tile->GetGridSprite().SetFrame(UI_ATLAS_01_FRAMES::MOVE_TILE_HIGHLIGHT);
-				m_PlacementGridTiles.push_back(tile);
-			}
+				m_Overlays.Set(TILE_OVERLAY::PLACEMENT, m_NavGrid.CoordsToCell(m_TeamOneGridStart.x + x, m_TeamOneGridStart.y + y));
 		}
 
 		break;
@@ -1689,17 +1653,7 @@ void MainGameMode::EnablePlacementGrid()
 		for (int x(0); x < m_PlacementGridSize.x; ++x)
 		{
 			for (int y(0); y < m_PlacementGridSize.y; ++y)
-			{
-
-				//			t->SetNeighbourAtIndex(0, m_TileMap.at((coords.x + (coords.y - 1)) + ((coords.y - 1) * m_MapLimit.y)));
-
-				int index = (m_TeamTwoGridStart.x + m_TeamTwoGridStart.y + x + y) + ((m_TeamTwoGridStart.y + y) * m_MapLimit.y);
-
-				MapTile* tile = m_TileMap.at(index);
-				tile->SetDrawGridFlag(true);
-				tile->GetGridSprite().SetFrame(UI_ATLAS_01_FRAMES::MOVE_TILE_HIGHLIGHT);
-				m_PlacementGridTiles.push_back(tile);
-			}
+				m_Overlays.Set(TILE_OVERLAY::PLACEMENT, m_NavGrid.CoordsToCell(m_TeamTwoGridStart.x + x, m_TeamTwoGridStart.y + y));
 		}
 
 		break;
@@ -1708,26 +1662,13 @@ void MainGameMode::EnablePlacementGrid()
 
 void MainGameMode::DisablePlacementGrid()
 {
-	for (auto& a : m_PlacementGridTiles)
-	{
-		a->SetDrawGridFlag(false);
-		a = nullptr;
-	}
-
-	m_PlacementGridTiles.clear();
+	m_Overlays.Clear(TILE_OVERLAY::PLACEMENT);
 }
 
 bool MainGameMode::IsTileInPlacementGrid(MapTile* tile)
 {
-	for (auto& a : m_PlacementGridTiles)
-	{
-		//Return true if tile match found
-		if (tile == a)
-			return true;
-	}
-	
-	//No match so return false
-	return false;
+	XMINT2& coords = tile->GetMapCoordinates();
+	return m_Overlays.Test(TILE_OVERLAY::PLACEMENT, m_NavGrid.CoordsToCell(coords.x, coords.y));
 }
 
 void MainGameMode::ProcessKeyUnitSelectionState(char key)
@@ -2141,30 +2082,53 @@ void MainGameMode::AOE()
 {
 	m_TargetingSystem.DisableGrid();
 
-	m_TargetingSystem.GenerateAoEGrid(m_TileMap, m_Cursor->GetMapCoordinates(),
-		static_cast<UnitEntity*>(m_Cursor->GetCurrentObject())->GetSkillAtIndex(m_SkillIndex)->GetSkillRadius());
+	//Lines and cones point away from the user
+	UnitEntity* user = static_cast<UnitEntity*>(m_Cursor->GetCurrentObject());
+	SkillInterface* skill = user->GetSkillAtIndex(m_SkillIndex);
+	XMINT2& cursorCoords = m_Cursor->GetMapCoordinates();
+	XMINT2& userCoords = user->GetMapCoordinates();
+	m_TargetingSystem.GenerateAoEGrid(cursorCoords, skill->GetSkillRadius(), skill->GetRadiusShape(),
+		FacingTowards(cursorCoords.x - userCoords.x, cursorCoords.y - userCoords.y));
+
+	//Hit every living enemy under the area, found from the tiles rather than by checking each unit
+	int enemyTeam = user->GetUnitTeamID() == 1 ? 2 : 1;
+	m_Occupancy.ForEachUnitInLayer(m_Overlays, TILE_OVERLAY::AOE, enemyTeam, [&](int handle)
+	{
+		UseSelectedSkillOnTarget(user, static_cast<UnitEntity*>(m_Actors[handle]));
+	});
+}
 
-	switch (static_cast<UnitEntity*>(m_Cursor->GetCurrentObject())->GetUnitTeamID())
+void MainGameMode::AimAoEAtBestPlacement()
+{
+	UnitEntity* user = static_cast<UnitEntity*>(m_Cursor->GetCurrentObject());
+	SkillInterface* skill = user->GetSkillAtIndex(m_SkillIndex);
+
+	/*
+		Each living enemy is worth the HP the skill is forecast to take from it (plus one, so enemies it can't hurt
+		still count), and only those near enough to be covered by an area in range matter
+	*/
+	CombatSkill combatSkill = skill->GetCombatSkill();
+	m_AoETargets.clear();
+	XMINT2& userCoords = user->GetMapCoordinates();
+	int reach = NavGrid::Shapes::GetBoundingRange(skill->GetRangeShape(), SHAPE_FACING::ALL, skill->GetSkillRange()) +
+		NavGrid::Shapes::GetBoundingRange(skill->GetRadiusShape(), SHAPE_FACING::ALL, skill->GetSkillRadius());
+	m_Occupancy.ForEachUnitInShape(userCoords.x, userCoords.y, RANGE_SHAPE::DIAMOND, SHAPE_FACING::ALL, reach,
+		user->GetUnitTeamID() == 1 ? 2 : 1, [&](int handle)
 	{
-	case 1:
-		for (auto a : m_TeamTwo)
-		{
-			if (m_TargetingSystem.IsUnitInAoEGrid(a->GetMapCoordinates()))
-			{
-				UseSelectedSkillOnTarget(static_cast<UnitEntity*>(m_Cursor->GetCurrentObject()), a);
-			}
-		}
-		break;
-	case 2:
-		for (auto a : m_TeamOne)
-		{
-			if (m_TargetingSystem.IsUnitInAoEGrid(a->GetMapCoordinates()))
-			{
-				UseSelectedSkillOnTarget(static_cast<UnitEntity*>(m_Cursor->GetCurrentObject()), a);
-			}
-		}
-		break;
-	}
+		SkillForecast forecast = CombatForecast::Forecast(user->GetClassTotals(),
+			static_cast<UnitEntity*>(m_Actors[handle])->GetClassTotals(), combatSkill);
+		m_AoETargets.push_back({ m_Occupancy.GetUnitCell(handle), 1.f + forecast.expectedHPLost });
+	});
+
+	//The skill is aimed at a unit, so only centre on enemies
+	const std::vector<AoEPlacement>& placements = m_TargetingSystem.FindAoEPlacements(userCoords,
+		skill->GetSkillRange(), skill->GetRangeShape(), skill->GetSkillRadius(), skill->GetRadiusShape(), m_AoETargets, 1, true);
+	if (placements.empty())
+		return;
+
+	XMINT2 coords = { m_NavGrid.GetCellX(placements[0].cell), m_NavGrid.GetCellY(placements[0].cell) };
+	m_Cursor->MoveFixedCursorCoords(coords);
+	m_Camera.MoveCameraToCoordinates(coords);
 }
 
 void MainGameMode::KillUnit(UnitEntity* unit)
@@ -2265,9 +2229,9 @@ void MainGameMode::SwitchUnitMenuToTargetingMode(UIElementManager*& manager, MOD
 {
 	//Generate range grid
 	m_TargetingSystem.GenerateTargetGrid(
-		m_TileMap,
 		m_Cursor->GetCurrentObject()->GetMapCoordinates(),
-		static_cast<UnitEntity*>(m_Cursor->GetCurrentObject())->GetSkillAtIndex(m_SkillIndex)->GetSkillRange()
+		static_cast<UnitEntity*>(m_Cursor->GetCurrentObject())->GetSkillAtIndex(m_SkillIndex)->GetSkillRange(),
+		static_cast<UnitEntity*>(m_Cursor->GetCurrentObject())->GetSkillAtIndex(m_SkillIndex)->GetRangeShape()
 	);
 
 	//Pre-update the cursor for targeting mode
@@ -2303,6 +2267,14 @@ void MainGameMode::RenderScene(PassData& data, ID3D12GraphicsCommandList* cl)
 	for (auto& a : m_TileMap)
 		a->Render(*data.sceneSB, data.heap);
 
+	//Render grid overlays, each tile under its topmost layer
+	m_Overlays.ForEachDrawnCell([&](int cell, int frame)
+	{
+		Sprite& sprite = m_TileMap[m_NavGrid.CellToTile(cell)]->GetGridSprite();
+		sprite.SetFrame(frame);
+		sprite.Draw(*data.sceneSB, data.heap);
+	});
+
 	//Render Actors
 	for (auto& a : m_Actors)
 		a->Render(*data.sceneSB, data.heap);
@@ -2414,7 +2386,7 @@ void MainGameMode::UpdateCursorFreeMode()
 		UpdateTileTooltip(m_TileTooltip, m_Cursor->GetCurrentTileObject());
 
 	//Next, check to see if there is a unit occupying the tile, and of what type it is
-	if (m_Cursor->SearchForUnitObject(m_Actors, m_MapLimit.x))
+	if (m_Cursor->SearchForUnitObject(m_Occupancy, m_Actors))
 	{
 
 		if (static_cast<UnitEntity*>(m_Cursor->GetCurrentObject())->GetUnitTeamID() == m_CurrentTeamID)
@@ -2450,7 +2422,7 @@ void MainGameMode::UpdateCursorFreeMode()
 void MainGameMode::UpdateCursorTargetingMode()
 {
 	//Updates the cursor, looking only for a second unit
-	if (m_Cursor->SearchForSecondUnitObject(m_Actors, m_MapLimit.x))
+	if (m_Cursor->SearchForSecondUnitObject(m_Occupancy, m_Actors))
 	{
 
 		//Friendly unit
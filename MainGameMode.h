@@ -6,6 +6,10 @@
 #include "2DCameraTypes.h"			//Scene Management
 #include "MapTilePathfinding.h"		//Pathfinding algorithm for grid
 #include "TargetingSystems.h"		//For mapping unit attack range when called
+#include "ConnectivityMap.h"		//Reachability labels for the map
+#include "LandmarkHeuristic.h"		//Terrain aware search heuristic
+#include "LineOfSight.h"			//Skill line of sight
+#include "UnitOccupancy.h"			//Unit on each tile
 
 //Forward Dec
 class CursorEntity;
@@ -187,9 +191,9 @@ private:
 	//Setup gameover menu
 	void SetupGameOverMenu(int teamWinID);
 
-	//Captures tiles within grid range and enable grid effect (pass team id for where to draw grid)
+	//Fills the placement overlay with the current teams placement area
 	void EnablePlacementGrid();
-	//Release current grid, disabling grid effect before losing pointer
+	//Clears the placement overlay
 	void DisablePlacementGrid();
 	//Check if tile is inside of placement grid
 	bool IsTileInPlacementGrid(MapTile* tile);
@@ -210,6 +214,8 @@ private:
 	void SetDeathAnim(UnitEntity* unit);
 	//AOE
 	void AOE();
+	//On request (R while targeting), moves the cursor onto the enemy where the selected AoE skill hits the most enemies (leaves it if none are in reach)
+	void AimAoEAtBestPlacement();
 
 	/////////////////
 	/// Utilities ///
@@ -231,12 +237,24 @@ private:
 	/// Managers & Functionality ///
 	////////////////////////////////
 
+	//Structure of arrays mirror of the tile map, searched by the pathfinder and targeting system
+	NavGrid m_NavGrid;
+	//Which parts of the map each unit type can travel between
+	ConnectivityMap m_Connectivity;
+	//Landmark distances guiding path searches around expensive terrain (cached per map)
+	LandmarkHeuristic m_Landmarks;
+	//What each tile can see out to the longest skill range, so skills can't target through walls
+	VisibilityCache m_Visibility;
 	//Game Object that manages pathfinding in the context of a grid
 	MapTilePathfinder m_PathFinder;
 	//Manages the matrix for shifting the scene around, producing a camera effect
 	FixedDist2DCamera m_Camera;
-	//Manages a manifest of highlighted tiles & operations for enabling grid effects
+	//Manages the attack and AoE ranges of skills
 	DiamondRadiusTargeting m_TargetingSystem;
+	//Movement, path, attack, AoE and placement grids, one bit per nav grid cell (drawn over the terrain)
+	TileOverlayLayers m_Overlays;
+	//Which unit stands on each tile, indexed by handle into m_Actors
+	UnitOccupancyMap m_Occupancy;
 	//Tracks the internal mode state
 	MODE_STATE m_State;
 
@@ -281,6 +299,8 @@ private:
 	//Stores a copy pointer for each teams unit for operations & quick access
 	std::vector<UnitEntity*> m_TeamOne;
 	std::vector<UnitEntity*> m_TeamTwo;
+	//Enemies of the acting unit, rasterised by the AoE auto aim
+	std::vector<AoETarget> m_AoETargets;
 
 
 	////////////
@@ -302,8 +322,7 @@ private:
 	/// UI ///
 	//////////
 
-	//Placement grid data
-	std::vector<MapTile*> m_PlacementGridTiles;
+	//Placement grid data (the grid itself is held in the PLACEMENT overlay)
 	DirectX::XMINT2 m_PlacementGridSize = { 5, 5 };
 	DirectX::XMINT2 m_TeamOneGridStart = { 9, 38 };
 	DirectX::XMINT2 m_TeamTwoGridStart = { 29, 6 };
@@ -2,8 +2,9 @@
 
 #include "EntityInterface.h"
 #include "GameTypes.h"			//Tile Properties Container
+#include "NavGrid.h"			//Grid topology
 
-const int NUM_OF_NEIGHBOURS = 4;
+const int NUM_OF_NEIGHBOURS = NavGrid::NEIGHBOUR_COUNT;
 
 class MapTile : public EntityInterface
 {
@@ -32,10 +33,8 @@ public:
 
 	//Set all tile properties at once
 	void SetTileProperties(TileProperties& newProperties) { m_Properties = newProperties; }
-	//0 = North, 1 = East, 2 = South, 3 = West
+	//Direction order set by NavGrid::Topology (0 = North, 1 = East, 2 = South, 3 = West for the 4 way map)
 	void SetNeighbourAtIndex(int index, MapTile* neighbour) { m_Pointers[index] = neighbour; }
-	//Set GridEnabled state
-	void SetDrawGridFlag(bool enableGrid) { m_EnableGridDraw = enableGrid; }
 
 
 	///////////
@@ -43,9 +42,10 @@ public:
 	///////////
 
 	TileProperties& GetTileProperties() { return m_Properties; }
-	//0 = North, 1 = East, 2 = South, 3 = West
+	//Direction order set by NavGrid::Topology
 	MapTile* GetNeighbourAtIndex(int index) { return m_Pointers[index]; }
 
+	//Overlay sprite, drawn over the tile by the mode while any tile overlay holds it (see TileOverlayLayers)
 	Sprite& GetGridSprite() { return m_GridSprite; }
 
 	std::string GetTileTypeAsString();
@@ -54,7 +54,10 @@ public:
 	/// Operations ///
 	//////////////////
 
-	void SetOccupationStatus(bool status) { m_Properties.occupied = status; }
+	//Updates the occupied flag, keeping the bound nav grid in sync
+	void SetOccupationStatus(bool status);
+	//Binds the nav grid cell that mirrors this tile
+	void BindNavGrid(NavGrid* grid, int cell) { m_NavGrid = grid; m_NavCell = cell; }
 	//Mirrors relevant data from the tile to the grid for positional requirements
 	void MirrorTileToGridData();
 
@@ -64,46 +67,24 @@ public:
 		using coordinates and max row size.
 	*/
 	static MapTile* FindTileInArray(std::vector<MapTile*>& container, DirectX::XMINT2& coords, int rowSize);
-
-
-	////////////////////////
-	/// A* Functionality ///
-	////////////////////////
-
-	void CalculateCosts(DirectX::XMINT2& origin, DirectX::XMINT2& target);
-
-	float& GetGCost() { return m_GCost; }
-	float& GetHCost() { return m_HCost; }
-	float& GetFCost() { return m_FCost; }
-	MapTile*& GetParentTile() { return m_ParentTile; }
+	/*
+		Index of the tile at the coordinates in a container of tiles (stored left->right, top->bot).
+		rowSize is the highest x coordinate of the map (one less than its width), as held by the modes map limit.
+	*/
+	static int CoordsToTileIndex(const DirectX::XMINT2& coords, int rowSize) { return coords.x + coords.y * (rowSize + 1); }
 
 
 private:
 
 	//Tile Grid Effect Sprite
 	Sprite m_GridSprite;
-	//Controlling flag for both update and draws for grid sprite
-	bool m_EnableGridDraw = false;
 
-	//0 = North, 1 = East, 2 = South, 3 = West
-	MapTile* m_Pointers[4] = { nullptr, nullptr, nullptr, nullptr };
+	//Neighbouring tiles, in NavGrid::Topology direction order
+	MapTile* m_Pointers[NUM_OF_NEIGHBOURS] = {};
 	TileProperties m_Properties;
 
-	////////////////////////
-	/// A* Functionality ///
-	////////////////////////
-
-	void IsNumberNegative(float& num) { if (num < 0)	num = -num; }
-
-	//Distance from origin
-	float m_GCost = 0;
-	//Distance to target
-	float m_HCost = 0;
-	//Sum of G and H
-	float m_FCost = 0;
-	//Parent tile in terms of the path
-	MapTile* m_ParentTile = nullptr;
-
-
+	//Nav grid mirroring this tile (if any) and the cell index in it
+	NavGrid* m_NavGrid = nullptr;
+	int m_NavCell = -1;
 
 };
@@ -1,5 +1,4 @@
 #include "MapTilePathfinding.h"
-#include "TextureEnums.h"
 
 using namespace DirectX;
 
@@ -8,307 +7,256 @@ MapTilePathfinder::MapTilePathfinder()
 	
 }
 
-void MapTilePathfinder::GenerateTileGrid(std::vector<MapTile*>& tileContainer, UnitEntity* unit, int mapRowLength)
+void MapTilePathfinder::GenerateTileGrid(std::vector<MapTile*>& tileContainer, UnitEntity* unit)
 {
 
 	//
 	//Setup
 	//
 
-	//Create two holding containers
-	std::set<Node> newNodes;
-	std::set<Node> tempNodes;
+	//Hold on to the map details for later A* queries
+	m_TileContainer = &tileContainer;
+	m_UnitType = static_cast<int>(unit->GetUnitType());
+	m_MoveBudget = NavGrid::QuantiseBudget(unit->GetClassTotals().TotalMovespeed);
 
-	//Grab unit coordinates for brevity
-	XMINT2& coords = unit->GetMapCoordinates();
-
-	//Add Starting root node and setup
-	Node rootNode;
-	rootNode.tile = tileContainer.at((coords.x + coords.y) + coords.y * mapRowLength);
-	rootNode.remainingCost = unit->GetClassTotals().TotalMovespeed;
-
-	//
-	//Algorithm Preamble
-	//
-
-	//Check neighbours of the initial node and run algorithm to for starting chain
-	for (int i(0); i < NUM_OF_NEIGHBOURS; ++i)
+	int cellCount = m_NavGrid->GetCellCount();
+	if (static_cast<int>(m_PreviewPath.capacity()) < cellCount)
 	{
-		if (rootNode.tile->GetNeighbourAtIndex(i))
-		{
-			if (MoveValidationPolicy(rootNode, rootNode.tile->GetNeighbourAtIndex(i), unit))
-			{
-				NodeValidation(rootNode, newNodes, i);
-			}
-		}
+		m_PreviewPath.reserve(cellCount);
+		m_PreviewScratch.reserve(cellCount);
 	}
 
-	//Add the starting node to the manifest (we intend to remove this later, but prevents needless insertions and odd behaviours)
-	m_GridManifest.insert(rootNode.tile);
-	//Add starting nodes to manifest
-	for (auto& t : newNodes)
-		m_GridManifest.insert(t.tile);
+	//Any previous preview belongs to an old range tree, so forget it
+	m_Overlays->Clear(TILE_OVERLAY::PATH);
+	m_PreviewPath.clear();
 
+	//Grab unit coordinates for brevity
+	XMINT2& coords = unit->GetMapCoordinates();
+	int originCell = m_NavGrid->CoordsToCell(coords.x, coords.y);
 
 	//
 	//Main Algorithm
 	//
 
-	//Using starting nodes, run algorithm to explore and evaluate new nodes till all possible nodes have been found
-	while (newNodes.size() != 0)
-	{
-		//For each unresolved Tile, check its neighbouring nodes for existance & then if traversable
-		for (auto& node : newNodes)
-		{
-			for (int i(0); i < NUM_OF_NEIGHBOURS; ++i)
-			{
-				if (node.tile->GetNeighbourAtIndex(i))
-				{
-					if (MoveValidationPolicy(node, node.tile->GetNeighbourAtIndex(i), unit))
-					{
-						NodeValidation(node, tempNodes, i);
-					}
-				}
-			}
-		}
-
-		//Store the new tiles for the next cycle
-		newNodes = tempNodes;
-		//Clear for next cycle
-		tempNodes.clear();
-		//Extract the addresses from the newly added nodes into a manifest
-		for (auto& t : newNodes)
-			m_GridManifest.insert(t.tile);
-	}
+	m_RangeSearch.Run(*m_NavGrid, originCell, m_UnitType, m_MoveBudget);
 
 	//
 	//Post Cleanup
 	//
 
-	//No longer need the original tile in the manifest, so remove it
-	m_GridManifest.erase(rootNode.tile);
+	//Add every reached cell to the movement overlay (bar the units own cell), finding the cheapest for the A* heuristic
+	m_MinMoveCost = m_NavGrid->GetMoveCost(originCell);
+	for (int cell : m_RangeSearch.GetReachedCells())
+	{
+		if (cell == originCell)
+			continue;
+
+		m_Overlays->Set(TILE_OVERLAY::MOVEMENT, cell);
+
+		if (m_NavGrid->GetMoveCost(cell) < m_MinMoveCost)
+			m_MinMoveCost = m_NavGrid->GetMoveCost(cell);
+	}
 
 }
 
 bool MapTilePathfinder::IsTileInGrid(MapTile* tile)
 {
-	//Attempt to find a match for the tile
-	if (std::find(m_GridManifest.begin(), m_GridManifest.end(), tile) != m_GridManifest.end())
-		return true;
-	else
+	//No grid generated yet
+	if (!m_TileContainer)
 		return false;
+
+	//Constant time check against the movement overlay
+	return m_Overlays->Test(TILE_OVERLAY::MOVEMENT, GetTileCell(tile));
 }
 
 void MapTilePathfinder::ReleaseManifest()
 {
-	for (auto& m : m_GridManifest)
-	{
-		//Turn off/disable grid
-		m->GetParentTile() = nullptr;
-		RemoveGridEffect(m);
-	}
+	ClearPathPreview();
+	m_Overlays->Clear(TILE_OVERLAY::MOVEMENT);
+}
 
-	m_GridManifest.clear();
+void MapTilePathfinder::ResetGridEffectToDefault()
+{
+	//Drop any preview or highlighted path, leaving the movement overlay showing
+	ClearPathPreview();
 }
 
-bool MapTilePathfinder::MoveValidationPolicy(const Node& node, MapTile* neighbour, UnitEntity* unit)
+PathResult MapTilePathfinder::FindPath(MapTile* startingTile, MapTile* targetTile)
 {
-	return ((node.remainingCost - neighbour->GetTileProperties().moveCost >= 0) &&					//Is there enough cost left?
-			(neighbour->GetTileProperties().occupied == false) &&									//Is the tile occupied?
-			(neighbour->GetTileProperties().impassable == false) &&									//Is the tile impassable?
-			(static_cast<int>(unit->GetUnitType()) == neighbour->GetTileProperties().terrainTypeID) //Can the unit navigate to the tile type?
-	);
+	//Needs a generated grid to search within (the units own tile sits outside the manifest)
+	if (!m_TileContainer || (targetTile != startingTile && !IsTileInGrid(targetTile)))
+		return PathResult();
+
+	//Describe the search in terms of the unit the grid was generated for
+	PathQuery query;
+	query.startCell = GetTileCell(startingTile);
+	query.goalCell = GetTileCell(targetTile);
+	query.unitType = m_UnitType;
+	query.maxCost = m_MoveBudget;
+	query.minMoveCost = m_MinMoveCost;
+	query.searchMethod = m_Landmarks ? PATH_SEARCH_METHOD::ALT : PATH_SEARCH_METHOD::A_STAR;
+	query.landmarks = m_Landmarks;
+	query.connectivity = m_Connectivity;
+	query.costLayers = m_CostLayers;
+	query.trace = m_Trace;
+
+	return RunPathQuery(query, *m_NavGrid);
 }
 
-void MapTilePathfinder::NodeValidation(const Node& node, std::set<Node>& container, int index)
+PathResult MapTilePathfinder::FindPathToNearest(MapTile* startingTile, const std::vector<MapTile*>& goalTiles, bool withinGrid)
 {
-	//Start with a new node object
-	Node newNode;
-
-	//Do the minimum required work for algorithm (as node may be discarded)
-	newNode.remainingCost = node.remainingCost - node.tile->GetNeighbourAtIndex(index)->GetTileProperties().moveCost;
-	newNode.tile = node.tile->GetNeighbourAtIndex(index);
-
-	/*
-		As the algorithm doesn't care on how its finds the tile, only that it does, it might reach a tile and
-		have provide it a less than optimal value for the remaining moves as another route could reach it better.
-		So we check this new node against another node of the same coordinates. If a match is found, we then evaluate
-		the better option of the two by comparing remaining costs. If the existing nodes cost is better (higher remaining),
-		then we discard the new node as it evaluated poorly. If the new node is better, we erase the old node and insert the
-		new one.
-
-		If no node is found at all, then this new entry is inserted into the container as usual.
-	*/
-	std::set<Node>::iterator it = container.find(newNode);
-	if (it != container.end())	//Found match
-	{
-		//Is the new node better? If not do nothing.
-		if (it->remainingCost < newNode.remainingCost)
-		{
-			//Discard the existing, worse node
-			container.erase(it);
+	if (!m_TileContainer)
+		return PathResult();
 
-			//Apply/Enable grid effect
-			ApplyGridEffect(newNode.tile);
+	//Gather the goals as cells (sizing the set only if the grid has grown)
+	if (m_GoalSet.GetCellCapacity() < m_NavGrid->GetCellCount())
+		m_GoalSet.Resize(m_NavGrid->GetCellCount());
+	else
+		m_GoalSet.Clear();
+	for (auto& t : goalTiles)
+		m_GoalSet.Add(GetTileCell(t));
+
+	PathQuery query;
+	query.startCell = GetTileCell(startingTile);
+	query.goals = &m_GoalSet;
+	query.unitType = m_UnitType;
+	query.maxCost = withinGrid ? m_MoveBudget : INT32_MAX;
+	query.minMoveCost = withinGrid ? m_MinMoveCost : -1;
+	query.connectivity = m_Connectivity;
+	query.costLayers = m_CostLayers;
+	query.trace = m_Trace;
+
+	return RunPathQuery(query, *m_NavGrid);
+}
 
-			//Insert new node
-			container.insert(newNode);
-		}
+const std::vector<AttackOption>& MapTilePathfinder::FindAttackOptions(UnitEntity* unit, const std::vector<UnitEntity*>& targets)
+{
+	//Where can the unit stand this turn
+	XMINT2& coords = unit->GetMapCoordinates();
+	m_PlanningRangeSearch.Run(*m_NavGrid, m_NavGrid->CoordsToCell(coords.x, coords.y), static_cast<int>(unit->GetUnitType()),
+		NavGrid::QuantiseBudget(unit->GetClassTotals().TotalMovespeed));
+
+	m_AttackTargetCells.clear();
+	for (auto& t : targets)
+	{
+		XMINT2& targetCoords = t->GetMapCoordinates();
+		m_AttackTargetCells.push_back(m_NavGrid->CoordsToCell(targetCoords.x, targetCoords.y));
 	}
-	//No match meaning this is first time this tile has been checked.
-	else	
+
+	//The search dilates by the topology shape, so search each skill with the smallest one holding its shape
+	m_AttackSkillRanges.clear();
+	m_AttackSkillShapes.clear();
+	bool allDiamonds = true;
+	for (int i(0); i < unit->GetSkillCount(); ++i)
 	{
-		//Apply/Enable grid effect
-		ApplyGridEffect(newNode.tile);
+		SkillInterface* skill = unit->GetSkillAtIndex(i);
+		m_AttackSkillShapes.push_back(skill->GetRangeShape());
+		int range = skill->GetSkillRange();
+		m_AttackSkillRanges.push_back(range < 0 ? range : NavGrid::Shapes::GetBoundingRange(skill->GetRangeShape(), SHAPE_FACING::ALL, range));
+		allDiamonds = allDiamonds && skill->GetRangeShape() == RANGE_SHAPE::DIAMOND;
+	}
 
-		//Insert new node
-		container.insert(newNode);
+	m_AttackSearch.Run(*m_NavGrid, m_PlanningRangeSearch.GetReachedCells(), m_AttackTargetCells, m_AttackSkillRanges);
+	if (!m_Visibility && allDiamonds)
+		return m_AttackSearch.GetOptions();
+
+	//Then trim the options back to each skills shape, and to what each standing cell can see
+	m_VisibleAttackOptions.clear();
+	for (auto& o : m_AttackSearch.GetOptions())
+	{
+		int target = m_AttackTargetCells[o.targetIndex];
+		int dx = m_NavGrid->GetCellX(target) - m_NavGrid->GetCellX(o.standingCell);
+		int dy = m_NavGrid->GetCellY(target) - m_NavGrid->GetCellY(o.standingCell);
+		if (!NavGrid::Shapes::Contains(m_AttackSkillShapes[o.skillIndex], SHAPE_FACING::ALL, unit->GetSkillAtIndex(o.skillIndex)->GetSkillRange(), dx, dy))
+			continue;
+		if (m_Visibility && !m_Visibility->IsVisible(o.standingCell, target))
+			continue;
+		m_VisibleAttackOptions.push_back(o);
 	}
+	return m_VisibleAttackOptions;
 }
 
-void MapTilePathfinder::ApplyGridEffect(MapTile* tile)
+void MapTilePathfinder::PlanSquadMove(const std::vector<UnitEntity*>& units, const std::vector<MapTile*>& goalTiles,
+	COOPERATIVE_CONFLICTS mode)
 {
-	tile->SetDrawGridFlag(true);
-	tile->GetGridSprite().SetFrame(21);
+	m_SquadRequests.clear();
+	for (int i(0); i < static_cast<int>(units.size()); ++i)
+	{
+		XMINT2& coords = units[i]->GetMapCoordinates();
+		CooperativeMoveRequest r;
+		r.startCell = m_NavGrid->CoordsToCell(coords.x, coords.y);
+		r.goalCell = GetTileCell(goalTiles[i]);
+		r.unitType = static_cast<int>(units[i]->GetUnitType());
+		r.maxCost = NavGrid::QuantiseBudget(units[i]->GetClassTotals().TotalMovespeed);
+		m_SquadRequests.push_back(r);
+	}
+
+	m_SquadPlanner.SetConflictMode(mode);
+	m_SquadPlanner.PlanBatch(*m_NavGrid, m_SquadRequests);
 }
 
-void MapTilePathfinder::RemoveGridEffect(MapTile* tile)
+void MapTilePathfinder::HighlightPath(const PathResult& path)
 {
-	tile->SetDrawGridFlag(false);
+	//Replaces any preview
+	ClearPathPreview();
+	for (int cell : path)
+		m_Overlays->Set(TILE_OVERLAY::PATH, cell);
 }
 
-void MapTilePathfinder::ResetGridEffectToDefault()
+void MapTilePathfinder::PreviewPath(MapTile* targetTile)
 {
-	for (auto& a : m_GridManifest)
+	if (!IsTileInGrid(targetTile))
 	{
-		a->GetGridSprite().SetFrame(21);
-		a->GetParentTile() = nullptr;
-		a->SetDrawGridFlag(true);
+		ClearPathPreview();
+		return;
 	}
-}
-
-void MapTilePathfinder::RunAStarAlgorithm(MapTile* startingTile, MapTile* targetTile)
-{
-	//This container holds nodes that need to be evaluated
-	std::vector<MapTile*> unevaluatedTiles;
-	//This container holds the nodes that have been evaluated
-	std::vector<MapTile*> evaluatedTiles;
 
-	//Setup starting node
-	startingTile->CalculateCosts(startingTile->GetMapCoordinates(), targetTile->GetMapCoordinates());
+	//With no preview up, the path overlay may still hold a highlighted path, so start from empty
+	if (m_PreviewPath.empty())
+		m_Overlays->Clear(TILE_OVERLAY::PATH);
 
-	//Push starting node into open nodes
-	unevaluatedTiles.push_back(startingTile);
+	const std::vector<int>& parents = m_RangeSearch.GetParents();
 
-	while (unevaluatedTiles.size() > 0)
+	//Walk up the tree from the target till the old preview is joined (paths share the origin, so this is where they converge)
+	m_PreviewScratch.clear();
+	int junction = -1;
+	for (int cell = GetTileCell(targetTile); cell != -1; cell = parents[cell])
 	{
-		MapTile* currentTile = nullptr;
-
-		//Find the lowest F Cost node in open nodes
-		FindLowestCostedNode(currentTile, unevaluatedTiles);
-		//Remove the current node from unevaluated container
-		RemoveNodeFromContainer(currentTile, unevaluatedTiles);
-		//Store it evaluated
-		evaluatedTiles.push_back(currentTile);
-
-		//Check if the current node is the target node break out
-		if ((currentTile->GetMapCoordinates().x == targetTile->GetMapCoordinates().x) &&
-			(currentTile->GetMapCoordinates().y == targetTile->GetMapCoordinates().y))
-
+		if (m_Overlays->Test(TILE_OVERLAY::PATH, cell))
 		{
-			//Enable effect on each tile in path
-			EnablePath(currentTile);
-			return;
-		}
-
-		//Start looking at the neighbouring tiles
-		for (int i(0); i < NUM_OF_NEIGHBOURS; ++i)
-		{
-			//Validate if this neighbour needs evaluating or not
-			if (currentTile->GetNeighbourAtIndex(i) &&
-				IsTileInGrid(currentTile->GetNeighbourAtIndex(i)) &&
-				!currentTile->GetNeighbourAtIndex(i)->GetTileProperties().impassable &&
-				!IsNodeInContainer(currentTile->GetNeighbourAtIndex(i), evaluatedTiles))
-			{
-				//Create new node and calculate information about the node
-				MapTile* newTile = currentTile->GetNeighbourAtIndex(i);
-				newTile->CalculateCosts(startingTile->GetMapCoordinates(), targetTile->GetMapCoordinates());
-
-				//Check if H is lower OR not inside the open nodes container
-				if ((newTile->GetHCost() < currentTile->GetHCost()) || !IsNodeInContainer(newTile, unevaluatedTiles))
-				{
-					//Set the new nodes parent at the currently examined tile
-					newTile->GetParentTile() = currentTile;
-
-					//If the node isnt in the container
-					if (!IsNodeInContainer(newTile, unevaluatedTiles))
-					{
-						unevaluatedTiles.push_back(newTile);
-					}
-				}
-			}
+			junction = cell;
+			break;
 		}
+		m_PreviewScratch.push_back(cell);
+	}
 
-	};
-}
+	//Drop the old branch below the junction
+	size_t oldBranchLength = 0;
+	while (oldBranchLength < m_PreviewPath.size() && m_PreviewPath[oldBranchLength] != junction)
+		m_Overlays->Reset(TILE_OVERLAY::PATH, m_PreviewPath[oldBranchLength++]);
 
-void MapTilePathfinder::FindLowestCostedNode(MapTile*& node, std::vector<MapTile*>& nodes)
-{
-	//Set node to first node
-	node = nodes[0];
+	//Highlight the new branch
+	for (int cell : m_PreviewScratch)
+		m_Overlays->Set(TILE_OVERLAY::PATH, cell);
 
-	for (int i(0); i < nodes.size(); ++i)
-	{
-		//If the checked node is lower than first held node, replace it
-		if ((nodes[i]->GetFCost() < node->GetFCost()) || (nodes[i]->GetFCost() == node->GetFCost() && nodes[i]->GetHCost() < node->GetHCost()))
-			node = nodes[i];
-	}
+	//Swap the old branch for the new one, keeping the shared section
+	m_PreviewPath.erase(m_PreviewPath.begin(), m_PreviewPath.begin() + oldBranchLength);
+	m_PreviewPath.insert(m_PreviewPath.begin(), m_PreviewScratch.begin(), m_PreviewScratch.end());
 }
 
-void MapTilePathfinder::RemoveNodeFromContainer(MapTile*& node, std::vector<MapTile*>& nodes)
+void MapTilePathfinder::ClearPathPreview()
 {
-	for (int i(0); i < nodes.size(); ++i)
-	{
-		if (node == nodes[i])
-		{
-			nodes.erase(nodes.begin() + i);
-		}
-	}
+	m_Overlays->Clear(TILE_OVERLAY::PATH);
+	m_PreviewPath.clear();
 }
 
-bool MapTilePathfinder::IsNodeInContainer(MapTile* node, std::vector<MapTile*>& nodes)
+void MapTilePathfinder::RunAStarAlgorithm(MapTile* startingTile, MapTile* targetTile)
 {
-	for (int i(0); i < nodes.size(); ++i)
-	{
-		//If the same tile is found, return true
-		if (node == nodes[i])
-			return true;
-	}
-
-	//Else no tile found, return false
-	return false;
+	HighlightPath(FindPath(startingTile, targetTile));
 }
 
-void MapTilePathfinder::EnablePath(MapTile*& endpoint)
+int MapTilePathfinder::GetTileCell(MapTile* tile)
 {
-	bool pathDone = false;
-	
-	MapTile* currentNode = endpoint;
-
-	while (!pathDone)
-	{
-		currentNode->GetGridSprite().SetFrame(UI_ATLAS_01_FRAMES::ATTACK_TILE_HIGHLIGHT);
-		
-		//If the node has a parent 
-		if (currentNode->GetParentTile())
-		{
-			currentNode = currentNode->GetParentTile();
-		}
-		//This must be the origin point, so end drawing
-		else
-		{
-			pathDone = true;
-		}
-
-	}
+	XMINT2& coords = tile->GetMapCoordinates();
+	return m_NavGrid->CoordsToCell(coords.x, coords.y);
 }
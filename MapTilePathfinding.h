@@ -1,92 +1,161 @@
 #pragma once
-#include <set>
 
-#include "MapTile.h"		//Object method uses
-#include "UnitEntity.h"		//Game Unit
-
-//Supporting type for use in the pathfinding algorithm
-struct Node
-{
-	Node() {}
-	~Node() { tile = nullptr; }
-
-	MapTile* tile = nullptr;
-	float remainingCost = -1;
-
-	//Comparison operator
-	bool operator <(const Node& pt) const
-	{
-		DirectX::XMINT2 coords = tile->GetMapCoordinates();
-		DirectX::XMINT2 lhCoords = pt.tile->GetMapCoordinates();
-		return (coords.x < lhCoords.x) || ((!(lhCoords.x < coords.x)) && (coords.y < lhCoords.y));
-	}
-};
+#include "MapTile.h"					//Object method uses
+#include "UnitEntity.h"					//Game Unit
+#include "NavGrid.h"					//Searched grid
+#include "TileOverlay.h"				//Grid and path preview overlays
+#include "PathQuery.h"					//Reentrant A* queries
+#include "PathCostLayers.h"				//Threat aware pathing
+#include "LandmarkHeuristic.h"			//ALT heuristic
+#include "MovementRange.h"				//Movement range engine
+#include "ConnectivityMap.h"			//Unreachable goal rejection
+#include "AttackRange.h"				//Attack option search
+#include "CooperativePathPlanner.h"		//Squad moves
+#include "LineOfSight.h"				//Walls blocking attacks
 
 class MapTilePathfinder
 {
 public:
 
 	MapTilePathfinder();
-	~MapTilePathfinder() { m_GridManifest.clear(); }
+	~MapTilePathfinder() {}
+
+	///////////
+	/// Set ///
+	///////////
+
+	//Grid that all searches run on (must mirror the tile container passed in for generation)
+	void SetNavGrid(const NavGrid* grid) { m_NavGrid = grid; }
+	//Overlays the grid (MOVEMENT) and path preview (PATH) are written to, sized to the nav grid
+	void SetOverlays(TileOverlayLayers* overlays) { m_Overlays = overlays; }
+	//Component labels used to reject unreachable goals before searching (optional)
+	void SetConnectivityMap(const ConnectivityMap* connectivity) { m_Connectivity = connectivity; }
+	//Records every path query made through FindPath (nullptr to stop, only active if PATHFINDING_TRACE is on)
+	void SetTraceRecorder(PathTraceRecorder* trace) { m_Trace = trace; }
+	//Landmark tables, used to guide FindPath with the ALT heuristic (nullptr for plain A*)
+	void SetLandmarks(const LandmarkHeuristic* landmarks) { m_Landmarks = landmarks; }
+	//Extra costs applied to FindPath and FindPathToNearest, e.g. to steer around enemy threat (nullptr for none)
+	void SetCostLayers(const PathCostLayers* layers) { m_CostLayers = layers; }
+	//Drops attack options with no line of sight to the target (nullptr to attack through walls)
+	void SetVisibility(const VisibilityCache* visibility) { m_Visibility = visibility; }
 
 	///////////
 	/// Get ///
 	///////////
 
-	std::set<MapTile*>& GetManifest() { return m_GridManifest; }
+	//Cells of the current grid, one bit per nav grid cell
+	const TileBitset& GetManifest() const { return m_Overlays->GetBits(TILE_OVERLAY::MOVEMENT); }
+
+	//Per cell results of the last grid generation, indexed by nav grid cell (see MovementRangeSearch)
+	const std::vector<float>& GetRemainingMoves() const { return m_RangeSearch.GetRemainingMoves(); }
+	const std::vector<int>& GetParents() const { return m_RangeSearch.GetParents(); }
 
 	//////////////////
 	/// Operations ///
 	//////////////////
 
-	void GenerateTileGrid(std::vector<MapTile*>& tileContainer, UnitEntity* unit, int mapRowLength);
+	void GenerateTileGrid(std::vector<MapTile*>& tileContainer, UnitEntity* unit);
 
 	//Check to see if this tile is in the grid
 	bool IsTileInGrid(MapTile* tile);
 	
-	//Releases hold of all tiles currently highlighted.
-	//Calls a release policy on the nodes to clear the grid effect before release.
+	//Clears the grid and any path preview from the overlays
 	void ReleaseManifest();
 
 	////////////////////
 	/// A* Functions ///
 	////////////////////
 
+	//Finds a path within the current grid for the unit it was generated for (does not touch tile visuals)
+	PathResult FindPath(MapTile* startingTile, MapTile* targetTile);
+	/*
+		Finds the cheapest path to any of the goal tiles in a single search (e.g. every tile an enemy can be
+		attacked from), for the unit the grid was generated for. The goal reached is the last cell of the path.
+		Limited to the generated grid unless withinGrid is false, so AI can plan moves over several turns.
+	*/
+	PathResult FindPathToNearest(MapTile* startingTile, const std::vector<MapTile*>& goalTiles, bool withinGrid = true);
+	//Shows a found path on the path overlay, replacing any preview
+	void HighlightPath(const PathResult& path);
+
+	/*
+		Previews the path to a tile in the grid by walking back up the movement range tree from it. Only the cells
+		that differ from the previous preview are updated. Clears the preview if the tile is outside the grid.
+	*/
+	void PreviewPath(MapTile* targetTile);
+	//Removes the current preview (or highlighted path) from the path overlay
+	void ClearPathPreview();
+
+	/*
+		Finds every way the unit can attack the targets this turn: each reachable tile it could stand on, the target
+		hit and the skill slot used (target indexes follow the targets passed in). Runs its own movement range
+		search, so the current grid, preview and tile visuals are left untouched. Options out of sight of the
+		target are left out if a visibility cache is set, as are options outside a skills range shape.
+	*/
+	const std::vector<AttackOption>& FindAttackOptions(UnitEntity* unit, const std::vector<UnitEntity*>& targets);
+
+	/*
+		Plans conflict free moves for a group of units to their goal tiles in one batch, each within its own
+		movement budget. Units that can't reach their goal stay put. Plans are read back from GetSquadPlanner,
+		indexed in the order the units were passed in. Does not move units or touch tile visuals.
+	*/
+	void PlanSquadMove(const std::vector<UnitEntity*>& units, const std::vector<MapTile*>& goalTiles,
+		COOPERATIVE_CONFLICTS mode = COOPERATIVE_CONFLICTS::PASS_THROUGH);
+	const CooperativePathPlanner& GetSquadPlanner() const { return m_SquadPlanner; }
+
+	//Convenience wrapper, finding and highlighting a path in one step
 	void RunAStarAlgorithm(MapTile* startingTile, MapTile* targetTile);
 	void ResetGridEffectToDefault();
 
 	
 private:
 
-	///////////////////////////
-	/// Validation Policies ///
-	///////////////////////////
-
-	bool MoveValidationPolicy(const Node& node, MapTile* neighbour, UnitEntity* unit);
-	void NodeValidation(const Node& node, std::set<Node>& container, int index);
-
-
-	/////////////////////////////
-	/// Apply Effect Policies ///
-	/////////////////////////////
-
-	void ApplyGridEffect(MapTile* tile);
-	void RemoveGridEffect(MapTile* tile);
-
-
 	////////////////////
 	/// A* Functions ///
 	////////////////////
 
-	void FindLowestCostedNode(MapTile*& node, std::vector<MapTile*>& nodes);
-	void RemoveNodeFromContainer(MapTile*& node, std::vector<MapTile*>& nodes);
-	bool IsNodeInContainer(MapTile* node, std::vector<MapTile*>& nodes);
-	void EnablePath(MapTile*& endpoint);
+	//Converts a tile to its nav grid cell
+	int GetTileCell(MapTile* tile);
 
 	////////////
 	/// Data ///
 	////////////
 
-	std::set<MapTile*> m_GridManifest;
+	//Grid searched, and the container used to generate the current manifest
+	const NavGrid* m_NavGrid = nullptr;
+	TileOverlayLayers* m_Overlays = nullptr;
+	const ConnectivityMap* m_Connectivity = nullptr;
+	PathTraceRecorder* m_Trace = nullptr;
+	const PathCostLayers* m_CostLayers = nullptr;
+	const LandmarkHeuristic* m_Landmarks = nullptr;
+	const VisibilityCache* m_Visibility = nullptr;
+	std::vector<MapTile*>* m_TileContainer = nullptr;
+	//Cheapest fixed point move cost found in the current manifest (for heuristic scaling)
+	int m_MinMoveCost = 0;
+	//Unit type and fixed point movement budget the current manifest was generated for
+	int m_UnitType = 0;
+	int m_MoveBudget = 0;
+
+	//Goals of the last nearest goal search
+	PathGoalSet m_GoalSet;
+
+	//Range engine
+	MovementRangeSearch m_RangeSearch;
+	//Range and attack engines for planning queries, kept apart from the generated grid
+	MovementRangeSearch m_PlanningRangeSearch;
+	AttackRangeSearch m_AttackSearch;
+	std::vector<int> m_AttackTargetCells;
+	//Per skill slot, the topology range holding its range shape, then the shape itself
+	std::vector<int> m_AttackSkillRanges;
+	std::vector<RANGE_SHAPE> m_AttackSkillShapes;
+	//Options of the last attack search, less any out of sight or out of shape
+	std::vector<AttackOption> m_VisibleAttackOptions;
+	//Squad move planning
+	CooperativePathPlanner m_SquadPlanner;
+	std::vector<CooperativeMoveRequest> m_SquadRequests;
+
+	//Current path preview (target first, origin last), mirrored by the path overlay
+	std::vector<int> m_PreviewPath;
+	//Holds the new branch while a preview is updated
+	std::vector<int> m_PreviewScratch;
 
 };
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "MovementRange.h"
+
+void MovementRangeSearch::Run(const NavGrid& grid, int originCell, int unitType, int budget)
+{
+	RunSearch<NavGrid::Topology>(grid, originCell, unitType, budget);
+}
+
+template<typename Topology>
+void MovementRangeSearch::RunSearch(const NavGrid& grid, int originCell, int unitType, int budget)
+{
+	int cellCount = grid.GetCellCount();
+
+	//Entries can be queued at most the most expensive move ahead of the current distance, which sets the ring size
+	int bucketCount = Topology::MaxStepCost(grid.GetMaxMoveCost()) + 1;
+	ResizeBuffers(cellCount, bucketCount);
+
+	//Reset outputs from the previous search. Every cell it queued was settled, so it only wrote to the cells it reached
+	for (int cell : m_ReachedCells)
+	{
+		m_Distances[cell] = INT32_MAX;
+		m_RemainingMoves[cell] = -1.f;
+		m_Parents[cell] = -1;
+	}
+	m_ReachedCells.clear();
+
+	if (originCell < 0 || originCell >= cellCount || grid.IsBorder(originCell))
+		return;
+
+	int stride = grid.GetStride();
+
+	//Queue the origin at no cost
+	m_Distances[originCell] = 0;
+	m_Buckets[0].push_back(originCell);
+	int queuedCount = 1;
+
+	//Sweep the buckets in distance order till nothing is left queued (nothing is queued over budget)
+	for (int distance(0); queuedCount > 0; ++distance)
+	{
+		std::vector<int>& bucket = m_Buckets[distance % bucketCount];
+
+		//Index loop, as zero cost cells can queue into the bucket being processed
+		for (size_t k(0); k < bucket.size(); ++k)
+		{
+			int cell = bucket[k];
+			--queuedCount;
+
+			//Skip stale entries (already settled, or since improved upon)
+			if (m_RemainingMoves[cell] >= 0.f || m_Distances[cell] != distance)
+				continue;
+
+			//Settle the cell
+			m_RemainingMoves[cell] = static_cast<float>(budget - distance) / NavGrid::MOVE_COST_SCALE;
+			m_ReachedCells.push_back(cell);
+
+			//Relax each neighbour (the grid border blocks any moves off the map)
+			ForEachDirection<Topology>([&](auto direction)
+			{
+				int neighbour = cell + Topology::Offset(direction, stride);
+				if (!grid.CanEnter(neighbour, unitType))
+					return;
+
+				//Is there enough movement left, and is this the cheapest route found so far?
+				int newDistance = distance + Topology::StepCost(direction, grid.GetMoveCost(neighbour));
+				if (newDistance > budget || newDistance >= m_Distances[neighbour])
+					return;
+
+				m_Distances[neighbour] = newDistance;
+				m_Parents[neighbour] = cell;
+				m_Buckets[newDistance % bucketCount].push_back(neighbour);
+				++queuedCount;
+			});
+		}
+
+		bucket.clear();
+	}
+}
+
+void MovementRangeSearch::ResizeBuffers(int cellCount, int bucketCount)
+{
+	if (static_cast<int>(m_Distances.size()) < cellCount)
+	{
+		m_Distances.resize(cellCount, INT32_MAX);
+		m_RemainingMoves.resize(cellCount, -1.f);
+		m_Parents.resize(cellCount, -1);
+		m_ReachedCells.reserve(cellCount);
+	}
+	if (static_cast<int>(m_Buckets.size()) < bucketCount)
+		m_Buckets.resize(bucketCount);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "NavGrid.h"		//Searched grid
+
+/*
+	Movement range engine. Runs a bucket queue (Dial) Dijkstra from a single origin over a NavGrid, finding every
+	cell reachable within a movement budget along with the cheapest way to reach it.
+
+	Move costs are held by the grid as small fixed point integers (NavGrid::MOVE_COST_SCALE per whole move).
+	This lets the open list be a ring of buckets indexed by distance rather than a sorted container, making a
+	search O(cells + edges) over the cells it reaches. All containers are reused between searches, so a search does
+	not allocate once warm, and only the cells the last search reached are reset rather than the whole map.
+*/
+class MovementRangeSearch
+{
+public:
+
+	MovementRangeSearch() {}
+	~MovementRangeSearch() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Movement left after reaching each cell (-1 if unreachable)
+	const std::vector<float>& GetRemainingMoves() const { return m_RemainingMoves; }
+	//Previous cell on the cheapest route to each cell (-1 if unreachable or the origin)
+	const std::vector<int>& GetParents() const { return m_Parents; }
+	//Every reachable cell (origin included), in the order they were settled (cheapest first)
+	const std::vector<int>& GetReachedCells() const { return m_ReachedCells; }
+
+	bool IsCellReached(int cell) const { return m_RemainingMoves[cell] >= 0.f; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	/*
+		Finds the movement range around the origin cell for a unit of the given type (UnitEntity::UNIT_TYPE).
+		Budget is in fixed point (see NavGrid::QuantiseBudget). The origin itself is not checked, as the moving
+		unit will be occupying it.
+	*/
+	void Run(const NavGrid& grid, int originCell, int unitType, int budget);
+
+private:
+
+	//Search body, with the neighbour loop unrolled for the topology
+	template<typename Topology>
+	void RunSearch(const NavGrid& grid, int originCell, int unitType, int budget);
+
+	//Sizes the containers to the grid (only allocates if the grid has grown, new cells start unreached)
+	void ResizeBuffers(int cellCount, int bucketCount);
+
+	////////////
+	/// Data ///
+	////////////
+
+	//Fixed point distance from the origin per cell
+	std::vector<int> m_Distances;
+	//Output arrays, see Get section
+	std::vector<float> m_RemainingMoves;
+	std::vector<int> m_Parents;
+	std::vector<int> m_ReachedCells;
+
+	//Ring of buckets (one per distance modulo the ring size), holds cell indexes
+	std::vector<std::vector<int>> m_Buckets;
+};
@@ -0,0 +1,105 @@
+#include "NavGrid.h"
+
+#include <cmath>		//std::floor
+#include <algorithm>	//std::min, std::find
+
+void NavGrid::Build(const std::vector<TileProperties>& tiles, int width, int height)
+{
+	m_Width = width;
+	m_Height = height;
+	m_Stride = width + BORDER_SIZE * 2;
+
+	for (int i(0); i < NEIGHBOUR_COUNT; ++i)
+		m_NeighbourOffsets[i] = Topology::Offset(i, m_Stride);
+
+	//Start with every cell as border, then fill in the map area
+	int cellCount = m_Stride * (height + BORDER_SIZE * 2);
+	m_MoveCosts.assign(cellCount, 0);
+	m_TerrainTypes.assign(cellCount, 0xFF);
+	m_Flags.assign(cellCount, BORDER);
+
+	m_MinMoveCost = 0xFF;
+	m_MaxMoveCost = 0;
+
+	for (int y(0); y < height; ++y)
+	{
+		for (int x(0); x < width; ++x)
+		{
+			const TileProperties& props = tiles[x + y * width];
+			int cell = CoordsToCell(x, y);
+
+			m_MoveCosts[cell] = QuantiseMoveCost(props.moveCost);
+			m_TerrainTypes[cell] = static_cast<uint8_t>(props.terrainTypeID);
+			m_Flags[cell] = (props.impassable ? IMPASSABLE : 0) | (props.occupied ? OCCUPIED : 0);
+
+			//Track the cost range of tiles that can be stood on
+			if (!props.impassable)
+			{
+				m_MinMoveCost = std::min(m_MinMoveCost, m_MoveCosts[cell]);
+				m_MaxMoveCost = std::max(m_MaxMoveCost, m_MoveCosts[cell]);
+			}
+		}
+	}
+
+	//No enterable tiles at all
+	if (m_MinMoveCost > m_MaxMoveCost)
+		m_MinMoveCost = m_MaxMoveCost;
+}
+
+void NavGrid::SetMoveCost(int cell, float moveCost)
+{
+	uint8_t cost = QuantiseMoveCost(moveCost);
+	if (cost == m_MoveCosts[cell])
+		return;
+
+	m_MoveCosts[cell] = cost;
+	//Widen the cost range if needed (never narrowed, as searches only need it as a bound)
+	m_MinMoveCost = std::min(m_MinMoveCost, cost);
+	m_MaxMoveCost = std::max(m_MaxMoveCost, cost);
+	NotifyListeners(cell);
+}
+
+void NavGrid::SetTerrainType(int cell, int terrainType)
+{
+	if (static_cast<uint8_t>(terrainType) == m_TerrainTypes[cell])
+		return;
+
+	m_TerrainTypes[cell] = static_cast<uint8_t>(terrainType);
+	NotifyListeners(cell);
+}
+
+void NavGrid::AddListener(NavGridListenerInterface* listener)
+{
+	if (std::find(m_Listeners.begin(), m_Listeners.end(), listener) == m_Listeners.end())
+		m_Listeners.push_back(listener);
+}
+
+void NavGrid::RemoveListener(NavGridListenerInterface* listener)
+{
+	m_Listeners.erase(std::remove(m_Listeners.begin(), m_Listeners.end(), listener), m_Listeners.end());
+}
+
+void NavGrid::NotifyListeners(int cell)
+{
+	for (auto& l : m_Listeners)
+		l->OnCellChanged(*this, cell);
+}
+
+uint8_t NavGrid::QuantiseMoveCost(float cost)
+{
+	if (cost <= 0.f)
+		return 0;
+
+	//Round to the nearest step
+	int scaled = static_cast<int>(cost * MOVE_COST_SCALE + 0.5f);
+	return static_cast<uint8_t>(std::min(scaled, 0xFF));
+}
+
+int NavGrid::QuantiseBudget(float budget)
+{
+	if (budget <= 0.f)
+		return 0;
+
+	//Round down (with a little slack for float error) so the budget is never exceeded
+	return static_cast<int>(std::floor(budget * MOVE_COST_SCALE + 0.001f));
+}
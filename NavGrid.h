@@ -0,0 +1,196 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>	//std::min, std::max
+
+#include "GridTopology.h"		//Cell connectivity
+#include "RangeShapes.h"		//Skill range shapes
+#include "GameTypes.h"			//Tile properties
+
+class NavGrid;
+
+/*
+	Interface for systems that keep derived data from a NavGrid (precomputed costs, labels etc) and need to
+	know when a cell changes so they can update incrementally.
+*/
+class NavGridListenerInterface
+{
+public:
+
+	virtual ~NavGridListenerInterface() {}
+
+	//Called after the cost, terrain type or blocking flags of a cell change
+	virtual void OnCellChanged(const NavGrid& grid, int cell) = 0;
+};
+
+/*
+	Structure of arrays snapshot of the tile map for the search algorithms. Holds the per tile data the searches
+	need (move cost, terrain type, blocking flags) in contiguous arrays, rather than chasing MapTile pointers.
+
+	The grid is padded with a one cell border of blocked cells, so neighbours are found with fixed offsets from
+	the cell index and never need bounds checking. Cell indexes therefore differ from tile indexes, use the
+	conversion functions to move between the two.
+
+	Built once from the tile map, then kept in sync by the tiles themselves (see MapTile::SetOccupationStatus).
+	How cells connect is set at compile time by the Topology policy (see GridTopology.h).
+*/
+class NavGrid
+{
+public:
+
+	//Fixed point scale applied to move costs (one decimal place)
+	static constexpr int MOVE_COST_SCALE = 10;
+	//Width of the blocked border around the map
+	static constexpr int BORDER_SIZE = 1;
+	//Connectivity of the map, the searches and range shapes are instantiated for this policy
+	using Topology = SquareGrid4;
+	static constexpr int NEIGHBOUR_COUNT = Topology::NEIGHBOUR_COUNT;
+	//Range shapes laid out for the topology
+	using Shapes = RangeShapeLibrary<Topology>;
+
+	enum CELL_FLAGS : uint8_t
+	{
+		IMPASSABLE = 0x01,
+		OCCUPIED = 0x02,
+		BORDER = 0x04,
+		//Any of these prevent a cell being entered
+		BLOCKING_FLAGS = IMPASSABLE | OCCUPIED | BORDER
+	};
+
+	NavGrid() {}
+	~NavGrid() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	int GetWidth() const { return m_Width; }
+	int GetHeight() const { return m_Height; }
+	//Row length in cells (width plus border)
+	int GetStride() const { return m_Stride; }
+	//Total number of cells, border included
+	int GetCellCount() const { return static_cast<int>(m_Flags.size()); }
+
+	//Offset to add to a cell to reach its neighbour (direction order set by the Topology)
+	int GetNeighbourOffset(int direction) const { return m_NeighbourOffsets[direction]; }
+
+	uint8_t GetMoveCost(int cell) const { return m_MoveCosts[cell]; }
+	uint8_t GetTerrainType(int cell) const { return m_TerrainTypes[cell]; }
+	uint8_t GetFlags(int cell) const { return m_Flags[cell]; }
+	//Cheapest and most expensive move costs of any enterable cell
+	uint8_t GetMinMoveCost() const { return m_MinMoveCost; }
+	uint8_t GetMaxMoveCost() const { return m_MaxMoveCost; }
+
+	//Can a unit of the given type (UnitEntity::UNIT_TYPE) move onto this cell
+	bool CanEnter(int cell, int unitType) const
+	{
+		return !(m_Flags[cell] & BLOCKING_FLAGS) && m_TerrainTypes[cell] == unitType;
+	}
+	bool IsBorder(int cell) const { return (m_Flags[cell] & BORDER) != 0; }
+	bool IsInBounds(int x, int y) const { return x >= 0 && y >= 0 && x < m_Width && y < m_Height; }
+
+	//Calls func(x, y) for each map coordinate inside the topologys range shape around the centre, row by row
+	template<typename Func>
+	void ForEachCoordInRange(int centreX, int centreY, int range, Func&& func) const
+	{
+		for (int yOffset(-range); yOffset <= range; ++yOffset)
+		{
+			int y = centreY + yOffset;
+			if (y < 0 || y >= m_Height)
+				continue;
+
+			//Clip the span to the map edges (preventing coordinates being wrapped onto other rows)
+			int xStart = std::max(centreX + Topology::RowSpanMin(yOffset, range), 0);
+			int xEnd = std::min(centreX + Topology::RowSpanMax(yOffset, range), m_Width - 1);
+			for (int x(xStart); x <= xEnd; ++x)
+				func(x, y);
+		}
+	}
+
+	/*
+		Calls func(firstCell, lastCell) for each row span of the shape around the centre, clipped to the map edges.
+		The cells of a span run contiguously from first to last inclusive.
+	*/
+	template<typename Func>
+	void ForEachSpanInShape(int centreX, int centreY, RANGE_SHAPE shape, SHAPE_FACING facing, int radius, Func&& func) const
+	{
+		Shapes::ForEachSpan(shape, facing, radius, [&](int dy, int minX, int maxX)
+		{
+			int y = centreY + dy;
+			if (y < 0 || y >= m_Height)
+				return;
+
+			int xStart = std::max(centreX + minX, 0);
+			int xEnd = std::min(centreX + maxX, m_Width - 1);
+			if (xStart <= xEnd)
+				func(CoordsToCell(xStart, y), CoordsToCell(xEnd, y));
+		});
+	}
+
+	/////////////////////////
+	/// Index Conversions ///
+	/////////////////////////
+
+	int CoordsToCell(int x, int y) const { return (y + BORDER_SIZE) * m_Stride + x + BORDER_SIZE; }
+	int TileToCell(int tileIndex) const { return CoordsToCell(tileIndex % m_Width, tileIndex / m_Width); }
+	int CellToTile(int cell) const { return GetCellY(cell) * m_Width + GetCellX(cell); }
+	int GetCellX(int cell) const { return cell % m_Stride - BORDER_SIZE; }
+	int GetCellY(int cell) const { return cell / m_Stride - BORDER_SIZE; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	/*
+		Builds the grid from the properties of a width * height tile map (stored left->right, top->bot).
+		Tiles should then be bound to their cells (see MapTile::BindNavGrid) so that they keep the grid up to date.
+	*/
+	void Build(const std::vector<TileProperties>& tiles, int width, int height);
+
+	//Incremental updates (listeners are told of any that change the cell)
+	void SetOccupied(int cell, bool occupied) { SetFlag(cell, OCCUPIED, occupied); }
+	void SetImpassable(int cell, bool impassable) { SetFlag(cell, IMPASSABLE, impassable); }
+	void SetMoveCost(int cell, float moveCost);
+	void SetTerrainType(int cell, int terrainType);
+
+	//Register/unregister systems to be told of cell changes
+	void AddListener(NavGridListenerInterface* listener);
+	void RemoveListener(NavGridListenerInterface* listener);
+
+	//Converts a move cost or budget into fixed point
+	static uint8_t QuantiseMoveCost(float cost);
+	static int QuantiseBudget(float budget);
+
+private:
+
+	void SetFlag(int cell, CELL_FLAGS flag, bool state)
+	{
+		uint8_t flags = state ? (m_Flags[cell] | flag) : (m_Flags[cell] & ~flag);
+		if (flags != m_Flags[cell])
+		{
+			m_Flags[cell] = flags;
+			NotifyListeners(cell);
+		}
+	}
+	void NotifyListeners(int cell);
+
+	////////////
+	/// Data ///
+	////////////
+
+	int m_Width = 0;
+	int m_Height = 0;
+	int m_Stride = 0;
+	int m_NeighbourOffsets[NEIGHBOUR_COUNT] = {};
+
+	uint8_t m_MinMoveCost = 0;
+	uint8_t m_MaxMoveCost = 0;
+
+	//Per cell data, see CELL_FLAGS for the flag bits
+	std::vector<uint8_t> m_MoveCosts;
+	std::vector<uint8_t> m_TerrainTypes;
+	std::vector<uint8_t> m_Flags;
+
+	std::vector<NavGridListenerInterface*> m_Listeners;
+};
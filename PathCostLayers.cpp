@@ -0,0 +1,94 @@
+#include "PathCostLayers.h"
+#include "NavGrid.h"
+
+#include <cstring>		//std::memcpy
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define PATH_COST_LAYERS_SSE2 1
+#else
+	#define PATH_COST_LAYERS_SSE2 0
+#endif
+
+bool PathCostLayers::AddLayer(const float* costs, float weight)
+{
+	if (m_LayerCount == MAX_LAYERS || !costs)
+		return false;
+
+	Layer& l = m_Layers[m_LayerCount++];
+	l.floatCosts = costs;
+	l.byteCosts = nullptr;
+	l.weight = weight * NavGrid::MOVE_COST_SCALE;
+	m_Precomputed = false;
+	return true;
+}
+
+bool PathCostLayers::AddLayer(const uint8_t* costs, float weight)
+{
+	if (m_LayerCount == MAX_LAYERS || !costs)
+		return false;
+
+	Layer& l = m_Layers[m_LayerCount++];
+	l.floatCosts = nullptr;
+	l.byteCosts = costs;
+	l.weight = weight * NavGrid::MOVE_COST_SCALE;
+	m_Precomputed = false;
+	return true;
+}
+
+void PathCostLayers::Clear()
+{
+	m_LayerCount = 0;
+	m_Precomputed = false;
+}
+
+void PathCostLayers::Precompute(int cellCount)
+{
+	//Only allocates if the grid has grown
+	m_Combined.assign(cellCount, 0.f);
+	float* combined = m_Combined.data();
+
+	for (int i(0); i < m_LayerCount; ++i)
+	{
+		const Layer& l = m_Layers[i];
+		int cell = 0;
+
+#if PATH_COST_LAYERS_SSE2
+		//Four cells at a time
+		__m128 weight = _mm_set1_ps(l.weight);
+		__m128i zero = _mm_setzero_si128();
+		for (; cell + 4 <= cellCount; cell += 4)
+		{
+			__m128 values;
+			if (l.floatCosts)
+				values = _mm_loadu_ps(l.floatCosts + cell);
+			else
+			{
+				//Widen four bytes out to four ints, then convert (copied as a word, so no byte is shifted into the sign bit)
+				uint32_t packed;
+				std::memcpy(&packed, l.byteCosts + cell, sizeof(packed));
+				__m128i bytes = _mm_cvtsi32_si128(static_cast<int>(packed));
+				values = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+			}
+			__m128 sum = _mm_add_ps(_mm_loadu_ps(combined + cell), _mm_mul_ps(values, weight));
+			_mm_storeu_ps(combined + cell, sum);
+		}
+#endif
+
+		//Remaining cells (all of them without SSE2)
+		for (; cell < cellCount; ++cell)
+			combined[cell] += l.weight * (l.floatCosts ? l.floatCosts[cell] : static_cast<float>(l.byteCosts[cell]));
+	}
+
+	//Clamp at zero, matching the per cell sum
+	int cell = 0;
+#if PATH_COST_LAYERS_SSE2
+	__m128 zero = _mm_setzero_ps();
+	for (; cell + 4 <= cellCount; cell += 4)
+		_mm_storeu_ps(combined + cell, _mm_max_ps(_mm_loadu_ps(combined + cell), zero));
+#endif
+	for (; cell < cellCount; ++cell)
+		combined[cell] = combined[cell] > 0.f ? combined[cell] : 0.f;
+
+	m_Precomputed = true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+/*
+	Stack of additive cost layers for path queries (enemy threat, hazards, team preference etc). Each layer is a
+	dense array over the nav grid cells, of floats or bytes, scaled by a weight. Entering a cell costs its move cost
+	plus the weighted sum of every layer at that cell, in the same units as tile move costs.
+
+	Layers are read by pointer, so their arrays must cover every cell of the searched grid and stay alive (and
+	unchanged) while queries use the stack. Layers should be non-negative: the summed cost of a cell is clamped
+	at zero, so it can never make a route cheaper than its movement alone (which keeps the search heuristics exact).
+
+	Searches sum the layers as they relax each neighbour. Precompute flattens the stack into one array (summed
+	four cells at a time), so a search reads a single value per cell, which pays off when several searches are
+	run against the same layers.
+*/
+class PathCostLayers
+{
+public:
+
+	//Most layers a stack can hold
+	static constexpr int MAX_LAYERS = 8;
+
+	PathCostLayers() {}
+	~PathCostLayers() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	bool IsEmpty() const { return m_LayerCount == 0; }
+	int GetLayerCount() const { return m_LayerCount; }
+	bool IsPrecomputed() const { return m_Precomputed; }
+
+	//Fixed point extra cost of entering the cell (see NavGrid::MOVE_COST_SCALE)
+	float GetCellCost(int cell) const
+	{
+		if (m_Precomputed)
+			return m_Combined[cell];
+
+		float cost = 0.f;
+		for (int i(0); i < m_LayerCount; ++i)
+		{
+			const Layer& l = m_Layers[i];
+			cost += l.weight * (l.floatCosts ? l.floatCosts[cell] : static_cast<float>(l.byteCosts[cell]));
+		}
+		return cost > 0.f ? cost : 0.f;
+	}
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Adds a layer, returning false if the stack is full. Drops any precomputed sum.
+	bool AddLayer(const float* costs, float weight = 1.f);
+	bool AddLayer(const uint8_t* costs, float weight = 1.f);
+	//Removes every layer
+	void Clear();
+
+	//Sums the layers over a grid of the given size, searches then read the sum. Call again if a layer changes.
+	void Precompute(int cellCount);
+
+private:
+
+	struct Layer
+	{
+		//One of the two is set
+		const float* floatCosts = nullptr;
+		const uint8_t* byteCosts = nullptr;
+		//Weight, with the fixed point scale folded in
+		float weight = 0.f;
+	};
+
+	Layer m_Layers[MAX_LAYERS];
+	int m_LayerCount = 0;
+
+	std::vector<float> m_Combined;
+	bool m_Precomputed = false;
+};
@@ -0,0 +1,480 @@
+#include "PathQuery.h"
+#include "JumpPointSearch.h"
+#include "ConnectivityMap.h"
+#include "PathCostLayers.h"
+#include "LandmarkHeuristic.h"
+
+#include <algorithm>	//std::reverse, std::push_heap, std::pop_heap
+#include <type_traits>	//std::is_same
+
+PathSearchArena& PathSearchArena::GetThreadArena()
+{
+	thread_local PathSearchArena arena;
+	return arena;
+}
+
+void PathSearchArena::BeginQuery(int cellCount)
+{
+	//Only allocate if the grid has grown since the last query
+	if (static_cast<int>(m_Nodes.size()) < cellCount)
+	{
+		m_Nodes.resize(cellCount);
+		m_PathBuffer.reserve(cellCount);
+	}
+	m_OpenList.Resize(cellCount);
+	m_OpenList.Clear();
+	m_Labels.clear();
+	m_LabelQueue.clear();
+	m_ExpansionCount = 0;
+
+	//Advance the stamp, wiping the records only on the rare occasion it wraps
+	if (++m_Generation == 0)
+	{
+		for (auto& n : m_Nodes)
+			n.generation = 0;
+		m_Generation = 1;
+	}
+}
+
+PathResult PathSearchArena::BuildResult(int endpointIndex)
+{
+	//Follow the parents back to the origin point (which has no parent)
+	m_PathBuffer.clear();
+	for (int index = endpointIndex; index != -1; index = m_Nodes[index].parent)
+		m_PathBuffer.push_back(index);
+
+	//Stored goal to start, so flip to start to goal
+	std::reverse(m_PathBuffer.begin(), m_PathBuffer.end());
+
+	PathResult result;
+	result.cells = m_PathBuffer.data();
+	result.length = static_cast<int>(m_PathBuffer.size());
+	result.cost = m_Nodes[endpointIndex].gCost / NavGrid::MOVE_COST_SCALE;
+	return result;
+}
+
+namespace
+{
+	//Orders the label queue as a min heap
+	struct LabelQueueOrder
+	{
+		template<typename Entry>
+		bool operator()(const Entry& a, const Entry& b) const
+		{
+			return a.key > b.key || (a.key == b.key && a.tieBreak > b.tieBreak);
+		}
+	};
+}
+
+void PathSearchArena::PushLabel(int cell, float gCost, float moveCost, int parent, float key, float tieBreak)
+{
+	m_Labels.push_back({ cell, gCost, moveCost, parent });
+	m_LabelQueue.push_back({ key, tieBreak, static_cast<int>(m_Labels.size()) - 1 });
+	std::push_heap(m_LabelQueue.begin(), m_LabelQueue.end(), LabelQueueOrder());
+}
+
+int PathSearchArena::PopLabel()
+{
+	std::pop_heap(m_LabelQueue.begin(), m_LabelQueue.end(), LabelQueueOrder());
+	int label = m_LabelQueue.back().label;
+	m_LabelQueue.pop_back();
+	return label;
+}
+
+PathResult PathSearchArena::BuildLabelResult(int endpointLabel)
+{
+	m_PathBuffer.clear();
+	for (int label = endpointLabel; label != -1; label = m_Labels[label].parent)
+		m_PathBuffer.push_back(m_Labels[label].cell);
+	std::reverse(m_PathBuffer.begin(), m_PathBuffer.end());
+
+	PathResult result;
+	result.cells = m_PathBuffer.data();
+	result.length = static_cast<int>(m_PathBuffer.size());
+	result.cost = m_Labels[endpointLabel].moveCost / NavGrid::MOVE_COST_SCALE;
+	return result;
+}
+
+PathResult PathSearchArena::BuildJumpResult(int endpointIndex, int rowStride)
+{
+	m_PathBuffer.clear();
+	for (int index = endpointIndex; index != -1; index = m_Nodes[index].parent)
+	{
+		m_PathBuffer.push_back(index);
+
+		//Step back along the run towards the parent, adding the skipped cells
+		int parent = m_Nodes[index].parent;
+		if (parent == -1)
+			continue;
+		int offset = parent - index;
+		int step = (offset % rowStride == 0) ? (offset > 0 ? rowStride : -rowStride) : (offset > 0 ? 1 : -1);
+		for (int cell = index + step; cell != parent; cell += step)
+			m_PathBuffer.push_back(cell);
+	}
+
+	std::reverse(m_PathBuffer.begin(), m_PathBuffer.end());
+
+	PathResult result;
+	result.cells = m_PathBuffer.data();
+	result.length = static_cast<int>(m_PathBuffer.size());
+	result.cost = m_Nodes[endpointIndex].gCost / NavGrid::MOVE_COST_SCALE;
+	return result;
+}
+
+namespace
+{
+	//Goal sets larger than this are searched without a heuristic (Dijkstra), as the per node cost of the
+	//minimum over goals would outweigh the nodes it saves
+	const int MAX_HEURISTIC_GOALS = 64;
+
+	//Single goal cell, with the topology distance scaled by the cheapest move cost so it never overestimates
+	template<typename Topology>
+	struct SingleGoal
+	{
+		const NavGrid& grid;
+		int goalCell;
+		int goalX;
+		int goalY;
+		int minMoveCost;
+
+		SingleGoal(const NavGrid& g, int cell, int minCost)
+			: grid(g), goalCell(cell), goalX(g.GetCellX(cell)), goalY(g.GetCellY(cell)), minMoveCost(minCost) {}
+
+		bool IsGoal(int cell) const { return cell == goalCell; }
+		float Heuristic(int cell) const
+		{
+			return static_cast<float>(Topology::Distance(goalX - grid.GetCellX(cell), goalY - grid.GetCellY(cell), minMoveCost));
+		}
+		bool IsConsistent() const { return true; }
+	};
+
+	/*
+		Single goal cell, bounded by the landmarks that bound the start best as well as the topology distance. Both
+		are consistent unless the landmarks distances were rounded down to fit their tables.
+	*/
+	template<typename Topology>
+	struct LandmarkGoal
+	{
+		SingleGoal<Topology> distance;
+		const LandmarkHeuristic& landmarks;
+		int unitType;
+		int active[LandmarkHeuristic::ACTIVE_LANDMARK_COUNT];
+		int activeCount;
+		bool consistent;
+
+		LandmarkGoal(const NavGrid& g, const LandmarkHeuristic& l, int startCell, int cell, int type, int minCost)
+			: distance(g, cell, minCost), landmarks(l), unitType(type)
+		{
+			activeCount = landmarks.SelectLandmarks(unitType, startCell, cell, active, LandmarkHeuristic::ACTIVE_LANDMARK_COUNT);
+			consistent = landmarks.AreExact(unitType, active, activeCount);
+		}
+
+		bool IsGoal(int cell) const { return distance.IsGoal(cell); }
+		float Heuristic(int cell) const
+		{
+			float bound = static_cast<float>(landmarks.GetLowerBound(unitType, cell, distance.goalCell, active, activeCount));
+			float h = distance.Heuristic(cell);
+			return bound > h ? bound : h;
+		}
+		bool IsConsistent() const { return consistent; }
+	};
+
+	/*
+		Set of goal cells. The heuristic is the minimum of the single goal heuristics, which stays consistent
+		(each one is, and the minimum of consistent heuristics is too).
+	*/
+	template<typename Topology>
+	struct GoalSet
+	{
+		const NavGrid& grid;
+		const PathGoalSet& goals;
+		int minMoveCost;
+		bool useHeuristic;
+
+		GoalSet(const NavGrid& g, const PathGoalSet& set, int minCost)
+			: grid(g), goals(set), minMoveCost(minCost), useHeuristic(set.GetCount() <= MAX_HEURISTIC_GOALS) {}
+
+		bool IsGoal(int cell) const { return goals.Contains(cell); }
+		float Heuristic(int cell) const
+		{
+			if (!useHeuristic)
+				return 0.f;
+
+			int x = grid.GetCellX(cell);
+			int y = grid.GetCellY(cell);
+			int best = INT32_MAX;
+			for (int goal : goals.GetCells())
+			{
+				int distance = Topology::Distance(grid.GetCellX(goal) - x, grid.GetCellY(goal) - y, minMoveCost);
+				best = distance < best ? distance : best;
+			}
+			return static_cast<float>(best);
+		}
+		bool IsConsistent() const { return true; }
+	};
+
+	//No extra costs, the search is plain A* over move costs
+	struct NoCostLayers
+	{
+		static constexpr bool ENABLED = false;
+		float GetCellCost(int) const { return 0.f; }
+	};
+
+	//Extra cost of each cell from a stack of layers, summed or precomputed
+	struct LayeredCosts
+	{
+		static constexpr bool ENABLED = true;
+		const PathCostLayers& layers;
+
+		LayeredCosts(const PathCostLayers& l) : layers(l) {}
+		float GetCellCost(int cell) const { return layers.GetCellCost(cell); }
+	};
+
+	/*
+		A* over the grid towards the goal policy, with the neighbour loop unrolled for the topology. With cost
+		layers, the G cost adds each cells layer cost on entry, and the move cost is tracked apart for the budget.
+		Without, the layer code compiles away and G cost is the move cost. Closed nodes are reopened if the goals
+		heuristic is not consistent, so the path found is still the cheapest.
+	*/
+	template<typename Topology, typename Goal, typename Costs>
+	PathResult RunAStar(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena, const Goal& goal, const Costs& costs)
+	{
+		IndexedMinHeap& openList = arena.GetOpenList();
+
+		//Costs are worked in fixed point, which floats hold exactly at these sizes
+		float maxCost = static_cast<float>(query.maxCost);
+		int stride = grid.GetStride();
+		bool reopenClosed = !goal.IsConsistent();
+
+		//Setup starting node and push it into the open list
+		float startH = goal.Heuristic(query.startCell);
+		arena.OpenNode(query.startCell, 0.f, -1);
+		openList.Push(query.startCell, startH, startH);
+		if constexpr (Costs::ENABLED)
+		{
+			arena.TrackMoveCosts(grid.GetCellCount());
+			arena.SetMoveCost(query.startCell, 0.f);
+		}
+
+		while (!openList.IsEmpty())
+		{
+			//Take the lowest F Cost node from the open list and mark it evaluated
+			int currentCell = openList.Pop();
+			arena.CloseNode(currentCell);
+
+			//Check if the current node is the goal node
+			if (goal.IsGoal(currentCell))
+			{
+				PathResult result = arena.BuildResult(currentCell);
+				if constexpr (Costs::ENABLED)
+					result.cost = arena.GetMoveCost(currentCell) / NavGrid::MOVE_COST_SCALE;
+				return result;
+			}
+
+			float currentG = arena.GetGCost(currentCell);
+			float currentMove = Costs::ENABLED ? arena.GetMoveCost(currentCell) : currentG;
+
+			//Start looking at the neighbouring cells (the grid border blocks any moves off the map)
+			ForEachDirection<Topology>([&](auto direction)
+			{
+				//Validate if this neighbour needs evaluating or not
+				int neighbour = currentCell + Topology::Offset(direction, stride);
+				if ((!reopenClosed && arena.IsNodeClosed(neighbour)) || !grid.CanEnter(neighbour, query.unitType))
+					return;
+
+				//Cost of reaching the neighbour through the current cell (discard if over budget)
+				float stepCost = static_cast<float>(Topology::StepCost(direction, grid.GetMoveCost(neighbour)));
+				float newMove = currentMove + stepCost;
+				if (newMove > maxCost)
+					return;
+				float newG = Costs::ENABLED ? currentG + stepCost + costs.GetCellCost(neighbour) : newMove;
+
+				//First time seeing this cell, so add it to the open list
+				if (!arena.IsNodeSeen(neighbour))
+				{
+					float newH = goal.Heuristic(neighbour);
+					arena.OpenNode(neighbour, newG, currentCell);
+					if constexpr (Costs::ENABLED)
+						arena.SetMoveCost(neighbour, newMove);
+					openList.Push(neighbour, newG + newH, newH);
+				}
+				//Already open, but this route is cheaper so update it in place
+				else if (newG < arena.GetGCost(neighbour))
+				{
+					float newH = goal.Heuristic(neighbour);
+					bool wasClosed = reopenClosed && arena.IsNodeClosed(neighbour);
+					arena.OpenNode(neighbour, newG, currentCell);
+					if constexpr (Costs::ENABLED)
+						arena.SetMoveCost(neighbour, newMove);
+					if (wasClosed)
+						openList.Push(neighbour, newG + newH, newH);
+					else
+						openList.DecreaseKey(neighbour, newG + newH, newH);
+				}
+			});
+		}
+
+		//Exhausted the search without reaching the goal
+		return PathResult();
+	}
+
+	/*
+		A* over move cost plus layer cost, within the querys move budget. A single route a cell isn't enough here: the
+		cheapest route to a cell by layered cost can spend more of the budget than a dearer one, and so run out before
+		the goal where the dearer one wouldn't. So each cell keeps every route that spends less of the budget than the
+		routes taken from it before (a label each), and a route is only dropped once a route already taken from the
+		cell is no dearer and spends no more. Routes are also dropped as soon as even the heuristic (a lower bound on
+		the move cost left) takes them over budget. The first goal label taken is then the cheapest route in budget.
+
+		The cell records hold the route taken from each cell spending least, in its G cost and move cost.
+	*/
+	template<typename Topology, typename Goal>
+	PathResult RunBudgetedAStar(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena, const Goal& goal)
+	{
+		const PathCostLayers& layers = *query.costLayers;
+		float maxCost = static_cast<float>(query.maxCost);
+		int stride = grid.GetStride();
+		arena.TrackMoveCosts(grid.GetCellCount());
+
+		//Has a route no dearer and spending no more already been taken from the cell
+		auto isDominated = [&](int cell, float gCost, float moveCost)
+		{
+			return arena.IsNodeClosed(cell) && moveCost >= arena.GetMoveCost(cell) && gCost >= arena.GetGCost(cell);
+		};
+
+		float startH = goal.Heuristic(query.startCell);
+		arena.PushLabel(query.startCell, 0.f, 0.f, -1, startH, startH);
+
+		while (arena.HasQueuedLabels())
+		{
+			int label = arena.PopLabel();
+			PathSearchArena::PathLabel current = arena.GetLabel(label);
+			if (isDominated(current.cell, current.gCost, current.moveCost))
+				continue;
+
+			//Take the route, keeping it as the cells record if it spends the least so far
+			if (!arena.IsNodeClosed(current.cell) || current.moveCost < arena.GetMoveCost(current.cell))
+			{
+				arena.OpenNode(current.cell, current.gCost, label);
+				arena.SetMoveCost(current.cell, current.moveCost);
+			}
+			arena.CloseNode(current.cell);
+
+			if (goal.IsGoal(current.cell))
+				return arena.BuildLabelResult(label);
+
+			ForEachDirection<Topology>([&](auto direction)
+			{
+				int neighbour = current.cell + Topology::Offset(direction, stride);
+				if (!grid.CanEnter(neighbour, query.unitType))
+					return;
+
+				//Discard routes that can't reach a goal in budget
+				float stepCost = static_cast<float>(Topology::StepCost(direction, grid.GetMoveCost(neighbour)));
+				float newMove = current.moveCost + stepCost;
+				float newH = goal.Heuristic(neighbour);
+				if (newMove + newH > maxCost)
+					return;
+
+				float newG = current.gCost + stepCost + layers.GetCellCost(neighbour);
+				if (isDominated(neighbour, newG, newMove))
+					return;
+				arena.PushLabel(neighbour, newG, newMove, label, newG + newH, newH);
+			});
+		}
+
+		//Exhausted the search without reaching the goal
+		return PathResult();
+	}
+
+	//Runs A* with the queries cost layers (within its budget, if it has one), or the plain search if it has none
+	template<typename Topology, typename Goal>
+	PathResult RunAStarWithCosts(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena, const Goal& goal)
+	{
+		if (!query.costLayers || query.costLayers->IsEmpty())
+			return RunAStar<Topology>(query, grid, arena, goal, NoCostLayers());
+		if (query.maxCost != INT32_MAX)
+			return RunBudgetedAStar<Topology>(query, grid, arena, goal);
+		return RunAStar<Topology>(query, grid, arena, goal, LayeredCosts(*query.costLayers));
+	}
+
+	//Validates a goal set query and runs its search
+	PathResult SearchGoalSet(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena)
+	{
+		int cellCount = grid.GetCellCount();
+		if (query.startCell < 0 || query.startCell >= cellCount || grid.IsBorder(query.startCell) || query.goals->IsEmpty())
+			return PathResult();
+
+		//Reject outright if the labels show none of the goals can be reached
+		if (query.connectivity)
+		{
+			bool anyReachable = false;
+			for (int goal : query.goals->GetCells())
+			{
+				if (query.connectivity->MayBeReachable(query.startCell, goal, query.unitType))
+				{
+					anyReachable = true;
+					break;
+				}
+			}
+			if (!anyReachable)
+				return PathResult();
+		}
+
+		arena.BeginQuery(cellCount);
+		int minMoveCost = query.minMoveCost < 0 ? grid.GetMinMoveCost() : query.minMoveCost;
+		return RunAStarWithCosts<NavGrid::Topology>(query, grid, arena, GoalSet<NavGrid::Topology>(grid, *query.goals, minMoveCost));
+	}
+
+	//Validates the query and runs its search
+	PathResult SearchPath(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena)
+	{
+		if (query.goals)
+			return SearchGoalSet(query, grid, arena);
+
+		int cellCount = grid.GetCellCount();
+
+		//Reject out of range requests and goals that can never be stood on
+		if (query.startCell < 0 || query.startCell >= cellCount || grid.IsBorder(query.startCell) ||
+			query.goalCell < 0 || query.goalCell >= cellCount)
+			return PathResult();
+		if (query.goalCell != query.startCell && !grid.CanEnter(query.goalCell, query.unitType))
+			return PathResult();
+		if (query.connectivity && !query.connectivity->MayBeReachable(query.startCell, query.goalCell, query.unitType))
+			return PathResult();
+
+		arena.BeginQuery(cellCount);
+		//Jump point search is written for 4 way grids without cost layers, anything else falls back to A*
+		if (query.searchMethod == PATH_SEARCH_METHOD::JUMP_POINT && std::is_same<NavGrid::Topology, SquareGrid4>::value &&
+			(!query.costLayers || query.costLayers->IsEmpty()) && query.jumpPoints && query.jumpPoints->IsBuilt() &&
+			query.jumpPoints->GetCellCount() == cellCount && query.unitType >= 0 && query.unitType < query.jumpPoints->GetUnitTypeCount())
+			return RunJumpPointSearch(query, grid, arena);
+
+		int minMoveCost = query.minMoveCost < 0 ? grid.GetMinMoveCost() : query.minMoveCost;
+		if (query.searchMethod == PATH_SEARCH_METHOD::ALT && query.landmarks && query.landmarks->IsValid() &&
+			query.landmarks->GetCellCount() == cellCount && query.unitType >= 0 && query.unitType < query.landmarks->GetUnitTypeCount())
+		{
+			return RunAStarWithCosts<NavGrid::Topology>(query, grid, arena, LandmarkGoal<NavGrid::Topology>(grid, *query.landmarks,
+				query.startCell, query.goalCell, query.unitType, minMoveCost));
+		}
+		return RunAStarWithCosts<NavGrid::Topology>(query, grid, arena, SingleGoal<NavGrid::Topology>(grid, query.goalCell, minMoveCost));
+	}
+}
+
+PathResult RunPathQuery(const PathQuery& query, const NavGrid& grid, PathSearchArena& arena)
+{
+	if constexpr (PATH_TRACE_ENABLED)
+	{
+		if (query.trace)
+		{
+			query.trace->BeginQuery(query, grid);
+			arena.SetTraceRecorder(query.trace);
+			PathResult result = SearchPath(query, grid, arena);
+			arena.SetTraceRecorder(nullptr);
+			query.trace->EndQuery(result);
+			return result;
+		}
+	}
+
+	return SearchPath(query, grid, arena);
+}
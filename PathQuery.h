@@ -0,0 +1,276 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "NavGrid.h"					//Searched grid
+#include "PathfindingContainers.h"		//Open list
+#include "PathTrace.h"					//Query tracing
+
+class ConnectivityMap;
+class PathCostLayers;
+class LandmarkHeuristic;
+class JumpPointTable;
+
+/*
+	Reentrant path queries. A query reads the nav grid but never writes to it, keeping all of its working
+	state in a PathSearchArena. Each thread gets its own arena, so queries can run off the main thread and
+	several can be in flight at once (one per arena).
+*/
+
+/*
+	Search used to answer a path query. Both find paths of the same (cheapest) cost, but jump point search
+	skips across runs of cells with identical move cost, expanding far fewer nodes on open terrain.
+	Jump point search is only used on 4 way grids (see NavGrid::Topology) with the querys jump point table, A* is
+	run in its place otherwise.
+	ALT is A* with the landmark heuristic (see LandmarkHeuristic), which accounts for terrain costs so expands fewer
+	nodes on weighted maps. It needs the querys landmarks, and runs plain A* without them (or if they're stale).
+*/
+enum class PATH_SEARCH_METHOD
+{
+	A_STAR,
+	JUMP_POINT,
+	ALT
+};
+
+/*
+	Set of goal cells for a multi goal query ("path to whichever of these is cheapest to reach"). Held as a bitset
+	for the goal test and a list for the heuristic, which takes the minimum distance over the goals.
+	Sized once against the grid, and cleared by resetting only the bits set.
+*/
+class PathGoalSet
+{
+public:
+
+	PathGoalSet() {}
+	~PathGoalSet() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	bool IsEmpty() const { return m_Cells.empty(); }
+	int GetCount() const { return static_cast<int>(m_Cells.size()); }
+	bool Contains(int cell) const { return cell >= 0 && cell < m_Set.GetBitCount() && m_Set.Test(cell); }
+	const std::vector<int>& GetCells() const { return m_Cells; }
+	//Number of cells the set is sized for
+	int GetCellCapacity() const { return m_Set.GetBitCount(); }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Sizes the set to a grid of the given cell count, emptying it
+	void Resize(int cellCount)
+	{
+		m_Set.Resize(cellCount);
+		m_Cells.clear();
+	}
+	//Adds a goal cell (duplicates are ignored)
+	void Add(int cell)
+	{
+		if (Contains(cell))
+			return;
+		m_Set.Set(cell);
+		m_Cells.push_back(cell);
+	}
+	void Clear()
+	{
+		for (int cell : m_Cells)
+			m_Set.Reset(cell);
+		m_Cells.clear();
+	}
+
+private:
+
+	TileBitset m_Set;
+	std::vector<int> m_Cells;
+};
+
+/*
+	Describes a single path request between two cells, or from a cell to the cheapest of a set of goals.
+*/
+struct PathQuery
+{
+	//NavGrid cell indexes of the start and goal
+	int startCell = -1;
+	int goalCell = -1;
+	//Optional goal set, searched in place of goalCell. The path ends at whichever goal is cheapest to reach
+	const PathGoalSet* goals = nullptr;
+	//UnitEntity::UNIT_TYPE of the moving unit, compared against the cells terrain type
+	int unitType = 0;
+	//Maximum path cost allowed in fixed point, see NavGrid::QuantiseBudget (defaults to unbounded)
+	int maxCost = INT32_MAX;
+	//Cheapest fixed point move cost the search can encounter, scales the heuristic so it never overestimates
+	//(-1 uses the cheapest cost in the grid)
+	int minMoveCost = -1;
+	PATH_SEARCH_METHOD searchMethod = PATH_SEARCH_METHOD::A_STAR;
+	//Optional component labels, rejecting goals that can't be reached without searching
+	const ConnectivityMap* connectivity = nullptr;
+	/*
+		Optional extra costs for entering cells (threat, hazards etc). Routes are chosen by move cost plus layer
+		cost, while maxCost still limits the move cost alone. With a budget, routes spending less of it are kept
+		alongside cheaper ones, so the path is the cheapest by layered cost of those in budget, and layers never
+		put a goal out of range. Queries with layers always run A*.
+	*/
+	const PathCostLayers* costLayers = nullptr;
+	//Landmark tables for the ALT search method
+	const LandmarkHeuristic* landmarks = nullptr;
+	//Run tables for the JUMP_POINT search method
+	const JumpPointTable* jumpPoints = nullptr;
+	//Optional recorder to trace the query with (ignored unless PATHFINDING_TRACE is on)
+	PathTraceRecorder* trace = nullptr;
+};
+
+/*
+	Result of a path query. The cell indexes are ordered start to goal and point into the arena that ran the
+	query, so they are only valid until the next query is run on that arena.
+*/
+struct PathResult
+{
+	const int* cells = nullptr;
+	int length = 0;
+	//Move cost of the path (not counting cost layers)
+	float cost = 0.f;
+
+	bool IsValid() const { return cells != nullptr; }
+	const int* begin() const { return cells; }
+	const int* end() const { return cells + length; }
+};
+
+/*
+	Per-thread search state. Node records are stamped with the generation of the query that wrote them, so
+	starting a new query is a single increment rather than a reset pass over the map.
+*/
+class PathSearchArena
+{
+public:
+
+	PathSearchArena() {}
+	~PathSearchArena() {}
+
+	//Arena belonging to the calling thread
+	static PathSearchArena& GetThreadArena();
+
+	//Prepares the arena for a new query on a grid of the given size (only allocates if the grid has grown)
+	void BeginQuery(int cellCount);
+
+	///////////////////////
+	/// Node Operations ///
+	///////////////////////
+
+	//Has the node been touched by the current query
+	bool IsNodeSeen(int index) const { return m_Nodes[index].generation == m_Generation; }
+	bool IsNodeClosed(int index) const { return IsNodeSeen(index) && m_Nodes[index].closed; }
+
+	//Writes a node record for the current query
+	void OpenNode(int index, float gCost, int parent)
+	{
+		NodeRecord& n = m_Nodes[index];
+		n.generation = m_Generation;
+		n.gCost = gCost;
+		n.parent = parent;
+		n.closed = false;
+	}
+	void CloseNode(int index)
+	{
+		m_Nodes[index].closed = true;
+		++m_ExpansionCount;
+
+		if constexpr (PATH_TRACE_ENABLED)
+		{
+			if (m_Trace)
+				m_Trace->OnExpand(index, m_OpenList.GetSize());
+		}
+	}
+
+	float GetGCost(int index) const { return m_Nodes[index].gCost; }
+	int GetParent(int index) const { return m_Nodes[index].parent; }
+
+	//Move cost of reaching a node, kept apart from its G cost by searches with cost layers (see TrackMoveCosts)
+	float GetMoveCost(int index) const { return m_MoveCosts[index]; }
+	void SetMoveCost(int index, float moveCost) { m_MoveCosts[index] = moveCost; }
+	//Sizes the move costs for the current query, only needed (and only allocated) by searches with cost layers
+	void TrackMoveCosts(int cellCount)
+	{
+		if (static_cast<int>(m_MoveCosts.size()) < cellCount)
+			m_MoveCosts.resize(cellCount);
+	}
+
+	////////////////////////
+	/// Label Operations ///
+	////////////////////////
+
+	/*
+		Routes held by searches that keep several a cell (budgeted searches with cost layers), each a label pointing
+		back to the label it was reached from. Labels are queued by F cost, lowest first with ties to the lowest H.
+	*/
+	struct PathLabel
+	{
+		int cell = -1;
+		float gCost = 0.f;
+		float moveCost = 0.f;
+		int parent = -1;
+	};
+
+	//Adds a label for the current query and queues it
+	void PushLabel(int cell, float gCost, float moveCost, int parent, float key, float tieBreak);
+	//Takes the label lowest in the queue
+	int PopLabel();
+	bool HasQueuedLabels() const { return !m_LabelQueue.empty(); }
+	const PathLabel& GetLabel(int label) const { return m_Labels[label]; }
+
+		IndexedMinHeap& GetOpenList() { return m_OpenList; }
+	//Recorder told of each node closed (nullptr for none)
+	void SetTraceRecorder(PathTraceRecorder* trace) { m_Trace = trace; }
+	//Number of nodes closed by the current (or last) query
+	int GetExpansionCount() const { return m_ExpansionCount; }
+
+	//Walks the parents back from the endpoint into the path buffer, returning the finished result
+	PathResult BuildResult(int endpointIndex);
+	//Walks the labels back from the endpoint label into the path buffer, with the move cost as the result cost
+	PathResult BuildLabelResult(int endpointLabel);
+	//As above, but for parents that can be a straight run of cells away (rows are rowStride apart), filling in the cells between
+	PathResult BuildJumpResult(int endpointIndex, int rowStride);
+
+private:
+
+	struct NodeRecord
+	{
+		uint32_t generation = 0;
+		float gCost = 0.f;
+		int parent = -1;
+		bool closed = false;
+	};
+
+	std::vector<NodeRecord> m_Nodes;
+	//Written alongside each node record when tracked, so never read stale
+	std::vector<float> m_MoveCosts;
+	IndexedMinHeap m_OpenList;
+	//Labels of the current query, and the queue of them (a binary heap, labels are never updated once queued)
+	struct QueuedLabel
+	{
+		float key;
+		float tieBreak;
+		int label;
+	};
+	std::vector<PathLabel> m_Labels;
+	std::vector<QueuedLabel> m_LabelQueue;
+	//Holds the cell indexes of the last path found
+	std::vector<int> m_PathBuffer;
+	//Current query stamp (0 is never used so default records are always stale)
+	uint32_t m_Generation = 0;
+	int m_ExpansionCount = 0;
+	PathTraceRecorder* m_Trace = nullptr;
+};
+
+/*
+	Runs the queries search (A* or jump point) over the nav grid, using the given arena for all working state.
+	Cells are traversable if they are not impassable, not occupied and match the unit type.
+	Goal set queries always run A* (the goal reached is the last cell of the path), as one search over all the
+	goals rather than one per goal. So do queries with cost layers, as jump point search relies on uniform costs.
+	Returns an invalid result if no path exists within the queries maximum cost.
+	If the query has a trace recorder (and tracing is compiled in), the search is recorded to it.
+*/
+PathResult RunPathQuery(const PathQuery& query, const NavGrid& grid,
+	PathSearchArena& arena = PathSearchArena::GetThreadArena());
@@ -0,0 +1,141 @@
+#include "PathTrace.h"
+#include "NavGrid.h"
+#include "PathQuery.h"
+
+#include <cmath>		//std::log
+#include <cstring>		//std::memcpy
+#include <fstream>		//File output
+
+void PathTraceRecorder::BeginQuery(const PathQuery& query, const NavGrid& grid)
+{
+	//A different map starts a fresh log, as tile indexes would no longer line up
+	if (grid.GetWidth() != m_Width || grid.GetHeight() != m_Height)
+	{
+		m_Width = grid.GetWidth();
+		m_Height = grid.GetHeight();
+		Reset();
+	}
+
+	m_Grid = &grid;
+	m_StartCell = query.startCell;
+	m_GoalCell = query.goalCell;
+	m_UnitType = query.unitType;
+	m_Expansions.clear();
+	m_OpenListSizes.clear();
+	m_Path.clear();
+}
+
+void PathTraceRecorder::EndQuery(const PathResult& result)
+{
+	++m_QueryCount;
+	m_Path.assign(result.begin(), result.end());
+
+	for (int cell : m_Expansions)
+		++m_Heatmap[m_Grid->CellToTile(cell)];
+
+	//Rough upper bound of the encoded size (5 bytes per varint at most)
+	size_t maxRecordBytes = 32 + (m_Expansions.size() * 2 + m_Path.size()) * 5;
+	if (m_Log.size() + maxRecordBytes > m_MaxLogBytes)
+	{
+		++m_DroppedQueryCount;
+		return;
+	}
+
+	//Goal set queries have no goal cell, so log the goal the path reached
+	int goalCell = result.IsValid() ? m_Path.back() : m_GoalCell;
+	WriteVarint(IsMapCell(m_StartCell) ? m_Grid->CellToTile(m_StartCell) : 0);
+	WriteVarint(IsMapCell(goalCell) ? m_Grid->CellToTile(goalCell) : 0);
+	WriteVarint(static_cast<uint32_t>(m_UnitType));
+	m_Log.push_back(result.IsValid() ? 1 : 0);
+
+	uint8_t costBytes[sizeof(float)];
+	std::memcpy(costBytes, &result.cost, sizeof(float));
+	m_Log.insert(m_Log.end(), costBytes, costBytes + sizeof(float));
+
+	WriteVarint(static_cast<uint32_t>(m_Expansions.size()));
+	WriteTiles(m_Expansions);
+	int previous = 0;
+	for (int size : m_OpenListSizes)
+	{
+		WriteSignedVarint(size - previous);
+		previous = size;
+	}
+
+	WriteVarint(static_cast<uint32_t>(m_Path.size()));
+	WriteTiles(m_Path);
+}
+
+void PathTraceRecorder::Reset()
+{
+	m_Log.clear();
+	m_Heatmap.assign(static_cast<size_t>(m_Width) * m_Height, 0);
+	m_QueryCount = 0;
+	m_DroppedQueryCount = 0;
+
+	//Header
+	const char magic[4] = { 'P', 'T', 'R', 'C' };
+	m_Log.insert(m_Log.end(), magic, magic + 4);
+	m_Log.push_back(LOG_VERSION);
+	WriteVarint(static_cast<uint32_t>(m_Width));
+	WriteVarint(static_cast<uint32_t>(m_Height));
+}
+
+bool PathTraceRecorder::WriteLog(const std::string& filePath) const
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file)
+		return false;
+
+	file.write(reinterpret_cast<const char*>(m_Log.data()), m_Log.size());
+	return file.good();
+}
+
+bool PathTraceRecorder::WriteHeatmapPGM(const std::string& filePath) const
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file || m_Heatmap.empty())
+		return false;
+
+	uint32_t hottest = 0;
+	for (uint32_t count : m_Heatmap)
+		hottest = count > hottest ? count : hottest;
+
+	//Log scale, so a handful of very hot tiles don't wash out the rest
+	std::vector<uint8_t> pixels(m_Heatmap.size(), 0);
+	if (hottest > 0)
+	{
+		double scale = 255.0 / std::log(1.0 + hottest);
+		for (size_t i(0); i < m_Heatmap.size(); ++i)
+			pixels[i] = static_cast<uint8_t>(std::log(1.0 + m_Heatmap[i]) * scale + 0.5);
+	}
+
+	file << "P5\n" << m_Width << " " << m_Height << "\n255\n";
+	file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+	return file.good();
+}
+
+bool PathTraceRecorder::IsMapCell(int cell) const
+{
+	return cell >= 0 && cell < m_Grid->GetCellCount() && !m_Grid->IsBorder(cell);
+}
+
+void PathTraceRecorder::WriteVarint(uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		m_Log.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	m_Log.push_back(static_cast<uint8_t>(value));
+}
+
+void PathTraceRecorder::WriteTiles(const std::vector<int>& cells)
+{
+	int previous = 0;
+	for (int cell : cells)
+	{
+		int tile = m_Grid->CellToTile(cell);
+		WriteSignedVarint(tile - previous);
+		previous = tile;
+	}
+}
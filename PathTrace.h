@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class NavGrid;
+struct PathQuery;
+struct PathResult;
+
+/*
+	Compile time switch for path query tracing. Defaults to on in debug builds and off otherwise, define
+	PATHFINDING_TRACE as 1 to keep it in other builds (e.g. QA). When off, the tracing hooks compile away and
+	a query costs exactly what it did before; when on, a query with no recorder attached costs one branch per
+	expanded node.
+*/
+#ifndef PATHFINDING_TRACE
+#if defined(DEBUG) || defined(_DEBUG)
+#define PATHFINDING_TRACE 1
+#else
+#define PATHFINDING_TRACE 0
+#endif
+#endif
+
+constexpr bool PATH_TRACE_ENABLED = PATHFINDING_TRACE != 0;
+
+/*
+	Records path queries for offline inspection: the order tiles were expanded in, the open list size at each
+	expansion and the final path. Attach to a query (PathQuery::trace, or MapTilePathfinder::SetTraceRecorder)
+	to trace it.
+
+	Each finished query is appended to a compact in-memory log (varint/delta encoded tile indexes), which can be
+	written out as a binary file, and every expansion is counted into a per tile heatmap, which can be written as
+	a greyscale PGM image. Working buffers are reused, so recording does not allocate once warm beyond log growth.
+
+	Log layout (all integers unsigned LEB128 varints, "signed" ones zigzag encoded):
+		Header: "PTRC", version byte, map width, map height
+		Per query: start tile, goal tile, unit type, found byte, cost (float, 4 bytes little endian),
+			expansion count, expanded tiles (signed delta from the previous), open list sizes (signed delta),
+			path length, path tiles (signed delta)
+*/
+class PathTraceRecorder
+{
+public:
+
+	static constexpr uint8_t LOG_VERSION = 1;
+	//Default cap on the in-memory log, queries past it are only counted into the heatmap
+	static constexpr size_t DEFAULT_MAX_LOG_BYTES = 16 * 1024 * 1024;
+
+	PathTraceRecorder() {}
+	~PathTraceRecorder() {}
+
+	///////////
+	/// Set ///
+	///////////
+
+	void SetMaxLogBytes(size_t maxBytes) { m_MaxLogBytes = maxBytes; }
+
+	///////////
+	/// Get ///
+	///////////
+
+	int GetQueryCount() const { return m_QueryCount; }
+	//Queries left out of the log for being over the size cap
+	int GetDroppedQueryCount() const { return m_DroppedQueryCount; }
+	const std::vector<uint8_t>& GetLog() const { return m_Log; }
+	//Times each tile was expanded across all recorded queries (left->right, top->bot)
+	const std::vector<uint32_t>& GetHeatmap() const { return m_Heatmap; }
+	int GetMapWidth() const { return m_Width; }
+	int GetMapHeight() const { return m_Height; }
+
+	//Last query recorded, as nav grid cells
+	const std::vector<int>& GetLastExpansions() const { return m_Expansions; }
+	const std::vector<int>& GetLastOpenListSizes() const { return m_OpenListSizes; }
+	const std::vector<int>& GetLastPath() const { return m_Path; }
+
+	////////////////////
+	/// Search Hooks ///
+	////////////////////
+
+	//Called by RunPathQuery around each traced query
+	void BeginQuery(const PathQuery& query, const NavGrid& grid);
+	void EndQuery(const PathResult& result);
+
+	//Called by the search arena as each node is closed
+	void OnExpand(int cell, int openListSize)
+	{
+		m_Expansions.push_back(cell);
+		m_OpenListSizes.push_back(openListSize);
+	}
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Clears the log and heatmap
+	void Reset();
+
+	//Writes the log to a binary file, returns false if the file couldn't be written
+	bool WriteLog(const std::string& filePath) const;
+	//Writes the heatmap as an 8 bit binary PGM (log scaled, hottest tile white), returns false on failure
+	bool WriteHeatmapPGM(const std::string& filePath) const;
+
+private:
+
+	//Is the cell on the map (queries can be traced before they are validated)
+	bool IsMapCell(int cell) const;
+	void WriteVarint(uint32_t value);
+	void WriteSignedVarint(int value) { WriteVarint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31)); }
+	//Writes the cells as tile indexes, each as a delta from the one before
+	void WriteTiles(const std::vector<int>& cells);
+
+	////////////
+	/// Data ///
+	////////////
+
+	//Grid the current query runs on
+	const NavGrid* m_Grid = nullptr;
+	int m_Width = 0;
+	int m_Height = 0;
+
+	//Current query
+	int m_StartCell = -1;
+	int m_GoalCell = -1;
+	int m_UnitType = 0;
+	std::vector<int> m_Expansions;
+	std::vector<int> m_OpenListSizes;
+	std::vector<int> m_Path;
+
+	std::vector<uint8_t> m_Log;
+	size_t m_MaxLogBytes = DEFAULT_MAX_LOG_BYTES;
+	std::vector<uint32_t> m_Heatmap;
+	int m_QueryCount = 0;
+	int m_DroppedQueryCount = 0;
+};
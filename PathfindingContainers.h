@@ -0,0 +1,408 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>		//std::swap
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+/*
+	Supporting containers for the grid search algorithms. All containers are sized once against the
+	number of tiles in the map and then reused between queries, so a search does not allocate once warm.
+*/
+
+/*
+	Binary min-heap of tile indexes with a position table, allowing O(log n) push/pop and decrease-key.
+	Ordering is by key (F Cost), with ties broken by the lower tie break value (H Cost).
+*/
+class IndexedMinHeap
+{
+public:
+
+	IndexedMinHeap() {}
+	~IndexedMinHeap() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	bool IsEmpty() const { return m_Heap.empty(); }
+	int GetSize() const { return static_cast<int>(m_Heap.size()); }
+	//Is the node currently held in the heap
+	bool Contains(int node) const { return m_Positions[node] != INVALID_POSITION; }
+	//Peek the node at the top of the heap, and its key/tie break
+	int GetTop() const { return m_Heap[0].node; }
+	float GetTopKey() const { return m_Heap[0].key; }
+	float GetTopTieBreak() const { return m_Heap[0].tieBreak; }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Size the heap to hold the given number of unique nodes (only allocates on growth)
+	void Resize(int nodeCount)
+	{
+		if (static_cast<int>(m_Positions.size()) < nodeCount)
+			m_Positions.resize(nodeCount, INVALID_POSITION);
+		m_Heap.reserve(nodeCount);
+	}
+
+	//Empties the heap, resetting only the positions of the nodes still held
+	void Clear()
+	{
+		for (auto& e : m_Heap)
+			m_Positions[e.node] = INVALID_POSITION;
+		m_Heap.clear();
+	}
+
+	//Insert a node that is not currently in the heap
+	void Push(int node, float key, float tieBreak)
+	{
+		m_Heap.push_back({ key, tieBreak, node });
+		m_Positions[node] = static_cast<int>(m_Heap.size()) - 1;
+		SiftUp(static_cast<int>(m_Heap.size()) - 1);
+	}
+
+	//Lower the key of a node already in the heap
+	void DecreaseKey(int node, float key, float tieBreak)
+	{
+		int pos = m_Positions[node];
+		m_Heap[pos].key = key;
+		m_Heap[pos].tieBreak = tieBreak;
+		SiftUp(pos);
+	}
+
+	//Change the key of a node already in the heap (in either direction)
+	void UpdateKey(int node, float key, float tieBreak)
+	{
+		int pos = m_Positions[node];
+		Entry old = m_Heap[pos];
+		m_Heap[pos].key = key;
+		m_Heap[pos].tieBreak = tieBreak;
+		if (IsLower(m_Heap[pos], old))
+			SiftUp(pos);
+		else
+			SiftDown(pos);
+	}
+
+	//Remove a node from anywhere in the heap
+	void Remove(int node)
+	{
+		int pos = m_Positions[node];
+		m_Positions[node] = INVALID_POSITION;
+
+		//Fill the gap with the last entry and restore the heap around it
+		Entry last = m_Heap.back();
+		m_Heap.pop_back();
+		if (pos < static_cast<int>(m_Heap.size()))
+		{
+			m_Heap[pos] = last;
+			m_Positions[last.node] = pos;
+			SiftUp(pos);
+			SiftDown(m_Positions[last.node]);
+		}
+	}
+
+	//Remove and return the node with the lowest key
+	int Pop()
+	{
+		int node = m_Heap[0].node;
+		m_Positions[node] = INVALID_POSITION;
+
+		//Move the last entry to the top and restore the heap
+		if (m_Heap.size() > 1)
+		{
+			m_Heap[0] = m_Heap.back();
+			m_Positions[m_Heap[0].node] = 0;
+			m_Heap.pop_back();
+			SiftDown(0);
+		}
+		else
+		{
+			m_Heap.pop_back();
+		}
+
+		return node;
+	}
+
+private:
+
+	struct Entry
+	{
+		float key;
+		float tieBreak;
+		int node;
+	};
+
+	static constexpr int INVALID_POSITION = -1;
+
+	bool IsLower(const Entry& a, const Entry& b) const
+	{
+		return (a.key < b.key) || (a.key == b.key && a.tieBreak < b.tieBreak);
+	}
+
+	void SiftUp(int pos)
+	{
+		Entry entry = m_Heap[pos];
+		while (pos > 0)
+		{
+			int parent = (pos - 1) >> 1;
+			if (!IsLower(entry, m_Heap[parent]))
+				break;
+
+			m_Heap[pos] = m_Heap[parent];
+			m_Positions[m_Heap[pos].node] = pos;
+			pos = parent;
+		}
+		m_Heap[pos] = entry;
+		m_Positions[entry.node] = pos;
+	}
+
+	void SiftDown(int pos)
+	{
+		int size = static_cast<int>(m_Heap.size());
+		Entry entry = m_Heap[pos];
+		while (true)
+		{
+			int child = (pos << 1) + 1;
+			if (child >= size)
+				break;
+			//Pick the lower of the two children
+			if (child + 1 < size && IsLower(m_Heap[child + 1], m_Heap[child]))
+				++child;
+			if (!IsLower(m_Heap[child], entry))
+				break;
+
+			m_Heap[pos] = m_Heap[child];
+			m_Positions[m_Heap[pos].node] = pos;
+			pos = child;
+		}
+		m_Heap[pos] = entry;
+		m_Positions[entry.node] = pos;
+	}
+
+	//Heap ordered entries
+	std::vector<Entry> m_Heap;
+	//Heap position of each node (or INVALID_POSITION)
+	std::vector<int> m_Positions;
+};
+
+//Index of the lowest set bit (value must be non zero), for walking the set bits of a word
+inline int CountTrailingZeros(uint64_t value)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<int>(index);
+#elif defined(_MSC_VER)
+	//32 bit builds scan each half
+	unsigned long index;
+	if (_BitScanForward(&index, static_cast<unsigned long>(value)))
+		return static_cast<int>(index);
+	_BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+	return static_cast<int>(index) + 32;
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+/*
+	Flat bitset indexed by tile index, one bit per tile.
+*/
+class TileBitset
+{
+public:
+
+	TileBitset() {}
+	~TileBitset() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	bool Test(int index) const { return (m_Words[index >> 6] >> (index & 63)) & 1ull; }
+	int GetBitCount() const { return m_BitCount; }
+
+	//Raw words for word parallel operations (bit i is bit i & 63 of word i >> 6)
+	int GetWordCount() const { return static_cast<int>(m_Words.size()); }
+	const uint64_t* GetWords() const { return m_Words.data(); }
+	uint64_t* GetWords() { return m_Words.data(); }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Size the bitset to hold the given number of bits (only allocates on growth), clearing all bits
+	void Resize(int bitCount)
+	{
+		m_BitCount = bitCount;
+		m_Words.assign((bitCount + 63) >> 6, 0ull);
+	}
+
+	void Set(int index) { m_Words[index >> 6] |= (1ull << (index & 63)); }
+	void Reset(int index) { m_Words[index >> 6] &= ~(1ull << (index & 63)); }
+
+	//Sets bits first to last inclusive, with a masked write to each end word and whole words between
+	void SetRange(int first, int last)
+	{
+		int firstWord = first >> 6;
+		int lastWord = last >> 6;
+		uint64_t firstMask = ~0ull << (first & 63);
+		uint64_t lastMask = ~0ull >> (63 - (last & 63));
+		if (firstWord == lastWord)
+		{
+			m_Words[firstWord] |= firstMask & lastMask;
+			return;
+		}
+
+		m_Words[firstWord] |= firstMask;
+		for (int w(firstWord + 1); w < lastWord; ++w)
+			m_Words[w] = ~0ull;
+		m_Words[lastWord] |= lastMask;
+	}
+
+	//Exchanges contents with another bitset (without copying the words)
+	void Swap(TileBitset& other)
+	{
+		m_Words.swap(other.m_Words);
+		std::swap(m_BitCount, other.m_BitCount);
+	}
+
+	//Clears every bit
+	void ClearAll()
+	{
+		for (auto& w : m_Words)
+			w = 0ull;
+	}
+
+private:
+
+	std::vector<uint64_t> m_Words;
+	int m_BitCount = 0;
+};
+
+/*
+	Open addressing (linear probing) hash map from 64 bit keys to non-negative ints, for sparse data such as
+	space-time states. Slots are stamped with a generation like the search arena, so clearing is a single increment.
+	Grows by doubling when over half full, so a warm map does not allocate.
+*/
+class StampedHashMap
+{
+public:
+
+	StampedHashMap() {}
+	~StampedHashMap() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	int GetSize() const { return m_Size; }
+
+	//Value held for the key, or -1 if there isn't one
+	int Find(uint64_t key) const
+	{
+		if (m_Slots.empty())
+			return -1;
+
+		for (size_t i = Hash(key); ; i = (i + 1) & m_Mask)
+		{
+			const Slot& s = m_Slots[i];
+			if (s.generation != m_Generation)
+				return -1;
+			if (s.key == key)
+				return s.value;
+		}
+	}
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Inserts the key, or overwrites its value if already held
+	void Insert(uint64_t key, int value)
+	{
+		if ((m_Size + 1) * 2 > static_cast<int>(m_Slots.size()))
+			Grow();
+
+		for (size_t i = Hash(key); ; i = (i + 1) & m_Mask)
+		{
+			Slot& s = m_Slots[i];
+			if (s.generation != m_Generation)
+			{
+				s.key = key;
+				s.value = value;
+				s.generation = m_Generation;
+				++m_Size;
+				return;
+			}
+			if (s.key == key)
+			{
+				s.value = value;
+				return;
+			}
+		}
+	}
+
+	//Sizes the map to hold the given number of keys without growing
+	void Reserve(int count)
+	{
+		while (count * 2 > static_cast<int>(m_Slots.size()))
+			Grow();
+	}
+
+	//Empties the map, wiping the slots only on the rare occasion the stamp wraps
+	void Clear()
+	{
+		m_Size = 0;
+		if (++m_Generation == 0)
+		{
+			for (auto& s : m_Slots)
+				s.generation = 0;
+			m_Generation = 1;
+		}
+	}
+
+private:
+
+	struct Slot
+	{
+		uint64_t key = 0;
+		int value = 0;
+		uint32_t generation = 0;
+	};
+
+	//Fibonacci hashing, spreading clustered keys (neighbouring cells and times) across the table
+	size_t Hash(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> m_Shift); }
+
+	//Doubles the table, re-inserting the live slots
+	void Grow()
+	{
+		std::vector<Slot> old;
+		old.swap(m_Slots);
+		uint32_t oldGeneration = m_Generation;
+
+		size_t capacity = old.empty() ? 64 : old.size() * 2;
+		m_Slots.assign(capacity, Slot());
+		m_Mask = capacity - 1;
+		m_Shift = 64;
+		for (size_t c = capacity; c > 1; c >>= 1)
+			--m_Shift;
+		m_Generation = 1;
+		m_Size = 0;
+
+		for (auto& s : old)
+			if (s.generation == oldGeneration)
+				Insert(s.key, s.value);
+	}
+
+	std::vector<Slot> m_Slots;
+	size_t m_Mask = 0;
+	int m_Shift = 64;
+	//Current stamp (0 is never used so default slots are always empty)
+	uint32_t m_Generation = 1;
+	int m_Size = 0;
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>		//std::strcmp
+#include <utility>		//std::integer_sequence
+
+/*
+	Range and area shapes a skill can use, named in AbilityData.json by their entry in RANGE_SHAPE_NAMES
+*/
+enum class RANGE_SHAPE
+{
+	//The grid topologys own range shape (diamond on the 4 way map)
+	DIAMOND,
+	SQUARE,
+	//Straight out from the centre in the facing
+	LINE,
+	//Widening by a cell either side for each step out in the facing
+	CONE,
+	//Outline of the diamond, only the cells exactly radius away
+	RING,
+	COUNT
+};
+
+/*
+	Which way line and cone shapes point. ALL is every way at once (a cross for lines, a square for cones), used where
+	there is no facing such as the targeting grid around a unit. Other shapes ignore the facing.
+*/
+enum class SHAPE_FACING
+{
+	NORTH,
+	EAST,
+	SOUTH,
+	WEST,
+	ALL,
+	COUNT
+};
+
+constexpr const char* RANGE_SHAPE_NAMES[static_cast<int>(RANGE_SHAPE::COUNT)] = { "Diamond", "Square", "Line", "Cone", "Ring" };
+
+//Finds the shape with the given name, returning false (and leaving the shape as it was) if there isn't one
+inline bool ParseRangeShape(const char* name, RANGE_SHAPE& shape)
+{
+	for (int i(0); i < static_cast<int>(RANGE_SHAPE::COUNT); ++i)
+	{
+		if (std::strcmp(name, RANGE_SHAPE_NAMES[i]) == 0)
+		{
+			shape = static_cast<RANGE_SHAPE>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+//Facing along the longer axis of a coordinate delta (ALL for no delta), ties going to the vertical
+inline SHAPE_FACING FacingTowards(int dx, int dy)
+{
+	int ax = dx < 0 ? -dx : dx;
+	int ay = dy < 0 ? -dy : dy;
+	if (ax == 0 && ay == 0)
+		return SHAPE_FACING::ALL;
+	if (ay >= ax)
+		return dy < 0 ? SHAPE_FACING::NORTH : SHAPE_FACING::SOUTH;
+	return dx < 0 ? SHAPE_FACING::WEST : SHAPE_FACING::EAST;
+}
+
+//The x offsets a shape covers on one of its rows, as up to two inclusive spans (the ring is the only shape with two)
+struct ShapeRowSpans
+{
+	static constexpr int MAX_SPANS = 2;
+
+	int count = 0;
+	int minX[MAX_SPANS] = { 0, 0 };
+	int maxX[MAX_SPANS] = { 0, 0 };
+
+	constexpr void Add(int min, int max)
+	{
+		if (min <= max)
+		{
+			minX[count] = min;
+			maxX[count] = max;
+			++count;
+		}
+	}
+};
+
+/*
+	Shape library for a grid topology. Every shape is described row by row as spans of x offsets from its centre, so
+	laying one onto a row major grid is a clip and a contiguous run of cells per span rather than a test per tile.
+
+	RowSpans works a row out from the shape definition. For every shape and facing, the rows of each radius up to
+	TABLE_RADIUS are worked out at compile time into constant tables (one per shape and facing, so each stays well
+	inside the compilers constant evaluation limits), and looked up at run time. Larger radii fall back to RowSpans.
+
+	LINE and CONE are laid out in square grid terms whatever the topology.
+*/
+template<typename Topology>
+class RangeShapeLibrary
+{
+public:
+
+	//Largest radius held in the tables
+	static constexpr int TABLE_RADIUS = 15;
+
+	//Works out the spans of row dy (relative to the centre) of a shape, empty outside it
+	static constexpr ShapeRowSpans RowSpans(RANGE_SHAPE shape, SHAPE_FACING facing, int radius, int dy)
+	{
+		ShapeRowSpans row;
+		int ady = dy < 0 ? -dy : dy;
+		if (radius < 0 || ady > radius)
+			return row;
+
+		switch (shape)
+		{
+		case RANGE_SHAPE::DIAMOND:
+			row.Add(Topology::RowSpanMin(dy, radius), Topology::RowSpanMax(dy, radius));
+			break;
+
+		case RANGE_SHAPE::SQUARE:
+			row.Add(-radius, radius);
+			break;
+
+		case RANGE_SHAPE::LINE:
+			switch (facing)
+			{
+			case SHAPE_FACING::NORTH: if (dy <= 0) row.Add(0, 0); break;
+			case SHAPE_FACING::SOUTH: if (dy >= 0) row.Add(0, 0); break;
+			case SHAPE_FACING::EAST: if (dy == 0) row.Add(0, radius); break;
+			case SHAPE_FACING::WEST: if (dy == 0) row.Add(-radius, 0); break;
+			default:
+				if (dy == 0)
+					row.Add(-radius, radius);
+				else
+					row.Add(0, 0);
+				break;
+			}
+			break;
+
+		case RANGE_SHAPE::CONE:
+			switch (facing)
+			{
+			case SHAPE_FACING::NORTH: if (dy <= 0) row.Add(-ady, ady); break;
+			case SHAPE_FACING::SOUTH: if (dy >= 0) row.Add(-ady, ady); break;
+			case SHAPE_FACING::EAST: row.Add(ady, radius); break;
+			case SHAPE_FACING::WEST: row.Add(-radius, -ady); break;
+			default: row.Add(-radius, radius); break;
+			}
+			break;
+
+		case RANGE_SHAPE::RING:
+		{
+			//The topology shape less the shape one smaller, leaving either side of the inner span
+			int outerMin = Topology::RowSpanMin(dy, radius);
+			int outerMax = Topology::RowSpanMax(dy, radius);
+			if (ady > radius - 1)
+			{
+				row.Add(outerMin, outerMax);
+				break;
+			}
+			row.Add(outerMin, Topology::RowSpanMin(dy, radius - 1) - 1);
+			row.Add(Topology::RowSpanMax(dy, radius - 1) + 1, outerMax);
+			break;
+		}
+
+		default:
+			break;
+		}
+		return row;
+	}
+
+	//Spans of row dy of a shape, from the tables where the radius is covered
+	static ShapeRowSpans GetRowSpans(RANGE_SHAPE shape, SHAPE_FACING facing, int radius, int dy)
+	{
+		if (radius < 0 || radius > TABLE_RADIUS || dy < -radius || dy > radius)
+			return RowSpans(shape, facing, radius, dy);
+
+		const TableRow& r = GetTable(shape, facing)[radius * radius + dy + radius];
+		ShapeRowSpans row;
+		for (int i(0); i < r.count; ++i)
+			row.Add(r.minX[i], r.maxX[i]);
+		return row;
+	}
+
+	//Calls func(dy, minX, maxX) for each span of the shape, top row first
+	template<typename Func>
+	static void ForEachSpan(RANGE_SHAPE shape, SHAPE_FACING facing, int radius, Func&& func)
+	{
+		if (radius < 0)
+			return;
+
+		if (radius > TABLE_RADIUS)
+		{
+			for (int dy(-radius); dy <= radius; ++dy)
+			{
+				ShapeRowSpans row = RowSpans(shape, facing, radius, dy);
+				for (int i(0); i < row.count; ++i)
+					func(dy, row.minX[i], row.maxX[i]);
+			}
+			return;
+		}
+
+		const TableRow* rows = GetTable(shape, facing) + radius * radius;
+		for (int dy(-radius); dy <= radius; ++dy)
+		{
+			const TableRow& r = rows[dy + radius];
+			for (int i(0); i < r.count; ++i)
+				func(dy, static_cast<int>(r.minX[i]), static_cast<int>(r.maxX[i]));
+		}
+	}
+
+	//Is the offset from the centre inside the shape
+	static bool Contains(RANGE_SHAPE shape, SHAPE_FACING facing, int radius, int dx, int dy)
+	{
+		ShapeRowSpans row = GetRowSpans(shape, facing, radius, dy);
+		for (int i(0); i < row.count; ++i)
+		{
+			if (dx >= row.minX[i] && dx <= row.maxX[i])
+				return true;
+		}
+		return false;
+	}
+
+	//Smallest topology range (radius of the DIAMOND shape) holding the whole shape
+	static int GetBoundingRange(RANGE_SHAPE shape, SHAPE_FACING facing, int radius)
+	{
+		//Every shape is convex along its rows, so only the span ends need checking
+		int range = 0;
+		ForEachSpan(shape, facing, radius, [&](int dy, int minX, int maxX)
+		{
+			int a = Topology::Distance(minX, dy, 1);
+			int b = Topology::Distance(maxX, dy, 1);
+			range = range > a ? range : a;
+			range = range > b ? range : b;
+		});
+		return range;
+	}
+
+private:
+
+	static constexpr int SHAPE_COUNT = static_cast<int>(RANGE_SHAPE::COUNT);
+	static constexpr int FACING_COUNT = static_cast<int>(SHAPE_FACING::COUNT);
+	//Radius r has 2r + 1 rows, so the rows of radius r start at r * r
+	static constexpr int TABLE_ROWS = (TABLE_RADIUS + 1) * (TABLE_RADIUS + 1);
+
+	struct TableRow
+	{
+		int8_t count;
+		int8_t minX[ShapeRowSpans::MAX_SPANS];
+		int8_t maxX[ShapeRowSpans::MAX_SPANS];
+	};
+
+	struct Table
+	{
+		TableRow rows[TABLE_ROWS];
+	};
+
+	static constexpr Table BuildTable(RANGE_SHAPE shape, SHAPE_FACING facing)
+	{
+		Table table{};
+		for (int radius(0); radius <= TABLE_RADIUS; ++radius)
+		{
+			for (int dy(-radius); dy <= radius; ++dy)
+			{
+				ShapeRowSpans row = RowSpans(shape, facing, radius, dy);
+				TableRow& r = table.rows[radius * radius + dy + radius];
+				r.count = static_cast<int8_t>(row.count);
+				for (int i(0); i < row.count; ++i)
+				{
+					r.minX[i] = static_cast<int8_t>(row.minX[i]);
+					r.maxX[i] = static_cast<int8_t>(row.maxX[i]);
+				}
+			}
+		}
+		return table;
+	}
+
+	//Table of shape and facing index / FACING_COUNT, index % FACING_COUNT
+	template<int Index>
+	struct TableFor
+	{
+		static constexpr Table TABLE = BuildTable(static_cast<RANGE_SHAPE>(Index / FACING_COUNT), static_cast<SHAPE_FACING>(Index % FACING_COUNT));
+	};
+
+	template<int... Indexes>
+	static const TableRow* GetTable(int index, std::integer_sequence<int, Indexes...>)
+	{
+		static constexpr const TableRow* tables[] = { TableFor<Indexes>::TABLE.rows... };
+		return tables[index];
+	}
+
+	static const TableRow* GetTable(RANGE_SHAPE shape, SHAPE_FACING facing)
+	{
+		return GetTable(static_cast<int>(shape) * FACING_COUNT + static_cast<int>(facing),
+			std::make_integer_sequence<int, SHAPE_COUNT * FACING_COUNT>());
+	}
+};
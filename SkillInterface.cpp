@@ -1,68 +1,32 @@
 #include "SkillInterface.h"
 #include "UnitEntity.h"
 
-float PhysicalAttack::DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer)
+CombatSkill PhysicalAttack::GetCombatSkill()
 {
-	m_Damage = (AttPlayer->GetClassTotals().TotalPhysAttack * m_Data.PhysDamageScaling) -
-		DefPlayer->GetClassTotals().TotalPhysArmour;
-	if (m_Damage < 0)
-	{
-		m_Damage = 0;
-	}
-	DefPlayer->GetClassTotals().CurrentHP -= m_Damage;
-	return 0;
-}
-
-float PhysicalAttack::DoCrit(UnitEntity* AttPlayer, UnitEntity* DefPlayer)
-{
-	m_Damage = ((AttPlayer->GetClassTotals().TotalPhysAttack * m_Data.PhysDamageScaling) -
-		DefPlayer->GetClassTotals().TotalPhysArmour) *
-		AttPlayer->GetClassTotals().TotalCritMultiplier;
-	if (m_Damage < 0)
-	{
-		m_Damage = 0;
-	}
-	DefPlayer->GetClassTotals().CurrentHP -= m_Damage;
-
-	return 0;
-}
-
-float MagicalAttack::DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer)
-{
-	m_Damage = (AttPlayer->GetClassTotals().TotalMagAttack * m_Data.MagDamageScaling) -
-		DefPlayer->GetClassTotals().TotalMagArmour;
-	if (m_Damage < 0)
-	{
-		m_Damage = 0;
-	}
-	DefPlayer->GetClassTotals().CurrentHP -= m_Damage;
-
-	return 0;
+	CombatSkill skill;
+	skill.skillType = m_Data.SkillType;
+	skill.damageType = CombatResolver::PHYSICAL;
+	skill.damageScaling = m_Data.PhysDamageScaling;
+	skill.innateCrit = m_Data.InnateCrit;
+	return skill;
 }
 
-float MagicalAttack::DoCrit(UnitEntity* AttPlayer, UnitEntity* DefPlayer)
+CombatSkill MagicalAttack::GetCombatSkill()
 {
-	m_Damage = ((AttPlayer->GetClassTotals().TotalMagAttack * m_Data.MagDamageScaling) -
-		DefPlayer->GetClassTotals().TotalMagArmour) *
-		AttPlayer->GetClassTotals().TotalCritMultiplier;
-	if (m_Damage < 0)
-	{
-		m_Damage = 0;
-	}
-	DefPlayer->GetClassTotals().CurrentHP -= m_Damage;
-	return 0;
+	CombatSkill skill;
+	skill.skillType = m_Data.SkillType;
+	skill.damageType = CombatResolver::MAGICAL;
+	skill.damageScaling = m_Data.MagDamageScaling;
+	skill.innateCrit = m_Data.InnateCrit;
+	return skill;
 }
 
-float Heal::DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer)
+CombatSkill Heal::GetCombatSkill()
 {
-	DefPlayer->GetClassTotals().CurrentHP +=
-		AttPlayer->GetClassTotals().MaxHP * m_Data.HealPercent;
-	if (DefPlayer->GetClassTotals().CurrentHP > DefPlayer->GetClassTotals().MaxHP)
-	{
-		DefPlayer->GetClassTotals().CurrentHP = DefPlayer->GetClassTotals().MaxHP;
-	}
-
-	return 0;
+	CombatSkill skill;
+	skill.skillType = m_Data.SkillType;
+	skill.healPercent = m_Data.HealPercent;
+	return skill;
 }
 
 float Buff::DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer)
@@ -84,3 +48,10 @@ float Buff::DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer)
 
 	return 0;
 }
+
+CombatSkill Buff::GetCombatSkill()
+{
+	CombatSkill skill;
+	skill.skillType = m_Data.SkillType;
+	return skill;
+}
\ No newline at end of file
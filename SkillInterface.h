@@ -1,6 +1,7 @@
 #pragma once
 
 #include "D3DUtils.h"
+#include "CombatResolver.h"		//Combat numbers
 #include <string>
 
 class UnitEntity;
@@ -9,8 +10,9 @@ class SkillInterface
 {
 public:
 
+	//Applies the skills effects other than HP changes, which are only applied from a resolved CombatOutcome
+	//(see GameplayManager::ApplyOutcome)
 	virtual float DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer) { return 0; };
-	virtual float DoCrit(UnitEntity* AttPlayer, UnitEntity* DefPlayer) { return 0; };
 	virtual const std::string& GetActionName() = 0;
 	virtual const std::string& GetTooltip() = 0;
 	virtual int GetManaCost() = 0;
@@ -19,7 +21,12 @@ public:
 	virtual int GetDamageType() { return -1; };
 	virtual int GetSkillRange() = 0;
 	virtual int GetSkillRadius() = 0;
+	//Shape of the targeting grid around the user, and of the area around the target
+	virtual RANGE_SHAPE GetRangeShape() = 0;
+	virtual RANGE_SHAPE GetRadiusShape() = 0;
 	virtual float GetSkillCrit() { return -1; };
+	//Numbers the CombatResolver needs from the skill
+	virtual CombatSkill GetCombatSkill() = 0;
 private:
 
 };
@@ -34,9 +41,6 @@ private:
 class PhysicalAttack : public SkillInterface
 {
 public:
-	//Calculates damage value
-	float DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer) override;
-	float DoCrit(UnitEntity* player1, UnitEntity* player2) override;
 	//Get//
 	const std::string& GetActionName() override { return m_Data.Name; }
 	std::string& GetTooltip() override { return m_Data.ToolTip; }
@@ -46,20 +50,19 @@ public:
 	int GetTargeting() override { return m_Data.Targeting; }
 	int GetSkillRange() override { return m_Data.Range; }
 	int GetSkillRadius() override { return m_Data.Radius; }
+	RANGE_SHAPE GetRangeShape() override { return m_Data.RangeShape; }
+	RANGE_SHAPE GetRadiusShape() override { return m_Data.RadiusShape; }
 	float GetSkillCrit() override { return m_Data.InnateCrit; }
+	CombatSkill GetCombatSkill() override;
 	DamageSkills& GetData() { return m_Data; }
 	
 private:
 	DamageSkills m_Data;
-	float m_Damage = 0.0f;
 };
 
 class MagicalAttack : public SkillInterface
 {
 public:
-	//Calculates damage value
-	float DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer) override;
-	float DoCrit(UnitEntity* AttPlayer, UnitEntity* DefPlayer) override;
 	//Get//
 	const std::string& GetActionName() override { return m_Data.Name; }
 	std::string& GetTooltip() override { return m_Data.ToolTip; }
@@ -69,18 +72,18 @@ public:
 	int GetTargeting() override { return m_Data.Targeting; }
 	int GetSkillRange() override { return m_Data.Range; }
 	int GetSkillRadius() override { return m_Data.Radius; }
+	RANGE_SHAPE GetRangeShape() override { return m_Data.RangeShape; }
+	RANGE_SHAPE GetRadiusShape() override { return m_Data.RadiusShape; }
 	float GetSkillCrit() override { return m_Data.InnateCrit; }
+	CombatSkill GetCombatSkill() override;
 	DamageSkills& GetData() { return m_Data; }
 private:
 	DamageSkills m_Data;
-	float m_Damage = 0.0f;
 };
 
 class Heal : public SkillInterface
 {
 public:
-	//Calculates heal value
-	float DoAction(UnitEntity* AttPlayer, UnitEntity* DefPlayer) override;
 	//Get//
 	const std::string& GetActionName() override { return m_Data.Name; }
 	std::string& GetTooltip() override { return m_Data.ToolTip; }
@@ -90,6 +93,9 @@ public:
 	int GetTargeting() override { return m_Data.Targeting; }
 	int GetSkillRange() override { return m_Data.Range; }
 	int GetSkillRadius() override { return m_Data.Radius; }
+	RANGE_SHAPE GetRangeShape() override { return m_Data.RangeShape; }
+	RANGE_SHAPE GetRadiusShape() override { return m_Data.RadiusShape; }
+	CombatSkill GetCombatSkill() override;
 	HealSkills& GetData() { return m_Data; }
 private:
 	HealSkills m_Data;
@@ -110,6 +116,9 @@ public:
 	int GetTargeting() override { return m_Data.Targeting; }
 	int GetSkillRange() override { return m_Data.Range; }
 	int GetSkillRadius() override { return m_Data.Radius; }
+	RANGE_SHAPE GetRangeShape() override { return m_Data.RangeShape; }
+	RANGE_SHAPE GetRadiusShape() override { return m_Data.RadiusShape; }
+	CombatSkill GetCombatSkill() override;
 	BuffSkills& GetData() { return m_Data; }
 private:
 	BuffSkills m_Data;
@@ -11,123 +11,78 @@ DiamondRadiusTargeting::~DiamondRadiusTargeting()
 
 }
 
-void DiamondRadiusTargeting::GenerateTargetGrid(const std::vector<MapTile*>& tiles, const XMINT2& startCoords, int range)
+void DiamondRadiusTargeting::GenerateTargetGrid(const XMINT2& startCoords, int range, RANGE_SHAPE shape)
 {
-	
-	for (int i(0); i < range + 1; ++i)
+	if (!m_Visibility)
 	{
-		//Topside + Origin row
-		for (int j = -i - 1; j < i; ++j)
-		{
-			//Grab tile at index
-			int xAdj = (startCoords.x) - j - 1;
-			int yAdj = startCoords.y - range + i;
-			int index = (xAdj + yAdj) + (yAdj * m_MapRowLength);
-
-			//Prevent invalid index access and drawing on tiles that would be drawn due to screen wrapping.
-			if (!(index < 0 || index > tiles.size()) && !(xAdj < 0 || xAdj > m_MapRowLength))
-			{
-				MapTile* tile = tiles.at(index);
-				tile->SetDrawGridFlag(true);
-				tile->GetGridSprite().SetFrame(m_FrameIndex);
-				m_TileManifest.insert(tile);
-			}
-		}
-		//Botside
-		for (int j = range - 1 - i; j > -range + i; --j)
-		{
-			//Grab tile at index
-			int xAdj = startCoords.x - j;
-			int yAdj = startCoords.y + i + 1;
-			int index = (xAdj + yAdj) + (yAdj * m_MapRowLength);
-
-			//Prevent invalid index access and drawing on tiles that would be drawn due to screen wrapping.
-			if (!(index < 0 || index > tiles.size()) && !(xAdj < 0 || xAdj > m_MapRowLength))
-			{
-				MapTile* tile = tiles.at(index);
-				tile->SetDrawGridFlag(true);
-				tile->GetGridSprite().SetFrame(m_FrameIndex);
-				m_TileManifest.insert(tile);
-			}
-		}
+		StampShape(startCoords, range, shape, SHAPE_FACING::ALL, TILE_OVERLAY::ATTACK);
+		return;
 	}
 
+	//Range shape ANDed with what the user can see
+	m_Visibility->ForEachVisibleInShape(m_NavGrid->CoordsToCell(startCoords.x, startCoords.y), shape, range, [&](int cell)
+	{
+		m_Overlays->Set(TILE_OVERLAY::ATTACK, cell);
+	});
 }
 
 void DiamondRadiusTargeting::DisableGrid()
 {
-	for (auto& a : m_TileManifest)
-	{
-		a->SetDrawGridFlag(false);
-	}
-
-	m_TileManifest.clear();
+	m_Overlays->Clear(TILE_OVERLAY::ATTACK);
 }
 
 bool DiamondRadiusTargeting::IsTargetInGrid(const XMINT2& unitCoords)
 {
-	//Check each member in the manifest and search for coordinate match
-	for (auto& a : m_TileManifest)
-	{
-		if (a->GetMapCoordinates().x == unitCoords.x && a->GetMapCoordinates().y == unitCoords.y)
-			return true;
-	}	
-	return false;
+	return IsCoordInLayer(unitCoords, TILE_OVERLAY::ATTACK);
 }
 
-void DiamondRadiusTargeting::GenerateAoEGrid(const std::vector<MapTile*>& tiles, const DirectX::XMINT2& cursorCoords, int radius)
+void DiamondRadiusTargeting::GenerateAoEGrid(const DirectX::XMINT2& cursorCoords, int radius, RANGE_SHAPE shape, SHAPE_FACING facing)
 {
-	for (int i(0); i < radius + 1; ++i)
-	{
-		//Topside + Origin row
-		for (int j = -i - 1; j < i; ++j)
-		{
-			//Grab tile at index
-			int xAdj = (cursorCoords.x) - j - 1;
-			int yAdj = cursorCoords.y - radius + i;
-			int index = (xAdj + yAdj) + (yAdj * m_MapRowLength);
-
-			//Prevent invalid index access and drawing on tiles that would be drawn due to screen wrapping.
-			if (!(index < 0 || index > tiles.size()) && !(xAdj < 0 || xAdj > m_MapRowLength))
-			{
-				MapTile* tile = tiles.at(index);
-				tile->SetDrawGridFlag(false);
-				tile->GetGridSprite().SetFrame(m_FrameIndex);
-				m_AoeTileManifest.insert(tile);
-			}
-		}
-		//Botside
-		for (int j = radius - 1 - i; j > -radius + i; --j)
-		{
-			//Grab tile at index
-			int xAdj = cursorCoords.x - j;
-			int yAdj = cursorCoords.y + i + 1;
-			int index = (xAdj + yAdj) + (yAdj * m_MapRowLength);
-
-			//Prevent invalid index access and drawing on tiles that would be drawn due to screen wrapping.
-			if (!(index < 0 || index > tiles.size()) && !(xAdj < 0 || xAdj > m_MapRowLength))
-			{
-				MapTile* tile = tiles.at(index);
-				tile->SetDrawGridFlag(false);
-				tile->GetGridSprite().SetFrame(m_FrameIndex);
-				m_AoeTileManifest.insert(tile);
-			}
-		}
-	}
+	StampShape(cursorCoords, radius, shape, facing, TILE_OVERLAY::AOE);
 }
 
 void DiamondRadiusTargeting::DisableAoEGrid()
 {
-	m_AoeTileManifest.clear();
+	m_Overlays->Clear(TILE_OVERLAY::AOE);
 }
 
 bool DiamondRadiusTargeting::IsUnitInAoEGrid(const DirectX::XMINT2& unitCoords)
 {
-	//Check each member in the manifest and search for coordinate match
-	for (auto& a : m_AoeTileManifest)
+	return IsCoordInLayer(unitCoords, TILE_OVERLAY::AOE);
+}
+
+const std::vector<AoEPlacement>& DiamondRadiusTargeting::FindAoEPlacements(const XMINT2& userCoords, int range, RANGE_SHAPE rangeShape,
+	int radius, RANGE_SHAPE radiusShape, const std::vector<AoETarget>& targets, int count, bool centreOnTarget)
+{
+	AoEPlacementQuery query;
+	query.casterCell = m_NavGrid->CoordsToCell(userCoords.x, userCoords.y);
+	query.rangeShape = rangeShape;
+	query.range = range;
+	query.areaShape = radiusShape;
+	query.radius = radius;
+	query.targets = &targets;
+	query.count = count;
+	query.visibility = m_Visibility;
+	query.centreOnTarget = centreOnTarget;
+
+	m_PlacementSearch.Run(*m_NavGrid, query);
+	return m_PlacementSearch.GetPlacements();
+}
+
+void DiamondRadiusTargeting::StampShape(const XMINT2& centre, int radius, RANGE_SHAPE shape, SHAPE_FACING facing, TILE_OVERLAY layer)
+{
+	//Spans come already clipped to the map edges by the grid, each a contiguous run of cells
+	m_NavGrid->ForEachSpanInShape(centre.x, centre.y, shape, facing, radius, [&](int firstCell, int lastCell)
 	{
-		if (a->GetMapCoordinates().x == unitCoords.x && a->GetMapCoordinates().y == unitCoords.y)
-			return true;
-	}
-	return false;
+		m_Overlays->SetSpan(layer, firstCell, lastCell);
+	});
+}
+
+bool DiamondRadiusTargeting::IsCoordInLayer(const XMINT2& coords, TILE_OVERLAY layer)
+{
+	//Nothing generated yet, or off the map
+	if (!m_NavGrid || !m_NavGrid->IsInBounds(coords.x, coords.y))
+		return false;
+
+	return m_Overlays->Test(layer, m_NavGrid->CoordsToCell(coords.x, coords.y));
 }
@@ -2,10 +2,15 @@
 
 #include "D3DUtils.h"
 #include "MapTile.h"
-#include <set>
+#include "NavGrid.h"					//Grid dimensions
+#include "TileOverlay.h"				//Target and AoE overlays
+#include "LineOfSight.h"				//Walls blocking targeting
+#include "AoEPlacement.h"				//AoE auto aim
 
 /*
-	Diamond style radius targetting system. For use with the MapTile object
+	Radius targetting system. For use with the MapTile object
+	(shapes come from the nav grids shape library, diamond being the topologys own shape).
+	Ranges are stamped into the ATTACK and AOE overlay layers a row span at a time.
 */
 class DiamondRadiusTargeting
 {
@@ -18,8 +23,13 @@ public:
 	/// Set ///
 	///////////
 
-	void SetTileOverlayFrameIndex(int index) { m_FrameIndex = index; }
-	void SetTileMapLength(int mapRowLength) { m_MapRowLength = mapRowLength; }
+	void SetTileOverlayFrameIndex(int index) { m_Overlays->SetFrame(TILE_OVERLAY::ATTACK, index); }
+	//Grid the targeting shapes are laid out on
+	void SetNavGrid(const NavGrid* grid) { m_NavGrid = grid; }
+	//Overlays the ranges are written to, sized to the nav grid
+	void SetOverlays(TileOverlayLayers* overlays) { m_Overlays = overlays; }
+	//Limits target grids to tiles in sight of the user (nullptr to target through walls)
+	void SetVisibility(const VisibilityCache* visibility) { m_Visibility = visibility; }
 
 	///////////
 	/// Get ///
@@ -32,23 +42,38 @@ public:
 
 	//Target grid operations
 
-	void GenerateTargetGrid(const std::vector<MapTile*>& tiles, const DirectX::XMINT2& startCoords, int range);
-	//Disables tile effect off on each member of the manifest and releases them
+	//Lays out the range shape around the user, less any tiles out of sight if a visibility cache is set
+	void GenerateTargetGrid(const DirectX::XMINT2& startCoords, int range, RANGE_SHAPE shape = RANGE_SHAPE::DIAMOND);
+	//Clears the target overlay
 	void DisableGrid();
 	//Check by coordinate if the target is inside of the grid
 	bool IsTargetInGrid(const DirectX::XMINT2& unitCoords);
 
 	//AoE grid operations
-	void GenerateAoEGrid(const std::vector<MapTile*>& tiles, const DirectX::XMINT2& cursorCoords, int radius);
+
+	//Lays out the area around the cursor, lines and cones pointing in the facing
+	void GenerateAoEGrid(const DirectX::XMINT2& cursorCoords, int radius, RANGE_SHAPE shape = RANGE_SHAPE::DIAMOND,
+		SHAPE_FACING facing = SHAPE_FACING::ALL);
 	void DisableAoEGrid();
 	bool IsUnitInAoEGrid(const DirectX::XMINT2& unitCoords);
+
+	/*
+		Best centres for the area of a skill used from the users position, scored by the weight of the targets each
+		covers (see AoEPlacementSearch). Centres follow the target grid: inside the range shape, and in sight of the
+		user if a visibility cache is set. Only tiles holding a target are used if centreOnTarget is set.
+	*/
+	const std::vector<AoEPlacement>& FindAoEPlacements(const DirectX::XMINT2& userCoords, int range, RANGE_SHAPE rangeShape,
+		int radius, RANGE_SHAPE radiusShape, const std::vector<AoETarget>& targets, int count, bool centreOnTarget);
 private:
-	//Track the currently stored coordinates
-	std::set<MapTile*> m_TileManifest;
-	std::set<MapTile*> m_AoeTileManifest;
-
-	//Hold tile overlay frame index here
-	int m_FrameIndex = 0;
-	//Hold on to the tile map length for container searches
-	int m_MapRowLength = 0;
+
+	//Adds every cell within the shape to the layer, clipped to the map edges
+	void StampShape(const DirectX::XMINT2& centre, int radius, RANGE_SHAPE shape, SHAPE_FACING facing, TILE_OVERLAY layer);
+	//Is the coordinate on the map and in the layer
+	bool IsCoordInLayer(const DirectX::XMINT2& coords, TILE_OVERLAY layer);
+
+	//Grid that the tiles are laid out on
+	const NavGrid* m_NavGrid = nullptr;
+	TileOverlayLayers* m_Overlays = nullptr;
+	const VisibilityCache* m_Visibility = nullptr;
+	AoEPlacementSearch m_PlacementSearch;
 };
\ No newline at end of file
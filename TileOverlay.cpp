@@ -0,0 +1,98 @@
+#include "TileOverlay.h"
+
+bool TileOverlayLayers::IsEmpty(TILE_OVERLAY layer) const
+{
+	bool empty = true;
+	ForEachCell(layer, [&](int) { empty = false; });
+	return empty;
+}
+
+int TileOverlayLayers::GetCount(TILE_OVERLAY layer) const
+{
+	int count = 0;
+	ForEachCell(layer, [&](int) { ++count; });
+	return count;
+}
+
+void TileOverlayLayers::Resize(int cellCount)
+{
+	m_CellCount = cellCount;
+	int wordCount = (cellCount + 63) >> 6;
+	for (auto& l : m_Layers)
+	{
+		l.bits.Resize(cellCount);
+		l.summary.Resize(wordCount);
+	}
+	m_Marked.Resize(wordCount);
+}
+
+void TileOverlayLayers::Clear(TILE_OVERLAY layer)
+{
+	Layer& l = m_Layers[Index(layer)];
+	uint64_t* words = l.bits.GetWords();
+	uint64_t* summary = l.summary.GetWords();
+	for (int s(0); s < l.summary.GetWordCount(); ++s)
+	{
+		for (uint64_t marked = summary[s]; marked; marked &= marked - 1)
+			words[(s << 6) + CountTrailingZeros(marked)] = 0ull;
+		summary[s] = 0ull;
+	}
+}
+
+void TileOverlayLayers::ClearAll()
+{
+	for (int i(0); i < LAYER_COUNT; ++i)
+		Clear(static_cast<TILE_OVERLAY>(i));
+}
+
+template<typename SummaryOp, typename WordOp>
+void TileOverlayLayers::Combine(TILE_OVERLAY destination, TILE_OVERLAY a, TILE_OVERLAY b, SummaryOp&& summaryOp, WordOp&& wordOp)
+{
+	Layer& d = m_Layers[Index(destination)];
+	const uint64_t* wordsA = m_Layers[Index(a)].bits.GetWords();
+	const uint64_t* wordsB = m_Layers[Index(b)].bits.GetWords();
+	const uint64_t* summaryA = m_Layers[Index(a)].summary.GetWords();
+	const uint64_t* summaryB = m_Layers[Index(b)].summary.GetWords();
+	uint64_t* words = d.bits.GetWords();
+	uint64_t* summary = d.summary.GetWords();
+	uint64_t* marked = m_Marked.GetWords();
+
+	//Work out the result's words first, as the destination may be a source
+	for (int s(0); s < m_Marked.GetWordCount(); ++s)
+		marked[s] = summaryOp(summaryA[s], summaryB[s]);
+
+	for (int s(0); s < m_Marked.GetWordCount(); ++s)
+	{
+		//Zero the destination words that fall outside the result
+		for (uint64_t stale = summary[s] & ~marked[s]; stale; stale &= stale - 1)
+			words[(s << 6) + CountTrailingZeros(stale)] = 0ull;
+
+		for (uint64_t m = marked[s]; m; m &= m - 1)
+		{
+			int w = (s << 6) + CountTrailingZeros(m);
+			words[w] = wordOp(wordsA[w], wordsB[w]);
+		}
+		summary[s] = marked[s];
+	}
+}
+
+void TileOverlayLayers::Union(TILE_OVERLAY destination, TILE_OVERLAY a, TILE_OVERLAY b)
+{
+	Combine(destination, a, b,
+		[](uint64_t x, uint64_t y) { return x | y; },
+		[](uint64_t x, uint64_t y) { return x | y; });
+}
+
+void TileOverlayLayers::Intersect(TILE_OVERLAY destination, TILE_OVERLAY a, TILE_OVERLAY b)
+{
+	Combine(destination, a, b,
+		[](uint64_t x, uint64_t y) { return x & y; },
+		[](uint64_t x, uint64_t y) { return x & y; });
+}
+
+void TileOverlayLayers::Subtract(TILE_OVERLAY destination, TILE_OVERLAY a, TILE_OVERLAY b)
+{
+	Combine(destination, a, b,
+		[](uint64_t x, uint64_t) { return x; },
+		[](uint64_t x, uint64_t y) { return x & ~y; });
+}
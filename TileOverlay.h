@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+
+#include "PathfindingContainers.h"		//Layer bitsets
+
+/*
+	Named tile overlays (movement range, path preview, attack range etc), later entries drawn over earlier ones
+	where they share a tile
+*/
+enum class TILE_OVERLAY
+{
+	MOVEMENT,
+	ATTACK,
+	AOE,
+	PLACEMENT,
+	PATH,
+	COUNT
+};
+
+/*
+	Grid overlays as one bit per nav grid cell per layer, each layer with the atlas frame it is drawn with. Systems
+	stamp their ranges into a layer, membership checks are a single bit test, and the renderer walks the set bits to
+	draw each tile under its topmost visible layer.
+
+	Alongside its bits, each layer keeps a summary bit per 64 bit word marking words that may be non zero. Clearing,
+	union, intersection and drawing only visit those words, so their cost follows the size of the overlay rather
+	than the size of the map.
+*/
+class TileOverlayLayers
+{
+public:
+
+	TileOverlayLayers() {}
+	~TileOverlayLayers() {}
+
+	///////////
+	/// Set ///
+	///////////
+
+	//Atlas frame drawn on each tile of the layer
+	void SetFrame(TILE_OVERLAY layer, int frame) { m_Layers[Index(layer)].frame = frame; }
+	//Hidden layers still answer membership checks, they are just not drawn
+	void SetVisible(TILE_OVERLAY layer, bool visible) { m_Layers[Index(layer)].visible = visible; }
+
+	///////////
+	/// Get ///
+	///////////
+
+	int GetFrame(TILE_OVERLAY layer) const { return m_Layers[Index(layer)].frame; }
+	bool IsVisible(TILE_OVERLAY layer) const { return m_Layers[Index(layer)].visible; }
+	int GetCellCount() const { return m_CellCount; }
+
+	//Is the cell in the layer (false for any cell outside the sized grid)
+	bool Test(TILE_OVERLAY layer, int cell) const
+	{
+		return cell >= 0 && cell < m_CellCount && m_Layers[Index(layer)].bits.Test(cell);
+	}
+	//Raw bits of a layer (bit i is nav grid cell i)
+	const TileBitset& GetBits(TILE_OVERLAY layer) const { return m_Layers[Index(layer)].bits; }
+
+	//Does the layer hold no cells
+	bool IsEmpty(TILE_OVERLAY layer) const;
+	//Number of cells in the layer
+	int GetCount(TILE_OVERLAY layer) const;
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Sizes every layer for a grid of the given cell count, clearing them (only allocates on growth)
+	void Resize(int cellCount);
+
+	void Set(TILE_OVERLAY layer, int cell)
+	{
+		Layer& l = m_Layers[Index(layer)];
+		l.bits.Set(cell);
+		l.summary.Set(cell >> 6);
+	}
+	//Adds the run of cells first to last inclusive (a row span), a few masked word writes however long the run
+	void SetSpan(TILE_OVERLAY layer, int firstCell, int lastCell)
+	{
+		Layer& l = m_Layers[Index(layer)];
+		l.bits.SetRange(firstCell, lastCell);
+		l.summary.SetRange(firstCell >> 6, lastCell >> 6);
+	}
+	//Removes a cell (its word stays marked in the summary until the layer is cleared)
+	void Reset(TILE_OVERLAY layer, int cell) { m_Layers[Index(layer)].bits.Reset(cell); }
+
+	//Removes every cell, touching only the words marked as written since the last clear
+	void Clear(TILE_OVERLAY layer);
+	void ClearAll();
+
+	//Word parallel set operations. The destination is replaced, and may be one of the sources.
+	void Union(TILE_OVERLAY destination, TILE_OVERLAY a, TILE_OVERLAY b);
+	void Intersect(TILE_OVERLAY destination, TILE_OVERLAY a, TILE_OVERLAY b);
+	//Removes the cells of b from a
+	void Subtract(TILE_OVERLAY destination, TILE_OVERLAY a, TILE_OVERLAY b);
+
+	//Calls func(cell) for every cell in the layer, in cell order
+	template<typename Func>
+	void ForEachCell(TILE_OVERLAY layer, Func&& func) const
+	{
+		const Layer& l = m_Layers[Index(layer)];
+		const uint64_t* words = l.bits.GetWords();
+		const uint64_t* summary = l.summary.GetWords();
+		for (int s(0); s < l.summary.GetWordCount(); ++s)
+		{
+			for (uint64_t marked = summary[s]; marked; marked &= marked - 1)
+			{
+				int w = (s << 6) + CountTrailingZeros(marked);
+				for (uint64_t bits = words[w]; bits; bits &= bits - 1)
+					func((w << 6) + CountTrailingZeros(bits));
+			}
+		}
+	}
+
+	/*
+		Calls func(cell, frame) once for every cell in a visible layer, with the frame of the topmost visible layer
+		holding it, in cell order
+	*/
+	template<typename Func>
+	void ForEachDrawnCell(Func&& func) const
+	{
+		//Words marked in any visible layer
+		const int summaryWords = m_Layers[0].summary.GetWordCount();
+		for (int s(0); s < summaryWords; ++s)
+		{
+			uint64_t marked = 0;
+			for (int i(0); i < LAYER_COUNT; ++i)
+			{
+				if (m_Layers[i].visible)
+					marked |= m_Layers[i].summary.GetWords()[s];
+			}
+
+			for (; marked; marked &= marked - 1)
+			{
+				int w = (s << 6) + CountTrailingZeros(marked);
+
+				//Peel off the cells of each layer from the top down, so a cell is only drawn once
+				uint64_t remaining = ~0ull;
+				for (int i(LAYER_COUNT - 1); i >= 0 && remaining; --i)
+				{
+					const Layer& l = m_Layers[i];
+					if (!l.visible)
+						continue;
+
+					uint64_t bits = l.bits.GetWords()[w] & remaining;
+					remaining &= ~bits;
+					for (; bits; bits &= bits - 1)
+						func((w << 6) + CountTrailingZeros(bits), l.frame);
+				}
+			}
+		}
+	}
+
+private:
+
+	static constexpr int LAYER_COUNT = static_cast<int>(TILE_OVERLAY::COUNT);
+
+	struct Layer
+	{
+		//One bit per cell
+		TileBitset bits;
+		//One bit per word of bits, set where the word may be non zero
+		TileBitset summary;
+		int frame = 0;
+		bool visible = true;
+	};
+
+	static int Index(TILE_OVERLAY layer) { return static_cast<int>(layer); }
+
+	/*
+		Sets the destination to wordOp(wordA, wordB) over the words marked by summaryOp(summaryA, summaryB), which
+		must cover every word the result can be non zero in. Other words of the destination are zeroed.
+	*/
+	template<typename SummaryOp, typename WordOp>
+	void Combine(TILE_OVERLAY destination, TILE_OVERLAY a, TILE_OVERLAY b, SummaryOp&& summaryOp, WordOp&& wordOp);
+
+	////////////
+	/// Data ///
+	////////////
+
+	Layer m_Layers[LAYER_COUNT];
+	int m_CellCount = 0;
+	//Combined summary scratch, so a destination can also be a source
+	TileBitset m_Marked;
+};
@@ -1,5 +1,6 @@
 #include "UnitEntity.h"
 #include "Game.h"			//Manager Access
+#include "UnitOccupancy.h"	//Tile lookups
 
 using namespace DirectX;
 
@@ -130,6 +131,19 @@ void UnitEntity::MoveToCoordinate(DirectX::XMINT2& newCoords)
 	//Adjust sprite position
 	m_PrimarySprite.SetPosition((m_MapCoordinates.x * m_TileSize.x) + m_TileSize.x * 0.5f,
 		(m_MapCoordinates.y * m_TileSize.y) + m_TileSize.y * 0.5f);
+	//Move over in the occupancy map (placing the unit if it wasn't on the map)
+	if (m_Occupancy)
+	{
+		m_Occupancy->Place(m_OccupancyHandle, m_MapCoordinates.x, m_MapCoordinates.y, m_UnitTeamID);
+		m_Occupancy->SetAlive(m_OccupancyHandle, m_StateFlags.isAlive);
+	}
+}
+
+void UnitEntity::SetAliveState(bool newState)
+{
+	m_StateFlags.isAlive = newState;
+	if (m_Occupancy)
+		m_Occupancy->SetAlive(m_OccupancyHandle, newState);
 }
 
 bool UnitEntity::CheckRemainingActions()
@@ -3,24 +3,9 @@
 #include "EntityInterface.h"
 #include "GameUtilities.h"
 #include "SkillInterface.h"
+#include "GameTypes.h"			//Class totals
 
-struct ClassTotals {
-	float MaxHP = 0.0f;
-	float CurrentHP = 0.0f;
-	int MaxMP = 0;
-	int CurrentMP = 0;
-	float TotalMovespeed = 0.0f;
-	float TotalPhysAttack = 0.0f;
-	float TotalMagAttack = 0.0f;
-	float TotalPhysHit = 0.0f;
-	float TotalMagHit = 0.0f;
-	float TotalCritHit = 0.0f;
-	float TotalCritMultiplier = 0.0f;
-	float TotalPhysArmour = 0.0f;
-	float TotalMagArmour = 0.0f;
-	float TotalEvasion = 0.0f;
-	float TotalMagResist = 0.0f;
-};
+class UnitOccupancyMap;
 
 struct BuffPercentages {
 	float PhysDamageBuff = 1.0f;
@@ -98,8 +83,8 @@ public:
 	void SetActState(bool newState) { m_StateFlags.canAct = newState; }
 	//Update the unit can move state
 	void SetMoveState(bool newState) { m_StateFlags.canMove = newState; }
-	//Update alive state
-	void SetAliveState(bool newState) { m_StateFlags.isAlive = newState; }
+	//Update alive state (and the units occupancy, if bound)
+	void SetAliveState(bool newState);
 	//Update buff state
 	void SetBuffState(bool newState) { m_StateFlags.buffActive = newState; }
 
@@ -112,12 +97,15 @@ public:
 
 	UNIT_TYPE GetUnitType() { return m_Type; }
 	int GetUnitTeamID() { return m_UnitTeamID; }
+	//Handle the owner gave the unit (its index among the owners units, -1 if unbound), stable for the match
+	int GetOccupancyHandle() { return m_OccupancyHandle; }
 	int GetUnitClassID() { return m_UnitClass->UniqueID; }
 	std::string GetUnitClass() { return m_UnitClass->ClassName; }
 
 	ClassTotals& GetClassTotals() { return m_ClassTotals; }
 	BuffPercentages& GetBuffs() { return m_CurrentBuffs; }
 	SkillInterface* GetSkillAtIndex(int index) { return m_Skills.at(index).get(); }
+	int GetSkillCount() { return static_cast<int>(m_Skills.size()); }
 	const Equipment* GetEquipmentAtIndex(int index) { return m_UnitEquipment.at(index).get(); }
 	const UnitStateFlags& GetUnitStateFlags() { return m_StateFlags; }
 	bool GetAliveState() { return m_StateFlags.isAlive; }
@@ -132,8 +120,10 @@ public:
 
 	//Up: 0, Down: 1, Left: 2, Right: 3
 	void Move(int dir);
-	//Force move the unit to world coordinates
+	//Force move the unit to world coordinates (updating the occupancy map, if bound)
 	void MoveToCoordinate(DirectX::XMINT2& newCoords);
+	//Keep the occupancy map up to date as the unit moves and dies, named in it by the handle
+	void BindOccupancy(UnitOccupancyMap* occupancy, int handle) { m_Occupancy = occupancy; m_OccupancyHandle = handle; }
 
 	//Checks if the unit flags to see if it has any remaining actions, return true if at least one is available.
 	bool CheckRemainingActions();
@@ -193,4 +183,7 @@ private:
 	std::vector<std::shared_ptr<SkillInterface>> m_Skills;
 	//Flags for state control
 	UnitStateFlags m_StateFlags;
+	//Map of which unit stands where, and this units handle in it
+	UnitOccupancyMap* m_Occupancy = nullptr;
+	int m_OccupancyHandle = -1;
 };
@@ -0,0 +1,93 @@
+#include "UnitOccupancy.h"
+
+void UnitOccupancyMap::Resize(const NavGrid& grid)
+{
+	m_Grid = &grid;
+	m_CellUnits.assign(grid.GetCellCount(), NO_UNIT);
+	m_Units.clear();
+	for (auto& t : m_TeamCells)
+		t.Resize(grid.GetCellCount());
+	m_LivingCells.Resize(grid.GetCellCount());
+}
+
+void UnitOccupancyMap::Clear()
+{
+	//Only the cells units stand on need clearing
+	for (auto& u : m_Units)
+	{
+		if (u.cell >= 0)
+			m_CellUnits[u.cell] = NO_UNIT;
+	}
+	m_Units.clear();
+	for (auto& t : m_TeamCells)
+		t.ClearAll();
+	m_LivingCells.ClearAll();
+}
+
+void UnitOccupancyMap::Place(int handle, int cell, int team)
+{
+	if (!m_Grid || handle < 0 || team < 0 || cell < 0 || cell >= m_Grid->GetCellCount())
+		return;
+
+	if (handle >= static_cast<int>(m_Units.size()))
+		m_Units.resize(handle + 1);
+	while (team >= GetTeamCount())
+	{
+		m_TeamCells.emplace_back();
+		m_TeamCells.back().Resize(m_Grid->GetCellCount());
+	}
+
+	Remove(handle);
+
+	UnitSlot& unit = m_Units[handle];
+	unit.cell = cell;
+	unit.team = team;
+	unit.alive = true;
+	m_CellUnits[cell] = handle;
+	SetLivingBit(unit, true);
+}
+
+void UnitOccupancyMap::Remove(int handle)
+{
+	if (handle < 0 || handle >= static_cast<int>(m_Units.size()))
+		return;
+
+	UnitSlot& unit = m_Units[handle];
+	if (unit.cell < 0)
+		return;
+
+	if (unit.alive)
+		SetLivingBit(unit, false);
+	//Only clear the cell if it is still ours
+	if (m_CellUnits[unit.cell] == handle)
+		m_CellUnits[unit.cell] = NO_UNIT;
+	unit.cell = -1;
+	unit.alive = false;
+}
+
+void UnitOccupancyMap::SetAlive(int handle, bool alive)
+{
+	if (handle < 0 || handle >= static_cast<int>(m_Units.size()))
+		return;
+
+	UnitSlot& unit = m_Units[handle];
+	if (unit.cell < 0 || unit.alive == alive)
+		return;
+
+	unit.alive = alive;
+	SetLivingBit(unit, alive);
+}
+
+void UnitOccupancyMap::SetLivingBit(const UnitSlot& unit, bool set)
+{
+	if (set)
+	{
+		m_TeamCells[unit.team].Set(unit.cell);
+		m_LivingCells.Set(unit.cell);
+	}
+	else
+	{
+		m_TeamCells[unit.team].Reset(unit.cell);
+		m_LivingCells.Reset(unit.cell);
+	}
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>		//std::min
+
+#include "NavGrid.h"					//Cells units stand on
+#include "PathfindingContainers.h"		//Team bitsets
+#include "TileOverlay.h"				//Overlay layer queries
+
+/*
+	Which unit stands on each nav grid cell, so finding the unit on a tile is a single lookup rather than a scan of
+	every unit. Units are named by handles chosen by the owner (the index of the unit in the owners container), and
+	are kept up to date as they are placed, moved and killed (see UnitEntity::BindOccupancy).
+
+	Alongside the per cell handles, each team keeps a bit per cell marking where its living units stand. Range
+	queries walk the words of those bits under the spans of a shape (or AND them with a bitset), so they skip 64
+	empty cells at a time and cost follows the size of the shape rather than the size of the team.
+
+	Dead units stay on their tile (the corpse still blocks it and can still be inspected) but drop out of their
+	teams bits, so range queries only ever find the living.
+*/
+class UnitOccupancyMap
+{
+public:
+
+	//Handle of an empty cell
+	static constexpr int NO_UNIT = -1;
+	//Team filter matching units of every team
+	static constexpr int ALL_TEAMS = -1;
+
+	UnitOccupancyMap() {}
+	~UnitOccupancyMap() {}
+
+	///////////
+	/// Get ///
+	///////////
+
+	//Unit standing on a cell, living or dead (NO_UNIT if none)
+	int GetUnitAt(int cell) const { return m_CellUnits[cell]; }
+	//Unit standing at map coordinates (NO_UNIT if none, or off the map)
+	int GetUnitAt(int x, int y) const
+	{
+		if (!m_Grid || !m_Grid->IsInBounds(x, y))
+			return NO_UNIT;
+		return m_CellUnits[m_Grid->CoordsToCell(x, y)];
+	}
+	//Cell a unit stands on (-1 if it isn't on the map)
+	int GetUnitCell(int handle) const { return handle < static_cast<int>(m_Units.size()) ? m_Units[handle].cell : -1; }
+	int GetUnitTeam(int handle) const { return m_Units[handle].team; }
+	bool IsUnitAlive(int handle) const { return m_Units[handle].alive; }
+	//Cells of a teams living units (ALL_TEAMS for every team)
+	const TileBitset& GetTeamCells(int team) const { return team == ALL_TEAMS ? m_LivingCells : m_TeamCells[team]; }
+	int GetTeamCount() const { return static_cast<int>(m_TeamCells.size()); }
+
+	//////////////////
+	/// Operations ///
+	//////////////////
+
+	//Sizes the map to the grid, removing every unit (only allocates on growth)
+	void Resize(const NavGrid& grid);
+	//Removes every unit, keeping the sizing
+	void Clear();
+
+	/*
+		Puts a unit on a cell for the team (team IDs index the teams, so grow the team count as they are first seen),
+		taking it off any cell it stood on first. The cell must be empty.
+	*/
+	void Place(int handle, int cell, int team);
+	//Place at map coordinates (ignored off the map)
+	void Place(int handle, int x, int y, int team)
+	{
+		if (m_Grid && m_Grid->IsInBounds(x, y))
+			Place(handle, m_Grid->CoordsToCell(x, y), team);
+	}
+	//Takes a unit off the map
+	void Remove(int handle);
+	//Marks a unit living or dead, leaving it on its tile either way
+	void SetAlive(int handle, bool alive);
+
+	/*
+		Calls func(handle) for each living unit of the team (or ALL_TEAMS) inside the shape around the centre, in
+		cell order. The unit given to func may be killed or removed during the call.
+	*/
+	template<typename Func>
+	void ForEachUnitInShape(int centreX, int centreY, RANGE_SHAPE shape, SHAPE_FACING facing, int radius, int team, Func&& func) const
+	{
+		if (!IsTeamKnown(team))
+			return;
+
+		const uint64_t* words = GetTeamCells(team).GetWords();
+		m_Grid->ForEachSpanInShape(centreX, centreY, shape, facing, radius, [&](int firstCell, int lastCell)
+		{
+			int firstWord = firstCell >> 6;
+			int lastWord = lastCell >> 6;
+			for (int w(firstWord); w <= lastWord; ++w)
+			{
+				uint64_t bits = words[w];
+				if (w == firstWord)
+					bits &= ~0ull << (firstCell & 63);
+				if (w == lastWord)
+					bits &= ~0ull >> (63 - (lastCell & 63));
+				for (; bits; bits &= bits - 1)
+					func(m_CellUnits[(w << 6) + CountTrailingZeros(bits)]);
+			}
+		});
+	}
+
+	//Calls func(handle) for each living unit of the team (or ALL_TEAMS) on a cell set in the bitset, in cell order
+	template<typename Func>
+	void ForEachUnitInBitset(const TileBitset& cells, int team, Func&& func) const
+	{
+		if (!IsTeamKnown(team))
+			return;
+
+		const TileBitset& teamCells = GetTeamCells(team);
+		int wordCount = std::min(cells.GetWordCount(), teamCells.GetWordCount());
+		for (int w(0); w < wordCount; ++w)
+		{
+			for (uint64_t bits = cells.GetWords()[w] & teamCells.GetWords()[w]; bits; bits &= bits - 1)
+				func(m_CellUnits[(w << 6) + CountTrailingZeros(bits)]);
+		}
+	}
+
+	//As ForEachUnitInBitset for an overlay layer, visiting only the words the layer has written
+	template<typename Func>
+	void ForEachUnitInLayer(const TileOverlayLayers& layers, TILE_OVERLAY layer, int team, Func&& func) const
+	{
+		if (!IsTeamKnown(team))
+			return;
+
+		const TileBitset& teamCells = GetTeamCells(team);
+		layers.ForEachCell(layer, [&](int cell)
+		{
+			if (cell < teamCells.GetBitCount() && teamCells.Test(cell))
+				func(m_CellUnits[cell]);
+		});
+	}
+
+private:
+
+	struct UnitSlot
+	{
+		int cell = -1;
+		int team = ALL_TEAMS;
+		bool alive = false;
+	};
+
+	bool IsTeamKnown(int team) const { return m_Grid && (team == ALL_TEAMS || (team >= 0 && team < GetTeamCount())); }
+
+	//Adds or removes a living unit from the team bits
+	void SetLivingBit(const UnitSlot& unit, bool set);
+
+	////////////
+	/// Data ///
+	////////////
+
+	const NavGrid* m_Grid = nullptr;
+	//Unit on each cell (NO_UNIT if none)
+	std::vector<int> m_CellUnits;
+	//Per handle, where the unit stands
+	std::vector<UnitSlot> m_Units;
+	//Per team, cells of its living units
+	std::vector<TileBitset> m_TeamCells;
+	//Cells of every living unit
+	TileBitset m_LivingCells;
+};